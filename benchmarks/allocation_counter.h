@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+// Qt
+#include <QtGlobal>
+
+namespace benchmark
+{
+    // Counts every global operator new call in the process
+    quint64 allocationsCount();
+}
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,40 @@
+#include "benchmark_link.h"
+
+using namespace benchmark;
+
+BenchmarkLink::BenchmarkLink(QObject* parent):
+    comm::AbstractLink(parent)
+{}
+
+bool BenchmarkLink::isConnected() const
+{
+    return m_connected;
+}
+
+void BenchmarkLink::connectLink()
+{
+    if (m_connected) return;
+
+    m_connected = true;
+    emit connectedChanged(true);
+}
+
+void BenchmarkLink::disconnectLink()
+{
+    if (!m_connected) return;
+
+    m_connected = false;
+    emit connectedChanged(false);
+}
+
+void BenchmarkLink::inject(const QByteArray& data)
+{
+    this->receiveData(data);
+}
+
+bool BenchmarkLink::sendDataImpl(const QByteArray& data)
+{
+    Q_UNUSED(data) // Commands and requests go nowhere
+
+    return m_connected;
+}
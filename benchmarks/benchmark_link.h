@@ -0,0 +1,33 @@
+#ifndef BENCHMARK_LINK_H
+#define BENCHMARK_LINK_H
+
+// Internal
+#include "abstract_link.h"
+
+namespace benchmark
+{
+    // In-memory link, synthetic data goes straight into the communicator
+    class BenchmarkLink: public comm::AbstractLink
+    {
+        Q_OBJECT
+
+    public:
+        explicit BenchmarkLink(QObject* parent = nullptr);
+
+        bool isConnected() const override;
+
+    public slots:
+        void connectLink() override;
+        void disconnectLink() override;
+
+        void inject(const QByteArray& data);
+
+    protected:
+        bool sendDataImpl(const QByteArray& data) override;
+
+    private:
+        bool m_connected = false;
+    };
+}
+
+#endif // BENCHMARK_LINK_H
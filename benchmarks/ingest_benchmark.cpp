@@ -0,0 +1,226 @@
+#include "ingest_benchmark.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QTimerEvent>
+#include <QTimer>
+#include <QTextStream>
+#include <QDebug>
+
+// Std
+#include <algorithm>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+// Internal
+#include "service_registry.h"
+#include "vehicle_service.h"
+#include "telemetry_service.h"
+#include "telemetry.h"
+#include "vehicle.h"
+
+#include "mavlink_communicator.h"
+#include "mavlink_communicator_factory.h"
+#include "abstract_mavlink_handler.h"
+
+#include "allocation_counter.h"
+#include "benchmark_link.h"
+
+using namespace benchmark;
+
+namespace
+{
+    const quint8 systemId = 255;
+    const quint8 componentId = 0;
+
+    const int feedInterval = 5;     // ms, paced mode
+    const double fastStep = 0.1;    // Simulated seconds per pass, fast mode
+    const int drainInterval = 100;  // ms for the last notifications before report
+
+    QString handlerName(comm::AbstractMavLinkHandler* handler)
+    {
+        const char* name = typeid(*handler).name();
+#ifdef __GNUG__
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && demangled)
+        {
+            QString result(demangled);
+            std::free(demangled);
+            return result;
+        }
+#endif
+        return QString(name);
+    }
+
+    double percentile(const QVector<qint64>& sorted, double fraction)
+    {
+        if (sorted.isEmpty()) return 0;
+
+        int index = qBound(0, int(fraction * (sorted.count() - 1) + 0.5), sorted.count() - 1);
+        return sorted.at(index) / 1e6;
+    }
+}
+
+IngestBenchmark::IngestBenchmark(const Config& config, QObject* parent):
+    QObject(parent),
+    m_config(config),
+    m_generator(config.vehicles, config.mix),
+    m_communicator(comm::MavLinkCommunicatorFactory(::systemId, ::componentId, false).create()),
+    m_link(new BenchmarkLink(this))
+{
+    m_communicator->setParent(this);
+    m_communicator->setProfilingEnabled(true);
+    m_communicator->addLink(m_link);
+    m_link->connectLink();
+}
+
+IngestBenchmark::~IngestBenchmark()
+{}
+
+int IngestBenchmark::exec()
+{
+    this->prepareVehicles();
+
+    m_startAllocations = benchmark::allocationsCount();
+    m_clock.start();
+    m_feedTimer = this->startTimer(m_config.speed > 0 ? ::feedInterval : 0);
+
+    return QCoreApplication::exec();
+}
+
+void IngestBenchmark::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != m_feedTimer) return QObject::timerEvent(event);
+
+    this->feed();
+    if (m_simulated < m_config.duration) return;
+
+    this->killTimer(m_feedTimer);
+    m_feedTimer = 0;
+    m_wallTime = m_clock.nsecsElapsed();
+
+    QTimer::singleShot(::drainInterval, this, [this]() {
+        this->report();
+        QCoreApplication::quit();
+    });
+}
+
+void IngestBenchmark::prepareVehicles()
+{
+    domain::VehicleService* vehicleService = serviceRegistry->vehicleService();
+    domain::TelemetryService* telemetryService = serviceRegistry->telemetryService();
+
+    for (int mavId = 1; mavId <= m_config.vehicles; ++mavId)
+    {
+        int vehicleId = vehicleService->vehicleIdByMavId(mavId);
+        if (!vehicleId)
+        {
+            dto::VehiclePtr vehicle = dto::VehiclePtr::create();
+            vehicle->setMavId(mavId);
+            vehicle->setName(QString("Benchmark %1").arg(mavId));
+            vehicle->setType(dto::Vehicle::Auto);
+            vehicleService->save(vehicle);
+            vehicleId = vehicle->id();
+        }
+
+        domain::Telemetry* node = telemetryService->vehicleNode(vehicleId);
+        if (!node) continue;
+
+        connect(node->childNode(domain::Telemetry::Ahrs), &domain::Telemetry::parametersChanged,
+                this, [this, mavId]() { this->onAhrsChanged(mavId); });
+    }
+}
+
+void IngestBenchmark::feed()
+{
+    double to = m_config.speed > 0 ? m_clock.nsecsElapsed() / 1e9 * m_config.speed :
+                                     m_simulated + ::fastStep;
+    to = qMin(to, m_config.duration);
+    if (to <= m_simulated) return;
+
+    QByteArray data;
+    QSet<int> ahrsVehicles;
+    m_messages += m_generator.generate(m_simulated, to, data, ahrsVehicles);
+    m_simulated = to;
+    if (data.isEmpty()) return;
+
+    m_bytes += data.size();
+
+    qint64 injected = m_clock.nsecsElapsed();
+    for (int vehicle: ahrsVehicles)
+    {
+        if (!m_pendingAhrs.contains(vehicle)) m_pendingAhrs[vehicle] = injected;
+    }
+
+    int packetSize = m_config.packetSize > 0 ? m_config.packetSize : data.size();
+    QVector<QByteArray> packets;
+    for (int pos = 0; pos < data.size(); pos += packetSize)
+    {
+        packets.append(data.mid(pos, packetSize));
+    }
+
+    quint64 allocations = benchmark::allocationsCount();
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const QByteArray& packet: packets) m_link->inject(packet);
+
+    m_ingestTime += timer.nsecsElapsed();
+    m_ingestAllocations += benchmark::allocationsCount() - allocations;
+}
+
+void IngestBenchmark::onAhrsChanged(int vehicle)
+{
+    if (!m_pendingAhrs.contains(vehicle)) return;
+
+    m_latencies.append(m_clock.nsecsElapsed() - m_pendingAhrs.take(vehicle));
+}
+
+void IngestBenchmark::report()
+{
+    QTextStream out(stdout);
+    quint64 allocations = benchmark::allocationsCount() - m_startAllocations;
+    double messages = qMax<quint64>(m_messages, 1);
+
+    out << "Vehicles:                " << m_config.vehicles << endl;
+    out << "Offered rate:            " << m_generator.messagesPerSecond() << " msg/s" << endl;
+    out << "Simulated / wall time:   " << m_simulated << " s / " << m_wallTime / 1e9 << " s"
+        << endl;
+    out << "Messages / bytes:        " << m_messages << " / " << m_bytes << endl;
+    out << "Dispatched / unhandled:  " << m_communicator->dispatchedMessages() << " / "
+        << m_communicator->unhandledMessages() << endl;
+    out << "Ingest time:             " << m_ingestTime / 1e6 << " ms" << endl;
+    out << "Ingest throughput:       " << (m_ingestTime ? m_messages * 1e9 / m_ingestTime : 0)
+        << " msg/s, " << (m_ingestTime ? m_bytes * 1e3 / m_ingestTime : 0) << " MB/s" << endl;
+    out << "Ingest allocations:      " << m_ingestAllocations / messages << " per message"
+        << endl;
+    out << "Total allocations:       " << allocations / messages << " per message" << endl;
+
+    QVector<qint64> latencies = m_latencies;
+    std::sort(latencies.begin(), latencies.end());
+    out << "Latency to UI (Ahrs):    " << latencies.count() << " samples, min "
+        << ::percentile(latencies, 0) << " ms, median " << ::percentile(latencies, 0.5)
+        << " ms, p99 " << ::percentile(latencies, 0.99) << " ms, max "
+        << ::percentile(latencies, 1) << " ms" << endl;
+
+    QList<QPair<qint64, QString> > handlers;
+    QHash<comm::AbstractMavLinkHandler*, qint64> times = m_communicator->handlerTimes();
+    for (auto it = times.constBegin(); it != times.constEnd(); ++it)
+    {
+        handlers.append(qMakePair(it.value(), ::handlerName(it.key())));
+    }
+    std::sort(handlers.begin(), handlers.end(), std::greater<QPair<qint64, QString> >());
+
+    out << endl << "Handlers time:" << endl;
+    for (const QPair<qint64, QString>& handler: handlers)
+    {
+        out << "  " << handler.second.leftJustified(40) << " "
+            << QString::number(handler.first / 1e6, 'f', 3).rightJustified(10) << " ms  "
+            << QString::number(m_ingestTime ? 100.0 * handler.first / m_ingestTime : 0, 'f', 1)
+               .rightJustified(5) << " %" << endl;
+    }
+}
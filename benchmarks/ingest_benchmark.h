@@ -0,0 +1,73 @@
+#ifndef INGEST_BENCHMARK_H
+#define INGEST_BENCHMARK_H
+
+// Qt
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+
+// Internal
+#include "stream_generator.h"
+
+namespace comm
+{
+    class MavLinkCommunicator;
+}
+
+namespace benchmark
+{
+    class BenchmarkLink;
+
+    // Feeds synthetic streams through the real handler set and telemetry service,
+    // measures ingest throughput, handlers time, allocations and latency to the UI side
+    class IngestBenchmark: public QObject
+    {
+        Q_OBJECT
+
+    public:
+        class Config
+        {
+        public:
+            int vehicles = 10;
+            double duration = 10; // Seconds of simulated flight
+            double speed = 1;     // 0 feeds as fast as possible
+            int packetSize = 0;   // Bytes per received buffer, 0 is whole feed step
+            StreamGenerator::Mix mix;
+        };
+
+        explicit IngestBenchmark(const Config& config, QObject* parent = nullptr);
+        ~IngestBenchmark() override;
+
+        int exec(); // Runs event loop until done and prints report
+
+    protected:
+        void timerEvent(QTimerEvent* event) override;
+
+    private:
+        void prepareVehicles();
+        void feed();
+        void onAhrsChanged(int vehicle);
+        void report();
+
+        const Config m_config;
+        StreamGenerator m_generator;
+        comm::MavLinkCommunicator* const m_communicator;
+        BenchmarkLink* const m_link;
+
+        int m_feedTimer = 0;
+        QElapsedTimer m_clock;
+        double m_simulated = 0;
+
+        quint64 m_messages = 0;
+        quint64 m_bytes = 0;
+        qint64 m_ingestTime = 0;
+        quint64 m_ingestAllocations = 0;
+        quint64 m_startAllocations = 0;
+        qint64 m_wallTime = 0;
+
+        QMap<int, qint64> m_pendingAhrs; // Vehicle to injection time of unseen attitude
+        QVector<qint64> m_latencies;
+    };
+}
+
+#endif // INGEST_BENCHMARK_H
@@ -0,0 +1,71 @@
+// Qt
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+// Internal
+#include "db_manager.h"
+#include "notification_bus.h"
+#include "service_registry.h"
+
+#include "ingest_benchmark.h"
+
+namespace
+{
+    const QString defaultMix = "heartbeat:1,attitude:50,position:10,gps:5,vfr_hud:10,"
+                               "sys_status:2,vibration:5,nav_controller:5,pressure:5,"
+                               "radio_status:1";
+}
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("JAGCS ingest benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Feeds synthetic MAVLink streams through the real handlers");
+    parser.addHelpOption();
+
+    QCommandLineOption vehiclesOption("vehicles", "Simulated vehicles count.", "count", "10");
+    QCommandLineOption durationOption("duration", "Simulated seconds.", "seconds", "10");
+    QCommandLineOption speedOption("speed", "Time scale, 0 feeds as fast as possible.",
+                                   "factor", "1");
+    QCommandLineOption packetOption("packet", "Bytes per received buffer, 0 for whole step.",
+                                    "bytes", "0");
+    QCommandLineOption mixOption("mix", "Message rates per vehicle, available: " +
+                                 benchmark::StreamGenerator::availableMessages().join(", ") +
+                                 ".", "name:Hz,...", ::defaultMix);
+    parser.addOptions({ vehiclesOption, durationOption, speedOption, packetOption, mixOption });
+    parser.process(app);
+
+    benchmark::IngestBenchmark::Config config;
+    bool ok = true;
+    config.vehicles = qBound(1, parser.value(vehiclesOption).toInt(), 254);
+    config.duration = parser.value(durationOption).toDouble();
+    config.speed = qMax(0.0, parser.value(speedOption).toDouble());
+    config.packetSize = qMax(0, parser.value(packetOption).toInt());
+    config.mix = benchmark::StreamGenerator::parseMix(parser.value(mixOption), &ok);
+    if (!ok || config.mix.isEmpty() || config.duration <= 0)
+    {
+        qCritical() << "Invalid benchmark options";
+        return 1;
+    }
+
+    db::DbManager dbManager;
+    if (!dbManager.open(":memory:"))
+    {
+        qCritical() << "Unable to open in-memory database" << dbManager.dbLog();
+        return 1;
+    }
+
+    domain::NotificationBus bus;
+    Q_UNUSED(bus);
+
+    domain::ServiceRegistry registry;
+    Q_UNUSED(registry);
+
+    benchmark::IngestBenchmark benchmark(config);
+    return benchmark.exec();
+}
@@ -0,0 +1,238 @@
+#include "stream_generator.h"
+
+// MAVLink
+#include <mavlink.h>
+
+// Std
+#include <cmath>
+#include <cstring>
+
+using namespace benchmark;
+
+namespace
+{
+    const quint8 componentId = MAV_COMP_ID_AUTOPILOT1;
+    const quint8 channel = MAVLINK_COMM_NUM_BUFFERS - 1; // Not used by communicator links
+
+    const double baseLatitude = 55.968954;
+    const double baseLongitude = 37.110155;
+
+    const QStringList messages = { "heartbeat", "attitude", "position", "gps", "vfr_hud",
+                                   "sys_status", "vibration", "nav_controller",
+                                   "pressure", "radio_status" };
+}
+
+StreamGenerator::StreamGenerator(int vehicles, const Mix& mix):
+    m_vehicles(vehicles),
+    m_mix(mix)
+{}
+
+QStringList StreamGenerator::availableMessages()
+{
+    return ::messages;
+}
+
+StreamGenerator::Mix StreamGenerator::parseMix(const QString& mix, bool* ok)
+{
+    Mix result;
+    if (ok) *ok = true;
+
+    for (const QString& item: mix.split(",", QString::SkipEmptyParts))
+    {
+        QStringList pair = item.split(":");
+        bool rateOk = false;
+        double rate = pair.count() == 2 ? pair.at(1).toDouble(&rateOk) : 0;
+
+        if (!rateOk || rate < 0 || !::messages.contains(pair.first()))
+        {
+            if (ok) *ok = false;
+            continue;
+        }
+
+        result[pair.first()] = rate;
+    }
+
+    return result;
+}
+
+double StreamGenerator::messagesPerSecond() const
+{
+    double rate = 0;
+    for (double messageRate: m_mix.values()) rate += messageRate;
+    return rate * m_vehicles;
+}
+
+int StreamGenerator::generate(double from, double to, QByteArray& data, QSet<int>& ahrsVehicles)
+{
+    quint8 buffer[MAVLINK_MAX_PACKET_LEN];
+    int count = 0;
+
+    for (int vehicle = 1; vehicle <= m_vehicles; ++vehicle)
+    {
+        // Vehicles are shifted in phase, so frames of different vehicles interleave
+        double phase = double(vehicle) / m_vehicles;
+
+        for (auto it = m_mix.constBegin(); it != m_mix.constEnd(); ++it)
+        {
+            double rate = it.value();
+            if (rate <= 0) continue;
+
+            for (qint64 tick = std::ceil((from * rate) - phase);
+                 (tick + phase) / rate < to; ++tick)
+            {
+                double time = (tick + phase) / rate;
+                if (time < from) continue;
+
+                int length = this->packMessage(it.key(), vehicle, time, buffer);
+                data.append(reinterpret_cast<const char*>(buffer), length);
+                count++;
+
+                if (it.key() == "attitude") ahrsVehicles.insert(vehicle);
+            }
+        }
+    }
+
+    return count;
+}
+
+int StreamGenerator::packMessage(const QString& name, int vehicle, double time,
+                                 quint8* buffer) const
+{
+    mavlink_message_t message;
+    quint32 timeMs = time * 1000;
+    double wave = std::sin(time + vehicle);
+
+    if (name == "heartbeat")
+    {
+        mavlink_heartbeat_t heartbeat;
+        std::memset(&heartbeat, 0, sizeof(heartbeat));
+        heartbeat.type = MAV_TYPE_FIXED_WING;
+        heartbeat.autopilot = MAV_AUTOPILOT_ARDUPILOTMEGA;
+        heartbeat.base_mode = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED | MAV_MODE_FLAG_SAFETY_ARMED;
+        heartbeat.custom_mode = 10; // Auto
+        heartbeat.system_status = MAV_STATE_ACTIVE;
+        heartbeat.mavlink_version = 3;
+        mavlink_msg_heartbeat_encode_chan(vehicle, ::componentId, ::channel,
+                                          &message, &heartbeat);
+    }
+    else if (name == "attitude")
+    {
+        mavlink_attitude_t attitude;
+        std::memset(&attitude, 0, sizeof(attitude));
+        attitude.time_boot_ms = timeMs;
+        attitude.roll = 0.3 * wave;
+        attitude.pitch = 0.1 * wave;
+        attitude.yaw = std::fmod(time, 2 * M_PI) - M_PI;
+        attitude.rollspeed = 0.3 * std::cos(time + vehicle);
+        mavlink_msg_attitude_encode_chan(vehicle, ::componentId, ::channel,
+                                         &message, &attitude);
+    }
+    else if (name == "position")
+    {
+        mavlink_global_position_int_t position;
+        std::memset(&position, 0, sizeof(position));
+        position.time_boot_ms = timeMs;
+        position.lat = (::baseLatitude + vehicle * 0.001 + 0.0001 * wave) * 1e7;
+        position.lon = (::baseLongitude + time * 0.00001) * 1e7;
+        position.alt = (200 + 10 * wave) * 1000;
+        position.relative_alt = (100 + 10 * wave) * 1000;
+        position.vx = 1500;
+        position.hdg = 9000;
+        mavlink_msg_global_position_int_encode_chan(vehicle, ::componentId, ::channel,
+                                                    &message, &position);
+    }
+    else if (name == "gps")
+    {
+        mavlink_gps_raw_int_t gps;
+        std::memset(&gps, 0, sizeof(gps));
+        gps.time_usec = quint64(time * 1e6);
+        gps.lat = (::baseLatitude + vehicle * 0.001 + 0.0001 * wave) * 1e7;
+        gps.lon = (::baseLongitude + time * 0.00001) * 1e7;
+        gps.alt = (200 + 10 * wave) * 1000;
+        gps.eph = 120;
+        gps.epv = 150;
+        gps.vel = 1500 + 100 * wave;
+        gps.cog = 9000;
+        gps.fix_type = GPS_FIX_TYPE_3D_FIX;
+        gps.satellites_visible = 12;
+        mavlink_msg_gps_raw_int_encode_chan(vehicle, ::componentId, ::channel, &message, &gps);
+    }
+    else if (name == "vfr_hud")
+    {
+        mavlink_vfr_hud_t hud;
+        std::memset(&hud, 0, sizeof(hud));
+        hud.airspeed = 15 + wave;
+        hud.groundspeed = 14 + wave;
+        hud.alt = 200 + 10 * wave;
+        hud.climb = wave;
+        hud.heading = 90;
+        hud.throttle = 60;
+        mavlink_msg_vfr_hud_encode_chan(vehicle, ::componentId, ::channel, &message, &hud);
+    }
+    else if (name == "sys_status")
+    {
+        mavlink_sys_status_t status;
+        std::memset(&status, 0, sizeof(status));
+        status.onboard_control_sensors_present = MAV_SYS_STATUS_SENSOR_3D_GYRO |
+                MAV_SYS_STATUS_SENSOR_3D_ACCEL | MAV_SYS_STATUS_SENSOR_3D_MAG |
+                MAV_SYS_STATUS_SENSOR_GPS | MAV_SYS_STATUS_SENSOR_ABSOLUTE_PRESSURE;
+        status.onboard_control_sensors_enabled = status.onboard_control_sensors_present;
+        status.onboard_control_sensors_health = status.onboard_control_sensors_present;
+        status.voltage_battery = 12000 + 100 * wave;
+        status.current_battery = 1000;
+        status.battery_remaining = 80;
+        mavlink_msg_sys_status_encode_chan(vehicle, ::componentId, ::channel,
+                                           &message, &status);
+    }
+    else if (name == "vibration")
+    {
+        mavlink_vibration_t vibration;
+        std::memset(&vibration, 0, sizeof(vibration));
+        vibration.time_usec = quint64(time * 1e6);
+        vibration.vibration_x = 5 + wave;
+        vibration.vibration_y = 5 - wave;
+        vibration.vibration_z = 10 + wave;
+        mavlink_msg_vibration_encode_chan(vehicle, ::componentId, ::channel,
+                                          &message, &vibration);
+    }
+    else if (name == "nav_controller")
+    {
+        mavlink_nav_controller_output_t output;
+        std::memset(&output, 0, sizeof(output));
+        output.nav_roll = 10 * wave;
+        output.nav_pitch = 2 * wave;
+        output.nav_bearing = 90;
+        output.target_bearing = 92;
+        output.wp_dist = 500 + 100 * wave;
+        output.alt_error = wave;
+        output.aspd_error = wave;
+        output.xtrack_error = wave;
+        mavlink_msg_nav_controller_output_encode_chan(vehicle, ::componentId, ::channel,
+                                                      &message, &output);
+    }
+    else if (name == "pressure")
+    {
+        mavlink_scaled_pressure_t pressure;
+        std::memset(&pressure, 0, sizeof(pressure));
+        pressure.time_boot_ms = timeMs;
+        pressure.press_abs = 990 + wave;
+        pressure.press_diff = 0.5 + 0.1 * wave;
+        pressure.temperature = 2000;
+        mavlink_msg_scaled_pressure_encode_chan(vehicle, ::componentId, ::channel,
+                                                &message, &pressure);
+    }
+    else // radio_status
+    {
+        mavlink_radio_status_t radio;
+        std::memset(&radio, 0, sizeof(radio));
+        radio.rssi = 150 + 10 * wave;
+        radio.remrssi = 140 + 10 * wave;
+        radio.noise = 40;
+        radio.remnoise = 42;
+        radio.txbuf = 100;
+        mavlink_msg_radio_status_encode_chan(vehicle, ::componentId, ::channel,
+                                             &message, &radio);
+    }
+
+    return mavlink_msg_to_send_buffer(buffer, &message);
+}
@@ -0,0 +1,38 @@
+#ifndef STREAM_GENERATOR_H
+#define STREAM_GENERATOR_H
+
+// Qt
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QByteArray>
+
+namespace benchmark
+{
+    // Synthetic telemetry of several vehicles, each message kind has its own rate.
+    // Values change every message so telemetry nodes never skip them as duplicates.
+    class StreamGenerator
+    {
+    public:
+        using Mix = QMap<QString, double>; // Message name to rate per vehicle, Hz
+
+        StreamGenerator(int vehicles, const Mix& mix);
+
+        static QStringList availableMessages();
+        static Mix parseMix(const QString& mix, bool* ok = nullptr); // "attitude:50,gps:5"
+
+        double messagesPerSecond() const;
+
+        // Appends frames due in simulated interval [from, to) seconds, returns their count.
+        // Vehicles which got attitude are added to ahrsVehicles for latency measurement.
+        int generate(double from, double to, QByteArray& data, QSet<int>& ahrsVehicles);
+
+    private:
+        int packMessage(const QString& name, int vehicle, double time, quint8* buffer) const;
+
+        const int m_vehicles;
+        const Mix m_mix;
+    };
+}
+
+#endif // STREAM_GENERATOR_H
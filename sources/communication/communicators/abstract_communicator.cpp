@@ -31,8 +31,7 @@ void AbstractCommunicator::addLink(AbstractLink* link)
 {
     m_links.append(link);
 
-    connect(link, &AbstractLink::dataReceived,
-            this, &AbstractCommunicator::onDataReceived);
+    link->setReceiver(this);
     emit linkAdded(link);
 }
 
@@ -40,7 +39,6 @@ void AbstractCommunicator::removeLink(AbstractLink* link)
 {
     m_links.removeOne(link);
 
-    disconnect(link, &AbstractLink::dataReceived,
-               this, &AbstractCommunicator::onDataReceived);
+    if (link->receiver() == this) link->setReceiver(nullptr);
     emit linkRemoved(link);
 }
@@ -3,11 +3,15 @@
 
 #include <QObject>
 
+// Internal
+#include "i_link_receiver.h"
+
 namespace comm
 {
     class AbstractLink;
 
-    class AbstractCommunicator: public QObject
+    // Links hand received bytes to their communicator directly, without queued signals
+    class AbstractCommunicator: public QObject, public ILinkReceiver
     {
         Q_OBJECT
 
@@ -41,9 +45,6 @@ namespace comm
         void mavLinkStatisticsChanged(AbstractLink* link, int packetsReceived, int packetsDrops);
         void mavLinkProtocolChanged(AbstractLink* link, Protocol protocol);
 
-    protected slots:
-        virtual void onDataReceived(const QByteArray& data) = 0;
-
     private:
         QList<AbstractLink*> m_links;
 
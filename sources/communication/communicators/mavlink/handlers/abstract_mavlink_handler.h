@@ -1,6 +1,9 @@
 #ifndef ABSTRACT_MAVLINK_HANDLER_H
 #define ABSTRACT_MAVLINK_HANDLER_H
 
+// Qt
+#include <QList>
+
 // MAVLink
 #include <mavlink_types.h>
 
@@ -14,6 +17,9 @@ namespace comm
         explicit AbstractMavLinkHandler(MavLinkCommunicator* communicator);
         virtual ~AbstractMavLinkHandler();
 
+        // Message ids handler subscribes on, communicator dispatches only them
+        virtual QList<quint32> messageIds() const = 0;
+
         virtual void processMessage(const mavlink_message_t& message) = 0;
 
     protected:
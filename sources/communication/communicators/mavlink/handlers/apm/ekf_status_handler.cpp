@@ -19,6 +19,11 @@ EkfStatusHandler::EkfStatusHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> EkfStatusHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_EKF_STATUS_REPORT };
+}
+
 void EkfStatusHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_EKF_STATUS_REPORT) return;
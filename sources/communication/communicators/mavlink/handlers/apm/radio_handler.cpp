@@ -21,6 +21,11 @@ RadioHandler::RadioHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> RadioHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_RADIO };
+}
+
 void RadioHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_RADIO) return;
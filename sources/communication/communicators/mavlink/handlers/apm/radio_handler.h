@@ -15,6 +15,8 @@ namespace comm
     public:
         explicit RadioHandler(MavLinkCommunicator* communicator);
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
 
     private:
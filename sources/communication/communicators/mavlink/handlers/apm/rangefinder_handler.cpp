@@ -21,6 +21,11 @@ RangefinderHandler::RangefinderHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> RangefinderHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_RANGEFINDER };
+}
+
 void RangefinderHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_RANGEFINDER) return;
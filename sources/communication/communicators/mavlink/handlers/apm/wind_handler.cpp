@@ -19,6 +19,11 @@ WindHandler::WindHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> WindHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_WIND };
+}
+
 void WindHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_WIND) return;
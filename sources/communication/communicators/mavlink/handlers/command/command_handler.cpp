@@ -89,6 +89,14 @@ CommandHandler::CommandHandler(MavLinkCommunicator* communicator):
 CommandHandler::~CommandHandler()
 {}
 
+QList<quint32> CommandHandler::messageIds() const
+{
+    return {
+        MAVLINK_MSG_ID_COMMAND_ACK,
+        MAVLINK_MSG_ID_HEARTBEAT
+    };
+}
+
 void CommandHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid == MAVLINK_MSG_ID_COMMAND_ACK) this->processCommandAck(message);
@@ -19,6 +19,8 @@ namespace comm
         explicit CommandHandler(MavLinkCommunicator* communicator);
         ~CommandHandler() override;
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
 
     public slots:
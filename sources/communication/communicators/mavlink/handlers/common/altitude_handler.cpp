@@ -20,6 +20,11 @@ AltitudeHandler::AltitudeHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> AltitudeHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_ALTITUDE };
+}
+
 void AltitudeHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_ALTITUDE) return;
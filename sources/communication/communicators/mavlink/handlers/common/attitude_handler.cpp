@@ -21,6 +21,11 @@ AttitudeHandler::AttitudeHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> AttitudeHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_ATTITUDE };
+}
+
 void AttitudeHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_ATTITUDE) return;
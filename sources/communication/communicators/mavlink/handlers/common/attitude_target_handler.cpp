@@ -22,6 +22,11 @@ AttitudeTargetHandler::AttitudeTargetHandler(MavLinkCommunicator* communicator):
 //            this, &AttitudeTargetHandler::sendAttitude);
 }
 
+QList<quint32> AttitudeTargetHandler::messageIds() const
+{
+    return {}; // TODO: handle feedback
+}
+
 void AttitudeTargetHandler::processMessage(const mavlink_message_t& message)
 {
     Q_UNUSED(message) // TODO: handle feedback
@@ -15,6 +15,8 @@ namespace comm
     public:
         explicit AttitudeTargetHandler(MavLinkCommunicator* communicator);
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
 
         void sendAttitude(int vehicledId, float pitch, float roll, float thrust, float yaw);
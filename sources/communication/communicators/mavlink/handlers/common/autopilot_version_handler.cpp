@@ -35,6 +35,14 @@ AutopilotVersionHandler::AutopilotVersionHandler(MavLinkCommunicator* communicat
 AutopilotVersionHandler::~AutopilotVersionHandler()
 {}
 
+QList<quint32> AutopilotVersionHandler::messageIds() const
+{
+    return {
+        MAVLINK_MSG_ID_COMMAND_ACK,
+        MAVLINK_MSG_ID_AUTOPILOT_VERSION
+    };
+}
+
 void AutopilotVersionHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid == MAVLINK_MSG_ID_COMMAND_ACK)
@@ -22,6 +22,8 @@ namespace comm
         explicit AutopilotVersionHandler(MavLinkCommunicator* communicator);
         ~AutopilotVersionHandler() override;
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
 
     public slots:
@@ -21,6 +21,15 @@ FlightHandler::FlightHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> FlightHandler::messageIds() const
+{
+#ifdef MAVLINK_V2
+    return { MAVLINK_MSG_ID_FLIGHT_INFORMATION };
+#else
+    return {};
+#endif
+}
+
 void FlightHandler::processMessage(const mavlink_message_t& message)
 {
 #ifdef MAVLINK_V2
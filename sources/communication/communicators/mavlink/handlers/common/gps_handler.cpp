@@ -27,6 +27,14 @@ GpsHandler::GpsHandler(MavLinkCommunicator* communicator):
     qRegisterMetaType<SatelliteInfo>("SatelliteInfo");
 }
 
+QList<quint32> GpsHandler::messageIds() const
+{
+    return {
+        MAVLINK_MSG_ID_GPS_RAW_INT,
+        MAVLINK_MSG_ID_GPS_STATUS
+    };
+}
+
 void GpsHandler::processMessage(const mavlink_message_t& message)
 {
     switch (message.msgid)
@@ -106,6 +106,11 @@ HeartbeatHandler::~HeartbeatHandler()
     for (QBasicTimer* timer: d->vehicleTimers.values()) delete timer;
 }
 
+QList<quint32> HeartbeatHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_HEARTBEAT };
+}
+
 void HeartbeatHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_HEARTBEAT) return;
@@ -119,7 +124,7 @@ void HeartbeatHandler::processMessage(const mavlink_message_t& message)
 
     dto::VehiclePtr vehicle = d->vehicleService->vehicle(vehicleId);
 
-    if (!vehicle && settings::Provider::value(settings::communication::autoAdd).toBool())
+    if (!vehicle && settings::Provider::snapshot().autoAdd.load())
     {
         vehicle = dto::VehiclePtr::create();
         vehicle->setMavId(message.sysid);
@@ -145,7 +150,7 @@ void HeartbeatHandler::processMessage(const mavlink_message_t& message)
             d->vehicleTimers[vehicleId] = new QBasicTimer();
         }
         d->vehicleTimers[vehicleId]->start(
-                    settings::Provider::value(settings::communication::timeout).toInt(),
+                    settings::Provider::snapshot().timeout.load(),
                     this);
 
         if (vehicle->type() == dto::Vehicle::Auto)
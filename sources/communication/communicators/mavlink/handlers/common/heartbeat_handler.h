@@ -17,6 +17,8 @@ namespace comm
         explicit HeartbeatHandler(MavLinkCommunicator* communicator);
         ~HeartbeatHandler() override;
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
 
     public slots:
@@ -22,6 +22,11 @@ HighLatencyHandler::HighLatencyHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> HighLatencyHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_HIGH_LATENCY };
+}
+
 void HighLatencyHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_HIGH_LATENCY) return;
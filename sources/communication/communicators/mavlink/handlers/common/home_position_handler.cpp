@@ -67,6 +67,11 @@ HomePositionHandler::HomePositionHandler(MavLinkCommunicator* communicator):
 HomePositionHandler::~HomePositionHandler()
 {}
 
+QList<quint32> HomePositionHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_HOME_POSITION };
+}
+
 void HomePositionHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_HOME_POSITION) return;
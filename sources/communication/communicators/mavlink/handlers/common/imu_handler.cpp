@@ -20,6 +20,11 @@ ImuHandler::ImuHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> ImuHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_SCALED_IMU };
+}
+
 void ImuHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_SCALED_IMU) return;
@@ -21,6 +21,11 @@ LandTargetHandler::LandTargetHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> LandTargetHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_LANDING_TARGET };
+}
+
 void LandTargetHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_LANDING_TARGET) return;
@@ -21,6 +21,11 @@ NavControllerHandler::NavControllerHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> NavControllerHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT };
+}
+
 void NavControllerHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT) return;
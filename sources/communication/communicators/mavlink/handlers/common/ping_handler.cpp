@@ -12,6 +12,11 @@ PingHandler::PingHandler(MavLinkCommunicator* communicator):
     AbstractMavLinkHandler(communicator)
 {}
 
+QList<quint32> PingHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_PING };
+}
+
 void PingHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_PING) return;
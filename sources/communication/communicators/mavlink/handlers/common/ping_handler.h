@@ -10,6 +10,8 @@ namespace comm
     public:
         explicit PingHandler(MavLinkCommunicator* communicator); // TODO: send ping
 
+        QList<quint32> messageIds() const override;
+
         void processMessage(const mavlink_message_t& message) override;
     };
 }
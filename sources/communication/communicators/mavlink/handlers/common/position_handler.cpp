@@ -23,6 +23,11 @@ PositionHandler::PositionHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> PositionHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_GLOBAL_POSITION_INT };
+}
+
 void PositionHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_GLOBAL_POSITION_INT) return;
@@ -21,6 +21,11 @@ PressureHandler::PressureHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> PressureHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_SCALED_PRESSURE };
+}
+
 void PressureHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_SCALED_PRESSURE) return;
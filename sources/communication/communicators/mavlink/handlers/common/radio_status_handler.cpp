@@ -21,6 +21,11 @@ RadioStatusHandler::RadioStatusHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> RadioStatusHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_RADIO_STATUS };
+}
+
 void RadioStatusHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_RADIO_STATUS) return;
@@ -22,6 +22,11 @@ SystemStatusHandler::SystemStatusHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> SystemStatusHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_SYS_STATUS };
+}
+
 void SystemStatusHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_SYS_STATUS) return;
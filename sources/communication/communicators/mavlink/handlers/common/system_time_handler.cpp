@@ -22,6 +22,11 @@ SystemTimeHandler::SystemTimeHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> SystemTimeHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_SYSTEM_TIME };
+}
+
 void SystemTimeHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_SYSTEM_TIME) return;
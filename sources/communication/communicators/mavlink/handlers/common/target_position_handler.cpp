@@ -22,6 +22,11 @@ TargetPositionHandler::TargetPositionHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> TargetPositionHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT };
+}
+
 void TargetPositionHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT) return;
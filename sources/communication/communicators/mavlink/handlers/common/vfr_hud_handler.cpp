@@ -21,6 +21,11 @@ VfrHudHandler::VfrHudHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> VfrHudHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_VFR_HUD };
+}
+
 void VfrHudHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_VFR_HUD) return;
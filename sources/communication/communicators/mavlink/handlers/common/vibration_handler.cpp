@@ -21,6 +21,11 @@ VibrationHandler::VibrationHandler(MavLinkCommunicator* communicator):
     m_telemetryService(serviceRegistry->telemetryService())
 {}
 
+QList<quint32> VibrationHandler::messageIds() const
+{
+    return { MAVLINK_MSG_ID_VIBRATION };
+}
+
 void VibrationHandler::processMessage(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_VIBRATION) return;
@@ -5,6 +5,7 @@
 
 // Qt
 #include <QMap>
+#include <QElapsedTimer>
 #include <QTimerEvent>
 #include <QCoreApplication>
 #include <QDebug>
@@ -16,6 +17,7 @@
 #include "mission_assignment.h"
 
 #include "mavlink_communicator.h"
+#include "mission_transfer.h"
 
 #include "service_registry.h"
 #include "command_service.h"
@@ -29,7 +31,11 @@
 
 namespace
 {
-    const int interval = 2000;
+    const int maxRetries = 5;
+    const int partialRetries = 2; // Before falling back to full upload
+    const int saveBatch = 64; // Downloaded items saved in one transaction
+
+    const double coordinateScale = 1e7; // Degrees in MISSION_ITEM_INT
 
     const QMap<quint16, dto::MissionItem::Command> mavCommandLongMap =
     {
@@ -85,6 +91,186 @@ namespace
             return qApp->translate("MissionHandler", "unknown");
         }
     }
+
+    // MISSION_ITEM and MISSION_ITEM_INT differ only in position and frames
+    void encodePosition(const dto::MissionItemPtr& item, mavlink_mission_item_t& msgItem)
+    {
+        msgItem.x = static_cast<float>(item->latitude());
+        msgItem.y = static_cast<float>(item->longitude());
+    }
+
+    void encodePosition(const dto::MissionItemPtr& item, mavlink_mission_item_int_t& msgItem)
+    {
+        msgItem.x = qRound(item->latitude() * ::coordinateScale);
+        msgItem.y = qRound(item->longitude() * ::coordinateScale);
+    }
+
+    void decodePosition(const mavlink_mission_item_t& msgItem, const dto::MissionItemPtr& item)
+    {
+        item->setLatitude(static_cast<double>(msgItem.x));
+        item->setLongitude(static_cast<double>(msgItem.y));
+    }
+
+    void decodePosition(const mavlink_mission_item_int_t& msgItem,
+                        const dto::MissionItemPtr& item)
+    {
+        item->setLatitude(msgItem.x / ::coordinateScale);
+        item->setLongitude(msgItem.y / ::coordinateScale);
+    }
+
+    quint8 globalFrame(const mavlink_mission_item_t&, bool relative)
+    {
+        return relative ? MAV_FRAME_GLOBAL_RELATIVE_ALT : MAV_FRAME_GLOBAL;
+    }
+
+    quint8 globalFrame(const mavlink_mission_item_int_t&, bool relative)
+    {
+        return relative ? MAV_FRAME_GLOBAL_RELATIVE_ALT_INT : MAV_FRAME_GLOBAL_INT;
+    }
+
+    template <typename Message>
+    void encodeItem(const dto::MissionItemPtr& item, int count, Message& msgItem)
+    {
+        // TODO: mission item to message convertor class
+        msgItem.seq = item->sequence();
+        msgItem.autocontinue = item->sequence() < count - 1;
+
+        if (item->sequence()) msgItem.command = ::mavCommandLongMap.key(item->command(), 0);
+        else msgItem.command = MAV_CMD_NAV_WAYPOINT; // Home is waypoint
+
+        if (item->isAltitudedItem())
+        {
+            msgItem.frame = ::globalFrame(msgItem, item->isAltitudeRelative());
+            msgItem.z = item->altitude();
+        }
+
+        if (item->isPositionatedItem()) ::encodePosition(item, msgItem);
+
+        if (msgItem.command == MAV_CMD_NAV_TAKEOFF)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::Pitch).toFloat();
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LAND)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::AbortAltitude).toFloat();
+            msgItem.param4 = item->parameter(dto::MissionItem::Yaw).toFloat();
+        }
+        else if (msgItem.command == MAV_CMD_NAV_WAYPOINT)
+        {
+            msgItem.param2 = item->parameter(dto::MissionItem::Radius).toFloat();
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_UNLIM ||
+                 msgItem.command == MAV_CMD_NAV_LOITER_TURNS ||
+                 msgItem.command == MAV_CMD_NAV_LOITER_TIME)
+        {
+            msgItem.param3 = item->parameter(dto::MissionItem::Clockwise).toBool() ?
+                                 item->parameter(dto::MissionItem::Radius).toFloat() :
+                                 -1 * item->parameter(dto::MissionItem::Radius).toFloat();
+            msgItem.param4 = item->parameter(dto::MissionItem::Yaw).toFloat();
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_TO_ALT)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::HeadingRequired).toBool();
+            msgItem.param2 = item->parameter(dto::MissionItem::Clockwise).toBool() ?
+                                 item->parameter(dto::MissionItem::Radius).toFloat() :
+                                 -1 * item->parameter(dto::MissionItem::Radius).toFloat();
+        }
+        else if (msgItem.command == MAV_CMD_DO_CHANGE_SPEED)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::IsGroundSpeed).toBool();
+            msgItem.param2 = item->parameter(dto::MissionItem::Speed, -1).toFloat();
+            msgItem.param3 = item->parameter(dto::MissionItem::Throttle, -1).toInt();
+        }
+
+        if (msgItem.command == MAV_CMD_NAV_LOITER_TURNS)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::Repeats).toInt();
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_TIME)
+        {
+            msgItem.param1 = item->parameter(dto::MissionItem::Time).toFloat();
+        }
+
+//    if (msgItem.command == MAV_CMD_NAV_CONTINUE_AND_CHANGE_ALT)
+//    {
+//  TODO: In Plane 3.4 (and later) the param1 value sets how close the vehicle
+//        altitude must be to target altitude for command completion.
+//    }
+
+#ifdef MAVLINK_V2
+        msgItem.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
+    }
+
+    template <typename Message>
+    void decodeItem(const Message& msgItem, const dto::MissionItemPtr& item)
+    {
+        item->setCommand(msgItem.seq > 0 ?
+                             ::mavCommandLongMap.value(msgItem.command,
+                                                       dto::MissionItem::UnknownCommand) :
+                             dto::MissionItem::Home);
+
+        if (item->isAltitudedItem())
+        {
+            item->setAltitudeRelative(msgItem.frame == MAV_FRAME_GLOBAL_RELATIVE_ALT ||
+                                      msgItem.frame == MAV_FRAME_GLOBAL_RELATIVE_ALT_INT);
+            item->setAltitude(msgItem.z);
+        }
+
+        if (item->isPositionatedItem()) ::decodePosition(msgItem, item);
+
+        if (msgItem.command == MAV_CMD_NAV_TAKEOFF)
+        {
+            item->setParameter(dto::MissionItem::Pitch, msgItem.param1);
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LAND)
+        {
+            item->setParameter(dto::MissionItem::AbortAltitude, msgItem.param1);
+            item->setParameter(dto::MissionItem::Yaw, msgItem.param4);
+        }
+        else if (msgItem.command == MAV_CMD_NAV_WAYPOINT)
+        {
+            item->setParameter(dto::MissionItem::Radius, msgItem.param2);
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_UNLIM ||
+                 msgItem.command == MAV_CMD_NAV_LOITER_TURNS ||
+                 msgItem.command == MAV_CMD_NAV_LOITER_TIME)
+        {
+            item->setParameter(dto::MissionItem::Radius, qAbs(msgItem.param3));
+            item->setParameter(dto::MissionItem::Clockwise, bool(msgItem.param3 > 0));
+            item->setParameter(dto::MissionItem::Yaw, msgItem.param4);
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_TO_ALT)
+        {
+            item->setParameter(dto::MissionItem::HeadingRequired, bool(msgItem.param1));
+            item->setParameter(dto::MissionItem::Radius, qAbs(msgItem.param2));
+            item->setParameter(dto::MissionItem::Clockwise, bool(msgItem.param2 > 0));
+        }
+        else if (msgItem.command == MAV_CMD_DO_CHANGE_SPEED)
+        {
+            item->setParameter(dto::MissionItem::IsGroundSpeed, bool(msgItem.param1));
+            if (msgItem.param2 != -1) item->setParameter(dto::MissionItem::Speed, msgItem.param2);
+            if (msgItem.param3 != -1)
+            {
+                item->setParameter(dto::MissionItem::Throttle, int(msgItem.param3));
+            }
+        }
+
+        if (msgItem.command == MAV_CMD_NAV_LOITER_TURNS)
+        {
+            item->setParameter(dto::MissionItem::Repeats, int(msgItem.param1));
+        }
+        else if (msgItem.command == MAV_CMD_NAV_LOITER_TIME)
+        {
+            item->setParameter(dto::MissionItem::Time, msgItem.param1);
+        }
+
+//    if (msgItem.command == MAV_CMD_NAV_CONTINUE_AND_CHANGE_ALT)
+//    {
+//  TODO: In APM Plane 3.4 (and later) the param1 value sets how close the vehicle
+//        altitude must be to target altitude for command completion.
+//    }
+    }
 }
 
 using namespace comm;
@@ -97,10 +283,14 @@ public:
     TelemetryService* telemetryService = serviceRegistry->telemetryService();
     MissionService* missionService = serviceRegistry->missionService();
 
-    QMap <quint8, MissionHandler::Stage> mavStages;
-    QMap <quint8, int> mavTimers;
-    QMap <quint8, QList<int> > mavSequencer;
-    int lastSendedSequence = -1;
+    QMap<quint8, MissionTransfer> transfers;
+    QMap<int, quint8> timers;
+    QElapsedTimer clock;
+
+    Impl()
+    {
+        clock.start();
+    }
 };
 
 MissionHandler::MissionHandler(MavLinkCommunicator* communicator):
@@ -116,6 +306,20 @@ MissionHandler::MissionHandler(MavLinkCommunicator* communicator):
 MissionHandler::~MissionHandler()
 {}
 
+QList<quint32> MissionHandler::messageIds() const
+{
+    return {
+        MAVLINK_MSG_ID_MISSION_COUNT,
+        MAVLINK_MSG_ID_MISSION_ITEM,
+        MAVLINK_MSG_ID_MISSION_ITEM_INT,
+        MAVLINK_MSG_ID_MISSION_REQUEST,
+        MAVLINK_MSG_ID_MISSION_REQUEST_INT,
+        MAVLINK_MSG_ID_MISSION_ACK,
+        MAVLINK_MSG_ID_MISSION_CURRENT,
+        MAVLINK_MSG_ID_MISSION_ITEM_REACHED
+    };
+}
+
 void MissionHandler::processMessage(const mavlink_message_t& message)
 {
     switch (message.msgid)
@@ -124,9 +328,11 @@ void MissionHandler::processMessage(const mavlink_message_t& message)
         this->processMissionCount(message);
         break;
     case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
         this->processMissionItem(message);
         break;
     case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
         this->processMissionRequest(message);
         break;
     case MAVLINK_MSG_ID_MISSION_ACK:
@@ -148,6 +354,8 @@ void MissionHandler::download(const dto::MissionAssignmentPtr& assignment)
     dto::VehiclePtr vehicle = d->vehicleService->vehicle(assignment->vehicleId());
     if (vehicle.isNull()) return;
 
+    d->transfers[vehicle->mavId()].start(assignment);
+
     assignment->setStatus(dto::MissionAssignment::Downloading);
     assignment->setProgress(0);
     d->missionService->assignmentChanged(assignment);
@@ -161,33 +369,47 @@ void MissionHandler::upload(const dto::MissionAssignmentPtr& assignment)
     dto::VehiclePtr vehicle = d->vehicleService->vehicle(assignment->vehicleId());
     if (vehicle.isNull()) return;
 
-    d->mavSequencer[vehicle->mavId()].clear();
-    for (const dto::MissionItemPtr& item: d->missionService->missionItems(assignment->missionId()))
-    {
-        d->mavSequencer[vehicle->mavId()].append(item->sequence());
-        item->setStatus(dto::MissionItem::NotActual);
-        d->missionService->missionItemChanged(item);
-    }
-
-    if (d->mavSequencer.isEmpty())
+    dto::MissionItemPtrList items = d->missionService->missionItems(assignment->missionId());
+    if (items.isEmpty())
     {
         this->enterStage(Stage::Idle, vehicle->mavId());
+        return;
     }
-    else
+
+    MissionTransfer& transfer = d->transfers[vehicle->mavId()];
+    transfer.start(assignment);
+    transfer.count = items.count();
+
+    // Vehicle has this mission already, so only not actual items are written over
+    if (transfer.partialWrites && transfer.knownMissionId == assignment->missionId() &&
+        transfer.knownCount == transfer.count)
     {
-        assignment->setStatus(dto::MissionAssignment::Uploading);
-        assignment->setProgress(0);
-        d->missionService->assignmentChanged(assignment);
+        transfer.ranges = MissionTransfer::changedRanges(items);
+        if (transfer.ranges.isEmpty())
+        {
+            assignment->setStatus(dto::MissionAssignment::Actual);
+            d->missionService->assignmentChanged(assignment);
+            return;
+        }
 
-        d->lastSendedSequence = -1;
-        this->enterStage(Stage::SendingCount, vehicle->mavId());
-        this->sendMissionCount(vehicle->mavId());
+        if (transfer.ranges.count() == 1 && transfer.ranges.first().first == 0 &&
+            transfer.ranges.first().second == transfer.count - 1) transfer.ranges.clear();
     }
+
+    assignment->setStatus(dto::MissionAssignment::Uploading);
+    assignment->setProgress(0);
+    d->missionService->assignmentChanged(assignment);
+
+    if (transfer.ranges.isEmpty()) this->uploadAll(vehicle->mavId());
+    else this->uploadNextRange(vehicle->mavId());
 }
 
 void MissionHandler::cancelSync(const dto::MissionAssignmentPtr& assignment)
 {
-    this->enterStage(Stage::Idle, d->vehicleService->mavIdByVehicleId(assignment->vehicleId()));
+    quint8 mavId = d->vehicleService->mavIdByVehicleId(assignment->vehicleId());
+    this->enterStage(Stage::Idle, mavId);
+    this->saveDownloaded(mavId);
+    d->transfers[mavId].assignment.clear();
 
     assignment->setStatus(dto::MissionAssignment::NotActual);
     assignment->setProgress(0);
@@ -202,6 +424,10 @@ void MissionHandler::requestMissionCount(quint8 mavId)
     request.target_system = mavId;
     request.target_component = MAV_COMP_ID_MISSIONPLANNER;
 
+#ifdef MAVLINK_V2
+    request.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
+
     AbstractLink* link = m_communicator->mavSystemLink(mavId);
     if (!link) return;
 
@@ -210,45 +436,71 @@ void MissionHandler::requestMissionCount(quint8 mavId)
                                                  m_communicator->linkChannel(link),
                                                  &message, &request);
     m_communicator->sendMessage(message, link);
+
+    MissionTransfer::stamp(d->transfers[mavId].countRequest, d->clock.elapsed());
 }
 
 void MissionHandler::requestMissionItem(quint8 mavId, quint16 seq)
 {
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(
-                                               d->vehicleService->vehicleIdByMavId(mavId));
-    if (assignment.isNull()) return;
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull()) return;
+
+    AbstractLink* link = m_communicator->mavSystemLink(mavId);
+    if (!link) return;
 
     mavlink_message_t message;
-    mavlink_mission_request_t missionRequest;
+    if (transfer.intItems)
+    {
+        mavlink_mission_request_int_t missionRequest;
+
+        missionRequest.target_system = mavId;
+        missionRequest.target_component = MAV_COMP_ID_MISSIONPLANNER;
+        missionRequest.seq = seq;
+#ifdef MAVLINK_V2
+        missionRequest.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
 
-    missionRequest.target_system = mavId;
-    missionRequest.target_component = MAV_COMP_ID_MISSIONPLANNER;
-    missionRequest.seq = seq;
+        mavlink_msg_mission_request_int_encode_chan(m_communicator->systemId(),
+                                                    m_communicator->componentId(),
+                                                    m_communicator->linkChannel(link),
+                                                    &message, &missionRequest);
+    }
+    else
+    {
+        mavlink_mission_request_t missionRequest;
 
-    AbstractLink* link = m_communicator->mavSystemLink(mavId);
-    if (!link) return;
+        missionRequest.target_system = mavId;
+        missionRequest.target_component = MAV_COMP_ID_MISSIONPLANNER;
+        missionRequest.seq = seq;
+#ifdef MAVLINK_V2
+        missionRequest.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
 
-    mavlink_msg_mission_request_encode_chan(m_communicator->systemId(),
-                                            m_communicator->componentId(),
-                                            m_communicator->linkChannel(link),
-                                            &message, &missionRequest);
+        mavlink_msg_mission_request_encode_chan(m_communicator->systemId(),
+                                                m_communicator->componentId(),
+                                                m_communicator->linkChannel(link),
+                                                &message, &missionRequest);
+    }
     m_communicator->sendMessage(message, link);
+
+    MissionTransfer::stamp(transfer.requests[seq], d->clock.elapsed());
 }
 
 void MissionHandler::sendMissionCount(quint8 mavId)
 {
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(
-                                               d->vehicleService->vehicleIdByMavId(mavId));
-    if (assignment.isNull()) return;
-
-    dto::MissionPtr mission = d->missionService->mission(assignment->missionId());
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull()) return;
 
     mavlink_message_t message;
     mavlink_mission_count_t countMessage;
 
     countMessage.target_system = mavId;
     countMessage.target_component = MAV_COMP_ID_MISSIONPLANNER;
-    countMessage.count = mission->count();
+    countMessage.count = transfer.count;
+
+#ifdef MAVLINK_V2
+    countMessage.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
 
     AbstractLink* link = m_communicator->mavSystemLink(mavId);
     if (!link) return;
@@ -258,121 +510,83 @@ void MissionHandler::sendMissionCount(quint8 mavId)
                                           m_communicator->linkChannel(link),
                                           &message, &countMessage);
     m_communicator->sendMessage(message, link);
+
+    MissionTransfer::stamp(transfer.countRequest, d->clock.elapsed());
 }
 
-void MissionHandler::sendMissionItem(quint8 mavId, quint16 seq)
+void MissionHandler::sendMissionPartialList(quint8 mavId, quint16 start, quint16 end)
 {
-    int vehicleId = d->vehicleService->vehicleIdByMavId(mavId);
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
-    if (assignment.isNull()) return;
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull()) return;
 
     mavlink_message_t message;
-    mavlink_mission_item_t msgItem;
+    mavlink_mission_write_partial_list_t partialList;
 
-    msgItem.target_system = mavId;
-    msgItem.target_component = MAV_COMP_ID_MISSIONPLANNER;
+    partialList.target_system = mavId;
+    partialList.target_component = MAV_COMP_ID_MISSIONPLANNER;
+    partialList.start_index = start;
+    partialList.end_index = end;
 
-    // TODO: mission item to message convertor class
-    dto::MissionItemPtr item = d->missionService->missionItem(assignment->missionId(), seq);
-    if (item.isNull()) return;
-
-    msgItem.seq = seq;
-    msgItem.autocontinue = seq < d->missionService->mission(assignment->missionId())->count() - 1;
-
-    if (seq) msgItem.command = ::mavCommandLongMap.key(item->command(), 0);
-    else msgItem.command = MAV_CMD_NAV_WAYPOINT; // Home is waypoint
-
-    if (item->isAltitudedItem())
-    {
-        msgItem.frame = item->isAltitudeRelative() ? MAV_FRAME_GLOBAL_RELATIVE_ALT :
-                                                      MAV_FRAME_GLOBAL;
-        msgItem.z = item->altitude();
-    }
+#ifdef MAVLINK_V2
+    partialList.mission_type = MAV_MISSION_TYPE_MISSION;
+#endif
 
-    if (item->isPositionatedItem())
-    {
-        msgItem.x = static_cast<float>(item->latitude());
-        msgItem.y = static_cast<float>(item->longitude());
-    }
+    AbstractLink* link = m_communicator->mavSystemLink(mavId);
+    if (!link) return;
 
-    msgItem.param1 = 0;
-    msgItem.param2 = 0;
-    msgItem.param3 = 0;
-    msgItem.param4 = 0;
+    mavlink_msg_mission_write_partial_list_encode_chan(m_communicator->systemId(),
+                                                       m_communicator->componentId(),
+                                                       m_communicator->linkChannel(link),
+                                                       &message, &partialList);
+    m_communicator->sendMessage(message, link);
 
-    if (msgItem.command == MAV_CMD_NAV_TAKEOFF)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::Pitch).toFloat();
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LAND)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::AbortAltitude).toFloat();
-        msgItem.param4 = item->parameter(dto::MissionItem::Yaw).toFloat();
-    }
-    else if (msgItem.command == MAV_CMD_NAV_WAYPOINT)
-    {
-        msgItem.param2 = item->parameter(dto::MissionItem::Radius).toFloat();
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_UNLIM ||
-             msgItem.command == MAV_CMD_NAV_LOITER_TURNS ||
-             msgItem.command == MAV_CMD_NAV_LOITER_TIME)
-    {
-        msgItem.param3 = item->parameter(dto::MissionItem::Clockwise).toBool() ?
-                             item->parameter(dto::MissionItem::Radius).toFloat() :
-                             -1 * item->parameter(dto::MissionItem::Radius).toFloat();
-        msgItem.param4 = item->parameter(dto::MissionItem::Yaw).toFloat();
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_TO_ALT)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::HeadingRequired).toBool();
-        msgItem.param2 = item->parameter(dto::MissionItem::Clockwise).toBool() ?
-                             item->parameter(dto::MissionItem::Radius).toFloat() :
-                             -1 * item->parameter(dto::MissionItem::Radius).toFloat();
-    }
-    else if (msgItem.command == MAV_CMD_DO_CHANGE_SPEED)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::IsGroundSpeed).toBool();
-        msgItem.param2 = item->parameter(dto::MissionItem::Speed, -1).toFloat();
-        msgItem.param3 = item->parameter(dto::MissionItem::Throttle, -1).toInt();
-    }
+    MissionTransfer::stamp(transfer.countRequest, d->clock.elapsed());
+}
 
-    if (msgItem.command == MAV_CMD_NAV_LOITER_TURNS)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::Repeats).toInt();
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_TIME)
-    {
-        msgItem.param1 = item->parameter(dto::MissionItem::Time).toFloat();
-    }
+void MissionHandler::sendMissionItem(quint8 mavId, quint16 seq)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull()) return;
 
-//    if (msgItem.command == MAV_CMD_NAV_CONTINUE_AND_CHANGE_ALT)
-//    {
-//  TODO: In Plane 3.4 (and later) the param1 value sets how close the vehicle
-//        altitude must be to target altitude for command completion.
-//    }
+    dto::MissionItemPtr item = d->missionService->missionItem(
+                                   transfer.assignment->missionId(), seq);
+    if (item.isNull()) return;
 
     AbstractLink* link = m_communicator->mavSystemLink(mavId);
     if (!link) return;
 
-    mavlink_msg_mission_item_encode_chan(m_communicator->systemId(),
-                                         m_communicator->componentId(),
-                                         m_communicator->linkChannel(link),
-                                         &message, &msgItem);
-    m_communicator->sendMessage(message, link);
+    mavlink_message_t message;
+    if (transfer.intItems)
+    {
+        mavlink_mission_item_int_t msgItem = mavlink_mission_item_int_t();
 
-    item->setStatus(dto::MissionItem::Actual);
-    d->lastSendedSequence = seq;
-    d->missionService->missionItemChanged(item);
+        msgItem.target_system = mavId;
+        msgItem.target_component = MAV_COMP_ID_MISSIONPLANNER;
+        ::encodeItem(item, transfer.count, msgItem);
 
-    if (d->mavStages[mavId] == Stage::SendingItem)
+        mavlink_msg_mission_item_int_encode_chan(m_communicator->systemId(),
+                                                 m_communicator->componentId(),
+                                                 m_communicator->linkChannel(link),
+                                                 &message, &msgItem);
+    }
+    else
     {
-        d->mavSequencer[mavId].removeOne(seq);
-        assignment->addProgress();
+        mavlink_mission_item_t msgItem = mavlink_mission_item_t();
 
-        if (d->mavSequencer[mavId].isEmpty()) this->enterStage(Stage::WaitongAck, mavId);
+        msgItem.target_system = mavId;
+        msgItem.target_component = MAV_COMP_ID_MISSIONPLANNER;
+        ::encodeItem(item, transfer.count, msgItem);
 
-        d->missionService->assignmentChanged(assignment);
+        mavlink_msg_mission_item_encode_chan(m_communicator->systemId(),
+                                             m_communicator->componentId(),
+                                             m_communicator->linkChannel(link),
+                                             &message, &msgItem);
     }
+    m_communicator->sendMessage(message, link);
+
+    if (transfer.lastSent != seq) transfer.itemRequest = MissionTransfer::Request();
+    MissionTransfer::stamp(transfer.itemRequest, d->clock.elapsed());
+    transfer.lastSent = seq;
 }
 
 void MissionHandler::sendMissionAck(quint8 mavId)
@@ -401,182 +615,187 @@ void MissionHandler::sendMissionAck(quint8 mavId)
 void MissionHandler::processMissionCount(const mavlink_message_t& message)
 {
     // Ignore mission_count, if we are not downloading mission
-    if (d->mavStages.value(message.sysid, Stage::Idle) != Stage::WaitingCount) return;
-
-    int vehicleId = d->vehicleService->vehicleIdByMavId(message.sysid);
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
-    if (assignment.isNull()) return;
+    auto transfer = d->transfers.find(message.sysid);
+    if (transfer == d->transfers.end() || transfer->stage != Stage::WaitingCount) return;
 
     mavlink_mission_count_t missionCount;
     mavlink_msg_mission_count_decode(&message, &missionCount);
 
+#ifdef MAVLINK_V2
+    if (missionCount.mission_type != MAV_MISSION_TYPE_MISSION) return;
+#endif
+
+    transfer->addRoundTrip(transfer->countRequest, d->clock.elapsed());
+    transfer->retries = 0;
+
     // Remove superfluous items
+    dto::MissionItemPtrList superfluous;
     for (const dto::MissionItemPtr& item:
-         d->missionService->missionItems(assignment->missionId()))
+         d->missionService->missionItems(transfer->assignment->missionId()))
     {
-        if (item->sequence() > missionCount.count - 1) d->missionService->remove(item);
+        if (item->sequence() > missionCount.count - 1) superfluous.append(item);
     }
+    if (!superfluous.isEmpty()) d->missionService->remove(superfluous);
 
     // TODO: append fake items
-    d->mavSequencer[message.sysid].clear();
-    for (int seq = 0; seq < missionCount.count; ++seq)
+    transfer->count = missionCount.count;
+    transfer->next = 0;
+    transfer->requests.clear();
+
+    if (transfer->count)
     {
-        d->mavSequencer[message.sysid].append(seq);
+        this->enterStage(Stage::WaitingItem, message.sysid);
+        this->requestMissionItems(message.sysid);
+    }
+    else
+    {
+        this->sendMissionAck(message.sysid);
+        this->finishSync(message.sysid, true);
     }
-
-    this->enterStage(Stage::WaitingItem, message.sysid);
-    this->requestMissionItem(message.sysid, 0);
 }
 
 void MissionHandler::processMissionItem(const mavlink_message_t& message)
 {
-    int vehicleId = d->vehicleService->vehicleIdByMavId(message.sysid);
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
-    if (assignment.isNull()) return;
-
     mavlink_mission_item_t msgItem;
-    mavlink_msg_mission_item_decode(&message, &msgItem);
+    mavlink_mission_item_int_t msgItemInt;
+    int seq;
+
+    bool isInt = message.msgid == MAVLINK_MSG_ID_MISSION_ITEM_INT;
+    if (isInt)
+    {
+        mavlink_msg_mission_item_int_decode(&message, &msgItemInt);
+        seq = msgItemInt.seq;
+#ifdef MAVLINK_V2
+        if (msgItemInt.mission_type != MAV_MISSION_TYPE_MISSION) return;
+#endif
+    }
+    else
+    {
+        mavlink_msg_mission_item_decode(&message, &msgItem);
+        seq = msgItem.seq;
+#ifdef MAVLINK_V2
+        if (msgItem.mission_type != MAV_MISSION_TYPE_MISSION) return;
+#endif
+    }
 
     // Don't allow mav to change items while not in downloading stage(except home)
-    if (d->mavStages.value(message.sysid, Stage::Idle) != Stage::WaitingItem &&
-        msgItem.seq != 0) return;
+    auto transfer = d->transfers.find(message.sysid);
+    bool downloading = transfer != d->transfers.end() && transfer->stage == Stage::WaitingItem;
+    if (!downloading && seq != 0) return;
+
+    dto::MissionAssignmentPtr assignment = downloading ?
+                                               transfer->assignment :
+                                               d->missionService->vehicleAssignment(
+                                                   d->vehicleService->vehicleIdByMavId(
+                                                       message.sysid));
+    if (assignment.isNull()) return;
 
-    dto::MissionItemPtr item = d->missionService->missionItem(assignment->missionId(), msgItem.seq);
+    // Repeated answer for already received item
+    if (downloading && !transfer->requests.contains(seq)) return;
+
+    dto::MissionItemPtr item = d->missionService->missionItem(assignment->missionId(), seq);
     if (item.isNull())
     {
         item = dto::MissionItemPtr::create();
         item->setMissionId(assignment->missionId());
-        item->setSequence(msgItem.seq);
+        item->setSequence(seq);
     }
 
-    item->setCommand(msgItem.seq > 0 ?
-                         ::mavCommandLongMap.value(msgItem.command, dto::MissionItem::UnknownCommand) :
-                         dto::MissionItem::Home);
+    if (isInt) ::decodeItem(msgItemInt, item);
+    else ::decodeItem(msgItem, item);
 
-    if (item->isAltitudedItem())
+    item->setStatus(dto::MissionItem::Actual);
+    if (!downloading)
     {
-        item->setAltitudeRelative(msgItem.frame == MAV_FRAME_GLOBAL_RELATIVE_ALT);
-        item->setAltitude(msgItem.z);
+        d->missionService->save(item);
+        return;
     }
 
-    if (item->isPositionatedItem())
-    {
-        item->setLatitude(static_cast<double>(msgItem.x));
-        item->setLongitude(static_cast<double>(msgItem.y));
-    }
+    // Downloaded items are saved in batches
+    transfer->downloaded.append(item);
+    if (transfer->downloaded.count() >= ::saveBatch) this->saveDownloaded(message.sysid);
 
-    if (msgItem.command == MAV_CMD_NAV_TAKEOFF)
-    {
-        item->setParameter(dto::MissionItem::Pitch, msgItem.param1);
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LAND)
-    {
-        item->setParameter(dto::MissionItem::AbortAltitude, msgItem.param1);
-        item->setParameter(dto::MissionItem::Yaw, msgItem.param4);
-    }
-    else if (msgItem.command == MAV_CMD_NAV_WAYPOINT)
-    {
-        item->setParameter(dto::MissionItem::Radius, msgItem.param2);
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_UNLIM ||
-             msgItem.command == MAV_CMD_NAV_LOITER_TURNS ||
-             msgItem.command == MAV_CMD_NAV_LOITER_TIME)
-    {
-        item->setParameter(dto::MissionItem::Radius, qAbs(msgItem.param3));
-        item->setParameter(dto::MissionItem::Clockwise, bool(msgItem.param3 > 0));
-        item->setParameter(dto::MissionItem::Yaw, msgItem.param4);
-    }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_TO_ALT)
-    {
-        item->setParameter(dto::MissionItem::HeadingRequired, bool(msgItem.param1));
-        item->setParameter(dto::MissionItem::Radius, qAbs(msgItem.param2));
-        item->setParameter(dto::MissionItem::Clockwise, bool(msgItem.param2 > 0));
-    }
-    else if (msgItem.command == MAV_CMD_DO_CHANGE_SPEED)
+    transfer->addRoundTrip(transfer->requests.take(seq), d->clock.elapsed());
+    transfer->received = true;
+    transfer->retries = 0;
+    assignment->addProgress();
+
+    if (transfer->requests.isEmpty() && transfer->next >= transfer->count)
     {
-        item->setParameter(dto::MissionItem::IsGroundSpeed, bool(msgItem.param1));
-        if (msgItem.param2 != -1) item->setParameter(dto::MissionItem::Speed, msgItem.param2);
-        if (msgItem.param3 != -1) item->setParameter(dto::MissionItem::Throttle, int(msgItem.param3));
+        this->sendMissionAck(message.sysid);
+        this->finishSync(message.sysid, true);
+        return;
     }
 
-    if (msgItem.command == MAV_CMD_NAV_LOITER_TURNS)
+    this->enterStage(Stage::WaitingItem, message.sysid);
+    this->requestMissionItems(message.sysid);
+    d->missionService->assignmentChanged(assignment);
+}
+
+void MissionHandler::processMissionRequest(const mavlink_message_t& message)
+{
+    int seq;
+
+    bool isInt = message.msgid == MAVLINK_MSG_ID_MISSION_REQUEST_INT;
+    if (isInt)
     {
-        item->setParameter(dto::MissionItem::Repeats, int(msgItem.param1));
+        mavlink_mission_request_int_t request;
+        mavlink_msg_mission_request_int_decode(&message, &request);
+        seq = request.seq;
+#ifdef MAVLINK_V2
+        if (request.mission_type != MAV_MISSION_TYPE_MISSION) return;
+#endif
     }
-    else if (msgItem.command == MAV_CMD_NAV_LOITER_TIME)
+    else
     {
-        item->setParameter(dto::MissionItem::Time, msgItem.param1);
+        mavlink_mission_request_t request;
+        mavlink_msg_mission_request_decode(&message, &request);
+        seq = request.seq;
+#ifdef MAVLINK_V2
+        if (request.mission_type != MAV_MISSION_TYPE_MISSION) return;
+#endif
     }
 
-//    if (msgItem.command == MAV_CMD_NAV_CONTINUE_AND_CHANGE_ALT)
-//    {
-//  TODO: In APM Plane 3.4 (and later) the param1 value sets how close the vehicle
-//        altitude must be to target altitude for command completion.
-//    }
-
-    item->setStatus(dto::MissionItem::Actual);
-    d->missionService->save(item);
+    auto transfer = d->transfers.find(message.sysid);
+    if (transfer == d->transfers.end() ||
+        (transfer->stage != Stage::SendingCount && transfer->stage != Stage::SendingItem &&
+         transfer->stage != Stage::WaitingAck) ||
+        seq < transfer->rangeStart || seq > transfer->rangeEnd) return;
 
-    if (d->mavSequencer[message.sysid].contains(msgItem.seq) &&
-        d->mavStages.value(message.sysid, Stage::Idle) == Stage::WaitingItem)
+    qint64 time = d->clock.elapsed();
+    if (transfer->stage == Stage::SendingCount)
     {
-        d->mavSequencer[message.sysid].removeOne(msgItem.seq);
-        assignment->addProgress();
-
-        if (d->mavSequencer[message.sysid].isEmpty())
-        {
-            assignment->setStatus(dto::MissionAssignment::Actual);
-
-            this->sendMissionAck(message.sysid);
-            this->enterStage(Stage::Idle, message.sysid);
-        }
-        else
-        {
-            this->enterStage(Stage::WaitingItem, message.sysid);
-            this->requestMissionItem(message.sysid, d->mavSequencer[message.sysid].first());
-        }
-
-        d->missionService->assignmentChanged(assignment);
+        transfer->addRoundTrip(transfer->countRequest, time);
     }
-}
-
-void MissionHandler::processMissionRequest(const mavlink_message_t& message)
-{
-    mavlink_mission_request_t request;
-    mavlink_msg_mission_request_decode(&message, &request);
-
-    if (d->mavStages.value(message.sysid, Stage::Idle) == Stage::SendingCount)
+    else if (seq != transfer->lastSent)
     {
-        this->enterStage(Stage::SendingItem, message.sysid);
+        transfer->addRoundTrip(transfer->itemRequest, time);
     }
+    transfer->retries = 0;
+    transfer->intItems = isInt; // Answer in kind
 
-    if (d->lastSendedSequence != -1 && d->lastSendedSequence != request.seq)
+    // Vehicle requests items in order, so the previous one is accepted
+    if (transfer->lastSent > -1 && transfer->lastSent < seq)
     {
-        d->mavSequencer[message.sysid].removeOne(d->lastSendedSequence);
-
-        int vehicleId = d->vehicleService->vehicleIdByMavId(message.sysid);
-        dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
-        if (assignment)
+        dto::MissionItemPtr item = d->missionService->missionItem(
+                                       transfer->assignment->missionId(), transfer->lastSent);
+        if (item)
         {
-            dto::MissionItemPtr item = d->missionService->missionItem(assignment->missionId(),
-                                                                      d->lastSendedSequence);
-            if (item)
-            {
-                item->setStatus(dto::MissionItem::Actual);
-                d->missionService->missionItemChanged(item);
-            }
+            item->setStatus(dto::MissionItem::Actual);
+            d->missionService->missionItemChanged(item);
         }
+
+        transfer->assignment->addProgress();
+        d->missionService->assignmentChanged(transfer->assignment);
     }
 
-    this->sendMissionItem(message.sysid, request.seq);
+    this->enterStage(seq < transfer->rangeEnd ? Stage::SendingItem : Stage::WaitingAck,
+                     message.sysid);
+    this->sendMissionItem(message.sysid, seq);
 }
 
 void MissionHandler::processMissionAck(const mavlink_message_t& message)
 {
-    int vehicleId = d->vehicleService->vehicleIdByMavId(message.sysid);
-    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
-    if (assignment.isNull()) return;
-
     mavlink_mission_ack_t ack;
     mavlink_msg_mission_ack_decode(&message, &ack);
 
@@ -584,25 +803,70 @@ void MissionHandler::processMissionAck(const mavlink_message_t& message)
     if (ack.mission_type != MAV_MISSION_TYPE_MISSION) return;
 #endif
 
+    auto transfer = d->transfers.find(message.sysid);
+    Stage stage = transfer != d->transfers.end() ? transfer->stage : Stage::Idle;
+
     if (ack.type == MAV_MISSION_ACCEPTED)
     {
-        if (d->mavStages.value(message.sysid, Stage::Idle) == Stage::WaitongAck)
+        if (stage != Stage::WaitingAck) return;
+
+        dto::MissionItemPtr item = d->missionService->missionItem(
+                                       transfer->assignment->missionId(), transfer->lastSent);
+        if (item)
         {
-            assignment->setStatus(dto::MissionAssignment::Actual);
+            item->setStatus(dto::MissionItem::Actual);
+            d->missionService->missionItemChanged(item);
         }
+
+        transfer->assignment->addProgress();
+
+        if (transfer->ranges.isEmpty()) this->finishSync(message.sysid, true);
+        else this->uploadNextRange(message.sysid);
+        return;
     }
-    else
+
+    // Vehicle can't write partially, so the whole mission goes
+    if (stage == Stage::SendingCount && transfer->partial)
     {
-        notificationBus->notify(tr("Mission"), tr("Error uploading waypoint %1").arg(
-                                 ::decodeCommandResult(ack.type)),
-                             dto::Notification::Warning);
-        assignment->setStatus(dto::MissionAssignment::NotActual);
+        transfer->partialWrites = false;
+        this->uploadAll(message.sysid);
+        return;
     }
 
+    // Vehicle serves download requests only in order, go on one by one
+    if (stage == Stage::WaitingItem && ack.type == MAV_MISSION_INVALID_SEQUENCE &&
+        transfer->window > 1)
+    {
+        if (!transfer->requests.isEmpty()) transfer->next = transfer->requests.firstKey();
+        transfer->requests.clear();
+        transfer->window = 1;
+
+        this->enterStage(Stage::WaitingItem, message.sysid);
+        this->requestMissionItems(message.sysid);
+        return;
+    }
+
+    notificationBus->notify(tr("Mission"), tr("Error uploading waypoint %1").arg(
+                             ::decodeCommandResult(ack.type)),
+                         dto::Notification::Warning);
+
+    if (stage != Stage::Idle)
+    {
+        this->finishSync(message.sysid, false);
+        return;
+    }
+
+    dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(
+                                               d->vehicleService->vehicleIdByMavId(
+                                                   message.sysid));
+    if (assignment.isNull()) return;
+
+    assignment->setStatus(dto::MissionAssignment::NotActual);
     d->missionService->assignmentChanged(assignment);
 }
 
 void MissionHandler::processMissionCurrent(const mavlink_message_t& message)
+
 {
     int vehicleId = d->vehicleService->vehicleIdByMavId(message.sysid);
     dto::MissionAssignmentPtr assignment = d->missionService->vehicleAssignment(vehicleId);
@@ -632,43 +896,167 @@ void MissionHandler::processMissionReached(const mavlink_message_t& message)
     }
 }
 
-void MissionHandler::enterStage(Stage stage, quint8 mavId)
+void MissionHandler::requestMissionItems(quint8 mavId)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    while (transfer.requests.count() < transfer.window && transfer.next < transfer.count)
+    {
+        this->requestMissionItem(mavId, transfer.next++);
+    }
+}
+
+void MissionHandler::uploadAll(quint8 mavId)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull()) return;
+
+    transfer.partial = false;
+    transfer.ranges.clear();
+    transfer.rangeStart = 0;
+    transfer.rangeEnd = transfer.count - 1;
+    transfer.lastSent = -1;
+    transfer.countRequest = MissionTransfer::Request();
+    transfer.retries = 0;
+
+    for (const dto::MissionItemPtr& item:
+         d->missionService->missionItems(transfer.assignment->missionId()))
+    {
+        item->setStatus(dto::MissionItem::NotActual);
+        d->missionService->missionItemChanged(item);
+    }
+
+    this->enterStage(Stage::SendingCount, mavId);
+    this->sendMissionCount(mavId);
+}
+
+void MissionHandler::uploadNextRange(quint8 mavId)
 {
-    if (d->mavTimers.contains(mavId))
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.assignment.isNull() || transfer.ranges.isEmpty()) return;
+
+    QPair<int, int> range = transfer.ranges.takeFirst();
+    transfer.partial = true;
+    transfer.rangeStart = range.first;
+    transfer.rangeEnd = range.second;
+    transfer.lastSent = -1;
+    transfer.countRequest = MissionTransfer::Request();
+    transfer.retries = 0;
+
+    this->enterStage(Stage::SendingCount, mavId);
+    this->sendMissionPartialList(mavId, range.first, range.second);
+}
+
+void MissionHandler::saveDownloaded(quint8 mavId)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.downloaded.isEmpty()) return;
+
+    d->missionService->save(transfer.downloaded);
+    transfer.downloaded.clear();
+}
+
+void MissionHandler::finishSync(quint8 mavId, bool actual)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    this->enterStage(Stage::Idle, mavId);
+    this->saveDownloaded(mavId);
+
+    dto::MissionAssignmentPtr assignment = transfer.assignment;
+    transfer.assignment.clear();
+    if (assignment.isNull()) return;
+
+    // Interrupted partial write leaves the count, unconfirmed items stay not actual
+    if (actual)
+    {
+        transfer.knownMissionId = assignment->missionId();
+        transfer.knownCount = transfer.count;
+    }
+    else if (!transfer.partial)
     {
-        this->killTimer(d->mavTimers.take(mavId));
+        transfer.knownCount = -1;
     }
 
-    d->mavStages[mavId] = stage;
-    if (stage != Stage::Idle &&
-        stage != Stage::SendingItem &&
-        stage != Stage::WaitongAck)
+    assignment->setStatus(actual ? dto::MissionAssignment::Actual :
+                                   dto::MissionAssignment::NotActual);
+    if (!actual) assignment->setProgress(0);
+    d->missionService->assignmentChanged(assignment);
+}
+
+void MissionHandler::enterStage(Stage stage, quint8 mavId)
+{
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (transfer.timer)
     {
-        d->mavTimers[mavId] = this->startTimer(::interval);
+        this->killTimer(transfer.timer);
+        d->timers.remove(transfer.timer);
+        transfer.timer = 0;
     }
+
+    // Every stage waits for the vehicle, timeout follows its round trip time
+    transfer.stage = stage;
+    if (stage == Stage::Idle) return;
+
+    transfer.timer = this->startTimer(transfer.timeout());
+    d->timers[transfer.timer] = mavId;
 }
 
 void MissionHandler::timerEvent(QTimerEvent* event)
 {
-    quint8 mavId = d->mavTimers.key(event->timerId(), 0);
-    if (!mavId) QObject::timerEvent(event);
+    quint8 mavId = d->timers.value(event->timerId(), 0);
+    if (!mavId)
+    {
+        QObject::timerEvent(event);
+        return;
+    }
 
-    switch (d->mavStages.value(mavId, Stage::Idle))
+    MissionTransfer& transfer = d->transfers[mavId];
+    if (++transfer.retries > ::maxRetries)
+    {
+        notificationBus->notify(tr("Mission"), tr("Vehicle doesn't respond"),
+                                dto::Notification::Warning);
+        this->finishSync(mavId, false);
+        return;
+    }
+
+    // Vehicle ignores partial writes
+    if (transfer.partial && transfer.stage == Stage::SendingCount &&
+        transfer.retries > ::partialRetries)
+    {
+        transfer.partialWrites = false;
+        this->uploadAll(mavId);
+        return;
+    }
+
+    switch (transfer.stage)
     {
     case Stage::WaitingCount:
         this->requestMissionCount(mavId);
         break;
     case Stage::WaitingItem:
-    {
-        const QList<int>& list = d->mavSequencer[mavId];
-        if (list.isEmpty()) this->enterStage(Stage::Idle, mavId);
-        else this->requestMissionItem(mavId, list.first());
+        // Vehicle without MISSION_ITEM_INT ignores its requests
+        if (!transfer.received) transfer.intItems = false;
+
+        // Outstanding requests are at least timeout old, lost ones are requested again
+        for (int seq: transfer.requests.keys()) this->requestMissionItem(mavId, seq);
         break;
-    }
     case Stage::SendingCount:
-        this->sendMissionCount(mavId);
+        if (transfer.partial)
+        {
+            this->sendMissionPartialList(mavId, transfer.rangeStart, transfer.rangeEnd);
+        }
+        else
+        {
+            this->sendMissionCount(mavId);
+        }
+        break;
+    case Stage::SendingItem:
+    case Stage::WaitingAck:
+        if (transfer.lastSent > -1) this->sendMissionItem(mavId, transfer.lastSent);
+        break;
     case Stage::Idle:
     default:
-        break;
+        return;
     }
+
+    this->enterStage(transfer.stage, mavId); // Restart with backed off timeout
 }
@@ -27,7 +27,7 @@ namespace comm
             Idle,
             WaitingCount,
             WaitingItem,
-            WaitongAck,
+            WaitingAck,
             SendingCount,
             SendingItem
         };
@@ -35,6 +35,8 @@ namespace comm
         explicit MissionHandler(MavLinkCommunicator* communicator);
         ~MissionHandler() override;
 
+        QList<quint32> messageIds() const override;
+
     public slots:
        void processMessage(const mavlink_message_t& message) override;
 
@@ -46,6 +48,7 @@ namespace comm
        void requestMissionItem(quint8 mavId, quint16 seq);
 
        void sendMissionCount(quint8 mavId);
+       void sendMissionPartialList(quint8 mavId, quint16 start, quint16 end);
        void sendMissionItem(quint8 mavId, quint16 seq);
        void sendMissionAck(quint8 mavId);
 
@@ -57,6 +60,12 @@ namespace comm
         void processMissionCurrent(const mavlink_message_t& message);
         void processMissionReached(const mavlink_message_t& message);
 
+        void requestMissionItems(quint8 mavId); // Fills vehicle's download window
+        void uploadAll(quint8 mavId);
+        void uploadNextRange(quint8 mavId);
+        void saveDownloaded(quint8 mavId);
+        void finishSync(quint8 mavId, bool actual);
+
         void enterStage(Stage stage, quint8 mavId);
         void timerEvent(QTimerEvent* event) override;
 
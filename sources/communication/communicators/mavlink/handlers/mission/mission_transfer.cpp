@@ -0,0 +1,90 @@
+#include "mission_transfer.h"
+
+// Internal
+#include "mission_item.h"
+
+using namespace comm;
+
+namespace
+{
+    const int interval = 2000; // Until round trip time is measured
+    const int minTimeout = 200;
+    const int maxTimeout = 8000;
+    const int window = 4; // Outstanding download requests per vehicle
+    const int rangeGap = 4; // Actual items rewritten rather than starting another partial write
+}
+
+MissionTransfer::MissionTransfer():
+    window(::window)
+{}
+
+void MissionTransfer::start(const dto::MissionAssignmentPtr& assignment)
+{
+    this->assignment = assignment;
+    retries = 0;
+    intItems = true;
+    count = 0;
+    countRequest = Request();
+    next = 0;
+    window = ::window;
+    received = false;
+    requests.clear();
+    downloaded.clear();
+    partial = false;
+    rangeStart = 0;
+    rangeEnd = -1;
+    ranges.clear();
+    lastSent = -1;
+    itemRequest = Request();
+}
+
+QList<QPair<int, int> > MissionTransfer::changedRanges(const dto::MissionItemPtrList& items)
+{
+    QList<QPair<int, int> > ranges;
+    for (const dto::MissionItemPtr& item: items)
+    {
+        if (item->status() == dto::MissionItem::Actual) continue;
+
+        if (!ranges.isEmpty() && item->sequence() - ranges.last().second <= ::rangeGap)
+        {
+            ranges.last().second = item->sequence();
+        }
+        else
+        {
+            ranges.append(qMakePair(item->sequence(), item->sequence()));
+        }
+    }
+    return ranges;
+}
+
+void MissionTransfer::stamp(Request& request, qint64 time)
+{
+    request.repeated = request.time > -1;
+    request.time = time;
+}
+
+void MissionTransfer::addRoundTrip(const Request& request, qint64 time)
+{
+    if (request.time < 0 || request.repeated) return;
+
+    // Smoothed like TCP retransmission timer does
+    double sample = time - request.time;
+    if (measured)
+    {
+        roundTripVariation = 0.75 * roundTripVariation + 0.25 * qAbs(roundTrip - sample);
+        roundTrip = 0.875 * roundTrip + 0.125 * sample;
+    }
+    else
+    {
+        roundTripVariation = sample / 2;
+        roundTrip = sample;
+        measured = true;
+    }
+}
+
+int MissionTransfer::timeout() const
+{
+    int timeout = measured ? qBound(::minTimeout, qRound(roundTrip + 4 * roundTripVariation),
+                                    ::maxTimeout) : ::interval;
+    return qMin(timeout << qMin(retries, 4), ::maxTimeout); // Backoff on retries
+}
@@ -0,0 +1,72 @@
+#ifndef MISSION_TRANSFER_H
+#define MISSION_TRANSFER_H
+
+// Qt
+#include <QMap>
+#include <QPair>
+
+// Internal
+#include "mission_handler.h"
+
+namespace comm
+{
+    // Sync state of one vehicle, vehicles are served independently
+    class MissionTransfer
+    {
+    public:
+        class Request
+        {
+        public:
+            qint64 time = -1; // Of the last sending
+            bool repeated = false; // Repeated requests give no round trip samples
+        };
+
+        MissionTransfer();
+
+        MissionHandler::Stage stage = MissionHandler::Stage::Idle;
+        dto::MissionAssignmentPtr assignment;
+        int timer = 0;
+        int retries = 0;
+        bool intItems = true; // MISSION_ITEM_INT is in use
+
+        int count = 0;
+        Request countRequest; // MISSION_REQUEST_LIST or MISSION_COUNT
+
+        // Download
+        int next = 0; // First sequence not requested yet
+        int window;
+        bool received = false;
+        QMap<int, Request> requests; // Outstanding by sequence
+        dto::MissionItemPtrList downloaded; // Not saved yet
+
+        // Upload
+        bool partial = false; // MISSION_WRITE_PARTIAL_LIST is in use
+        int rangeStart = 0;
+        int rangeEnd = -1;
+        QList<QPair<int, int> > ranges; // Left to write, first and last sequences
+        int lastSent = -1;
+        Request itemRequest;
+
+        // Vehicle's mission as of the last successful sync, survives transfers
+        int knownMissionId = 0;
+        int knownCount = -1;
+        bool partialWrites = true; // Until the vehicle rejects them
+
+        // Round trip time, survives transfers
+        bool measured = false;
+        double roundTrip = 0;
+        double roundTripVariation = 0;
+
+        void start(const dto::MissionAssignmentPtr& assignment);
+
+        // Not actual items, close ranges are merged
+        static QList<QPair<int, int> > changedRanges(const dto::MissionItemPtrList& items);
+
+        static void stamp(Request& request, qint64 time);
+        void addRoundTrip(const Request& request, qint64 time);
+
+        int timeout() const; // ms, backed off on retries
+    };
+}
+
+#endif // MISSION_TRANSFER_H
@@ -7,30 +7,189 @@
 
 // Qt
 #include <QMap>
+#include <QVector>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QThread>
+#include <QElapsedTimer>
 #include <QDebug>
 
+// Std
+#include <cstring>
+
 // Internal
 #include "abstract_link.h"
 #include "abstract_mavlink_handler.h"
+#include "mavlink_frame_parser.h"
+#include "mavlink_router.h"
+#include "tlog_recorder.h"
 
 using namespace comm;
 
+namespace
+{
+#ifdef MAVLINK_V2
+    const quint32 dispatchTableLimit = 65536;
+#else
+    const quint32 dispatchTableLimit = 256;
+#if MAVLINK_CRC_EXTRA
+    const quint8 messageCrcs[256] = MAVLINK_MESSAGE_CRCS;
+#endif
+#endif
+
+    // Handlers encode on one shared channel, sequence and protocol are set per link on send
+    const quint8 encodingChannel = MAVLINK_COMM_0;
+
+    // Commands overtake mission transfer, both overtake the rest of own and relayed traffic
+    AbstractLink::Priority sendPriority(quint32 messageId)
+    {
+        switch (messageId)
+        {
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_SET_MODE:
+        case MAVLINK_MSG_ID_PARAM_SET:
+        case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+            return AbstractLink::Urgent;
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        case MAVLINK_MSG_ID_MISSION_ITEM:
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        case MAVLINK_MSG_ID_MISSION_ACK:
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+        case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+            return AbstractLink::High;
+        default:
+            return AbstractLink::Normal;
+        }
+    }
+}
+
 class MavLinkCommunicator::Impl
 {
 public:
+    // Message parsed on a link thread with the place of its original bytes in the frames
+    class Received
+    {
+    public:
+        mavlink_message_t message;
+        int frameEnd; // Of the frame in the batch frames
+        quint64 timestamp; // Of the read it came with
+    };
+
+    // Per link MAVLink context, allocated with the link instead of a global channel.
+    // Links on their own threads parse there and pass decoded messages through pending
+    // batch, handlers always run in the communicator thread.
+    class Inbox
+    {
+    public:
+        Inbox() { std::memset(&sendState, 0, sizeof(sendState)); }
+
+        // Link thread
+        MavLinkFrameParser parser;
+        QVector<Received> parsed;
+        QByteArray parsedFrames;
+        Protocol protocol = Unknown;
+        int packetsReceived = 0;
+        int packetsDrops = 0;
+
+        // Communicator thread
+        mavlink_status_t sendState; // Outgoing sequence and protocol flags
+
+        // Shared
+        QMutex mutex;
+        QVector<Received> pending;
+        QByteArray frames; // Original bytes of pending messages, forwarded as they came
+        QAtomicInt scheduled;
+        QAtomicInt closed;
+        QAtomicInt mavLink2Received; // Switch is applied on next send
+    };
+    using InboxPtr = QSharedPointer<Inbox>;
+
+    QReadWriteLock inboxesLock; // Written in communicator thread only
+    QHash<AbstractLink*, InboxPtr> inboxes;
+    QVector<Received> draining;
+    QByteArray drainingFrames;
+
     quint8 systemId;
     quint8 componentId;
     bool retranslationEnabled;
 
-    QMap<AbstractLink*, quint8> linkChannels;
     QMap<quint8, AbstractLink*> mavSystemLinks;
-    QList<quint8> avalibleChannels;
     AbstractLink* receivedLink = nullptr;
+    TlogRecorder* recorder = nullptr;
+    MavLinkRouter router;
 
     QList<AbstractMavLinkHandler*> handlers;
+    QVector<QVector<AbstractMavLinkHandler*> > dispatchTable; // msgid -> subscribers
+
+    quint64 dispatchedMessages = 0;
+    quint64 unhandledMessages = 0;
+    quint64 duplicateMessages = 0;
+
+    bool profiling = false;
+    QHash<AbstractMavLinkHandler*, qint64> handlerTimes;
 
-    int oldPacketsReceived = 0;
-    int oldPacketsDrops = 0;
+    // Original frame bytes, rebuilt when the frame has started in a previous buffer
+    const quint8* rawFrame(const mavlink_message_t& message, const quint8* data, int pos,
+                           quint8* buffer, int& length) const
+    {
+#ifdef MAVLINK_V2
+        if (message.magic == MAVLINK_STX_MAVLINK1) length = 8 + message.len;
+        else length = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len +
+                ((message.incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+#else
+        length = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+#endif
+        if (data && pos >= length && data[pos - length] == message.magic)
+        {
+            return data + pos - length;
+        }
+
+        length = mavlink_msg_to_send_buffer(buffer, &message);
+        return buffer;
+    }
+
+    // Encoded on the shared channel, finalized again with own sequence of the link
+    bool finalize(mavlink_message_t& message, Inbox* inbox)
+    {
+        mavlink_status_t& state = inbox->sendState;
+#ifdef MAVLINK_V2
+        if (inbox->mavLink2Received.testAndSetAcquire(1, 0))
+        {
+            state.flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+        if (!entry) return false;
+
+        mavlink_finalize_message_buffer(&message, message.sysid, message.compid, &state,
+                                        entry->min_msg_len, entry->max_msg_len,
+                                        entry->crc_extra);
+#else
+        // No buffer variant in MAVLink 1, sequence is lent to the encoding channel
+        mavlink_status_t* channelStatus = mavlink_get_channel_status(::encodingChannel);
+        channelStatus->current_tx_seq = state.current_tx_seq;
+#if MAVLINK_CRC_EXTRA
+        mavlink_finalize_message_chan(&message, message.sysid, message.compid,
+                                      ::encodingChannel, message.len,
+                                      ::messageCrcs[message.msgid]);
+#else
+        mavlink_finalize_message_chan(&message, message.sysid, message.compid,
+                                      ::encodingChannel, message.len);
+#endif
+        state.current_tx_seq = channelStatus->current_tx_seq;
+#endif
+        return true;
+    }
 };
 
 MavLinkCommunicator::MavLinkCommunicator(quint8 systemId, quint8 componentId,
@@ -43,11 +202,6 @@ MavLinkCommunicator::MavLinkCommunicator(quint8 systemId, quint8 componentId,
     d->systemId = systemId;
     d->componentId = componentId;
     d->retranslationEnabled = retranslationEnabled;
-
-    for (quint8 channel = 0; channel < MAVLINK_COMM_NUM_BUFFERS; ++channel)
-    {
-        d->avalibleChannels.append(channel);
-    }
 }
 
 MavLinkCommunicator::~MavLinkCommunicator()
@@ -60,7 +214,7 @@ MavLinkCommunicator::~MavLinkCommunicator()
 
 bool MavLinkCommunicator::isAddLinkEnabled()
 {
-    return !d->avalibleChannels.isEmpty();
+    return true; // Contexts are allocated per link, no channels limit
 }
 
 quint8 MavLinkCommunicator::systemId() const
@@ -80,7 +234,8 @@ bool MavLinkCommunicator::retranslationEnabled() const
 
 quint8 MavLinkCommunicator::linkChannel(AbstractLink* link) const
 {
-    return d->linkChannels.value(link, 0);
+    Q_UNUSED(link)
+    return ::encodingChannel;
 }
 
 AbstractLink* MavLinkCommunicator::lastReceivedLink() const
@@ -93,30 +248,43 @@ AbstractLink* MavLinkCommunicator::mavSystemLink(quint8 systemId)
     return d->mavSystemLinks.value(systemId, nullptr);
 }
 
+TlogRecorder* MavLinkCommunicator::recorder() const
+{
+    return d->recorder;
+}
+
+void MavLinkCommunicator::setRecorder(TlogRecorder* recorder)
+{
+    d->recorder = recorder;
+}
+
 void MavLinkCommunicator::addLink(AbstractLink* link)
 {
-    if (d->linkChannels.contains(link) || d->avalibleChannels.isEmpty()) return;
+    if (d->inboxes.contains(link)) return;
 
-    d->linkChannels[link] = d->avalibleChannels.takeFirst();
-    if (d->avalibleChannels.isEmpty()) emit addLinkEnabledChanged(false);
+    {
+        QWriteLocker locker(&d->inboxesLock);
+        d->inboxes[link] = Impl::InboxPtr::create();
+    }
 
     AbstractCommunicator::addLink(link);
 }
 
 void MavLinkCommunicator::removeLink(AbstractLink* link)
 {
-    if (!d->linkChannels.contains(link)) return;
+    if (!d->inboxes.contains(link)) return;
 
-    quint8 channel = d->linkChannels.value(link);
-    d->linkChannels.remove(link);
-    d->avalibleChannels.prepend(channel);
+    {
+        QWriteLocker locker(&d->inboxesLock);
+        Impl::InboxPtr inbox = d->inboxes.take(link);
+        if (inbox) inbox->closed.storeRelease(1);
+    }
 
     quint8 mavId = d->mavSystemLinks.key(link, 0);
     if (mavId) d->mavSystemLinks.remove(mavId);
 
     if (link == d->receivedLink) d->receivedLink = nullptr;
-
-    if (!d->avalibleChannels.isEmpty()) emit addLinkEnabledChanged(true);
+    d->router.removeLink(link);
 
     AbstractCommunicator::removeLink(link);
 }
@@ -124,19 +292,27 @@ void MavLinkCommunicator::removeLink(AbstractLink* link)
 void MavLinkCommunicator::switchLinkProtocol(AbstractLink* link, AbstractCommunicator::Protocol protocol)
 {
 #ifdef MAVLINK_V2
-    mavlink_status_t* channelStatus = mavlink_get_channel_status(this->linkChannel(link));
-    bool outMavlink1 = channelStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    Impl::InboxPtr inbox = d->inboxes.value(link);
+    if (!inbox) return;
+
+    // Explicit choice overrides switch pending from received MAVLink 2
+    mavlink_status_t& state = inbox->sendState;
+    if (inbox->mavLink2Received.fetchAndStoreAcquire(0))
+    {
+        state.flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+    bool outMavlink1 = state.flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
 
     if (protocol == AbstractCommunicator::MavLink1 && !outMavlink1)
     {
-        channelStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        state.flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
     }
     else if (protocol == AbstractCommunicator::MavLink2 && outMavlink1)
     {
-        channelStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        state.flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
     }
 
-    emit mavLinkProtocolChanged(link, channelStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1 ?
+    emit mavLinkProtocolChanged(link, state.flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1 ?
                                     MavLink1 : MavLink2);
 #else
     emit mavLinkProtocolChanged(link, MavLink1);
@@ -164,74 +340,269 @@ void MavLinkCommunicator::setRetranslationEnabled(bool retranslationEnabled)
     if (d->retranslationEnabled == retranslationEnabled) return;
 
     d->retranslationEnabled = retranslationEnabled;
+    d->router.clear();
     emit retranslationEnabledChanged(retranslationEnabled);
 }
 
+int MavLinkCommunicator::handlersCount() const
+{
+    return d->handlers.count();
+}
+
+QList<quint32> MavLinkCommunicator::subscribedMessageIds() const
+{
+    QList<quint32> messageIds;
+
+    for (int messageId = 0; messageId < d->dispatchTable.count(); ++messageId)
+    {
+        if (!d->dispatchTable.at(messageId).isEmpty()) messageIds.append(messageId);
+    }
+
+    return messageIds;
+}
+
+int MavLinkCommunicator::subscribersCount(quint32 messageId) const
+{
+    if (messageId >= quint32(d->dispatchTable.count())) return 0;
+
+    return d->dispatchTable.at(messageId).count();
+}
+
+quint64 MavLinkCommunicator::dispatchedMessages() const
+{
+    return d->dispatchedMessages;
+}
+
+quint64 MavLinkCommunicator::unhandledMessages() const
+{
+    return d->unhandledMessages;
+}
+
+quint64 MavLinkCommunicator::duplicateMessages() const
+{
+    return d->duplicateMessages;
+}
+
+bool MavLinkCommunicator::isProfilingEnabled() const
+{
+    return d->profiling;
+}
+
+void MavLinkCommunicator::setProfilingEnabled(bool enabled)
+{
+    d->profiling = enabled;
+    d->handlerTimes.clear();
+}
+
+QHash<AbstractMavLinkHandler*, qint64> MavLinkCommunicator::handlerTimes() const
+{
+    return d->handlerTimes;
+}
+
 void MavLinkCommunicator::addHandler(AbstractMavLinkHandler* handler)
 {
+    if (d->handlers.contains(handler)) return;
+
     d->handlers.append(handler);
+
+    for (quint32 messageId: handler->messageIds())
+    {
+        if (messageId >= ::dispatchTableLimit)
+        {
+            qWarning() << "Can't dispatch MAVLink message id" << messageId;
+            continue;
+        }
+
+        if (messageId >= quint32(d->dispatchTable.count())) d->dispatchTable.resize(messageId + 1);
+
+        QVector<AbstractMavLinkHandler*>& subscribers = d->dispatchTable[messageId];
+        if (!subscribers.contains(handler)) subscribers.append(handler);
+    }
 }
 
 void MavLinkCommunicator::sendMessage(mavlink_message_t& message, AbstractLink* link)
 {
     if (!link || !link->isConnected()) return;
 
+    Impl::InboxPtr inbox = d->inboxes.value(link);
+    if (!inbox) return;
+
     this->finalizeMessage(message);
+    if (!d->finalize(message, inbox.data())) return;
 
     quint8 buffer[MAVLINK_MAX_PACKET_LEN];
     int lenght = mavlink_msg_to_send_buffer(buffer, &message);
 
     if (!lenght) return;
-    link->sendData(QByteArray((const char*)buffer, lenght));
+    link->sendData(reinterpret_cast<const char*>(buffer), lenght, ::sendPriority(message.msgid));
 }
 
-void MavLinkCommunicator::onDataReceived(const QByteArray& data)
+void MavLinkCommunicator::receiveData(AbstractLink* link, const quint8* data, int length)
 {
-    d->receivedLink = qobject_cast<AbstractLink*>(this->sender());
-    if (!d->receivedLink) return;
+    Impl::InboxPtr inbox;
+    {
+        QReadLocker locker(&d->inboxesLock);
+        inbox = d->inboxes.value(link);
+    }
+    if (!inbox || length <= 0) return;
+
+    // Links of the communicator thread skip the inbox and keep frames in place for forwarding
+    const bool direct = QThread::currentThread() == this->thread();
+    const quint64 timestamp = d->recorder ? TlogRecorder::currentTimestamp() : 0;
 
     mavlink_message_t message;
     mavlink_status_t status;
 
-    quint8 channel = this->linkChannel(d->receivedLink);
-    for (int pos = 0; pos < data.length(); ++pos)
+    int pos = 0;
+    while (inbox->parser.parse(data, length, pos, &message, &status))
     {
-        if (!mavlink_parse_char(channel, (quint8)data[pos], &message, &status)) continue;
-
 #ifdef MAVLINK_V2
-       // if we got MavLink v2, switch to on it!
-       mavlink_status_t* channelStatus = mavlink_get_channel_status(channel);
-       if (!(channelStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1))
-       {
-           this->switchLinkProtocol(d->receivedLink, MavLink2);
-       }
+        // If we got MavLink v2, switch to on it!
+        if (!(inbox->parser.state()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) &&
+            inbox->protocol != MavLink2)
+        {
+            inbox->protocol = MavLink2;
+            inbox->mavLink2Received.storeRelease(1);
+            emit mavLinkProtocolChanged(link, MavLink2);
+        }
 #endif
 
-        d->mavSystemLinks[message.sysid] = d->receivedLink;
+        if (direct)
+        {
+            this->processMessage(link, message, timestamp, data, pos);
+            continue;
+        }
+
+        // Bytes are copied while the read buffer is alive
+        quint8 frame[MAVLINK_MAX_PACKET_LEN];
+        int frameLength = 0;
+        const quint8* raw = d->rawFrame(message, data, pos, frame, frameLength);
+        inbox->parsedFrames.append(reinterpret_cast<const char*>(raw), frameLength);
+        inbox->parsed.append({ message, inbox->parsedFrames.size(), timestamp });
+    }
+
+    if (inbox->packetsReceived != status.packet_rx_success_count ||
+        inbox->packetsDrops != status.packet_rx_drop_count)
+    {
+        emit mavLinkStatisticsChanged(link, status.packet_rx_success_count,
+                                      status.packet_rx_drop_count);
+
+        inbox->packetsReceived = status.packet_rx_success_count;
+        inbox->packetsDrops = status.packet_rx_drop_count;
+    }
+
+    if (inbox->parsed.isEmpty()) return;
+
+    {
+        QMutexLocker locker(&inbox->mutex);
+
+        const int base = inbox->frames.size();
+        for (Impl::Received& received: inbox->parsed) received.frameEnd += base;
+        inbox->pending += inbox->parsed;
+        inbox->frames += inbox->parsedFrames;
+    }
+    inbox->parsed.resize(0);
+    inbox->parsedFrames.resize(0);
+
+    // One wake up for everything parsed until communicator thread gets to it
+    if (inbox->scheduled.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "processInboxes", Qt::QueuedConnection);
+    }
+}
+
+void MavLinkCommunicator::processInboxes()
+{
+    // Snapshot is not affected by links removal from handlers
+    const QHash<AbstractLink*, Impl::InboxPtr> inboxes = d->inboxes;
+
+    for (auto it = inboxes.constBegin(); it != inboxes.constEnd(); ++it)
+    {
+        Impl::Inbox* inbox = it.value().data();
+        if (!inbox->scheduled.loadAcquire()) continue;
+
+        inbox->scheduled.storeRelease(0);
 
-        for (AbstractMavLinkHandler* handler: d->handlers)
         {
-            handler->processMessage(message);
+            QMutexLocker locker(&inbox->mutex);
+            d->draining.swap(inbox->pending);
+            d->drainingFrames.swap(inbox->frames);
         }
 
-        if (d->retranslationEnabled)
+        // Per link order is kept, so is order of each vehicle
+        const quint8* frames = reinterpret_cast<const quint8*>(d->drainingFrames.constData());
+        for (const Impl::Received& received: d->draining)
+        {
+            if (inbox->closed.loadAcquire()) break;
+
+            this->processMessage(it.key(), received.message, received.timestamp,
+                                 frames, received.frameEnd);
+        }
+        d->draining.resize(0);
+        d->drainingFrames.resize(0);
+    }
+}
+
+void MavLinkCommunicator::processMessage(AbstractLink* link, const mavlink_message_t& message,
+                                         quint64 timestamp, const quint8* data, int pos)
+{
+    d->receivedLink = link;
+    d->mavSystemLinks[message.sysid] = link;
+
+    // Router drops the same frame relayed by redundant radios
+    if (d->retranslationEnabled && !d->router.learn(message, link))
+    {
+        d->duplicateMessages++;
+        return;
+    }
+
+    quint8 frame[MAVLINK_MAX_PACKET_LEN];
+    const quint8* raw = nullptr;
+    int rawLength = 0;
+    if (d->recorder)
+    {
+        raw = d->rawFrame(message, data, pos, frame, rawLength);
+        d->recorder->record(raw, rawLength, timestamp);
+    }
+
+    if (message.msgid < quint32(d->dispatchTable.count()) &&
+        !d->dispatchTable.at(message.msgid).isEmpty())
+    {
+        // Copy is cheap (implicit sharing) and survives handlers registration in process
+        const QVector<AbstractMavLinkHandler*> subscribers = d->dispatchTable.at(message.msgid);
+        for (AbstractMavLinkHandler* handler: subscribers)
         {
-            for (AbstractLink* link: this->links())
+            if (!d->profiling)
             {
-                if (link != d->receivedLink) this->sendMessage(message, link);
+                handler->processMessage(message);
+                continue;
             }
+
+            QElapsedTimer timer;
+            timer.start();
+            handler->processMessage(message);
+            d->handlerTimes[handler] += timer.nsecsElapsed();
         }
+        d->dispatchedMessages++;
     }
-
-    if (d->oldPacketsReceived != status.packet_rx_success_count ||
-        d->oldPacketsDrops != status.packet_rx_drop_count)
+    else
     {
-        emit mavLinkStatisticsChanged(d->receivedLink,
-                                      status.packet_rx_success_count,
-                                      status.packet_rx_drop_count);
+        d->unhandledMessages++;
+    }
+
+    if (!d->retranslationEnabled) return;
 
-        d->oldPacketsReceived = status.packet_rx_success_count;
-        d->oldPacketsDrops = status.packet_rx_drop_count;
+    MavLinkRouter::Links targets = d->router.route(message, link, this->links());
+    if (targets.isEmpty()) return;
+
+    // Original bytes are forwarded as is, behind own traffic of the target link
+    if (!raw) raw = d->rawFrame(message, data, pos, frame, rawLength);
+    for (AbstractLink* target: targets)
+    {
+        if (target->isConnected())
+        {
+            target->sendData(reinterpret_cast<const char*>(raw), rawLength, AbstractLink::Low);
+        }
     }
 }
 
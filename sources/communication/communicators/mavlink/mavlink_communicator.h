@@ -3,12 +3,16 @@
 
 #include "abstract_communicator.h"
 
+// Qt
+#include <QHash>
+
 // MAVLink
 #include <mavlink_types.h>
 
 namespace comm
 {
     class AbstractMavLinkHandler;
+    class TlogRecorder;
 
     class MavLinkCommunicator: public AbstractCommunicator
     {
@@ -25,11 +29,31 @@ namespace comm
         quint8 componentId() const;
         bool retranslationEnabled() const;
 
+        // Channel to encode messages for the link with. It is shared, sequence and protocol
+        // of the link are applied in sendMessage.
         quint8 linkChannel(AbstractLink* link) const;
 
         AbstractLink* lastReceivedLink() const;
         AbstractLink* mavSystemLink(quint8 systemId);
 
+        TlogRecorder* recorder() const;
+        void setRecorder(TlogRecorder* recorder); // Not owned, set before moving to thread
+
+        // Dispatch statistics for profiling
+        int handlersCount() const;
+        QList<quint32> subscribedMessageIds() const;
+        int subscribersCount(quint32 messageId) const;
+        quint64 dispatchedMessages() const;
+        quint64 unhandledMessages() const;
+        quint64 duplicateMessages() const; // Dropped by router
+
+        bool isProfilingEnabled() const;
+        void setProfilingEnabled(bool enabled); // Measure time spent in each handler
+        QHash<AbstractMavLinkHandler*, qint64> handlerTimes() const; // Nanoseconds
+
+        // Parses in the calling link thread, handlers run in the communicator thread
+        void receiveData(AbstractLink* link, const quint8* data, int length) override;
+
     public slots:
         void addLink(AbstractLink* link) override;
         void removeLink(AbstractLink* link) override;
@@ -49,13 +73,17 @@ namespace comm
         void componentIdChanged(quint8 componentId);
         void retranslationEnabledChanged(bool retranslationEnabled);
 
-    protected slots:
-        void onDataReceived(const QByteArray& data) override;
-
     protected:
         virtual void finalizeMessage(mavlink_message_t& message);
 
+    private slots:
+        void processInboxes();
+
     private:
+        // Data and pos locate the end of the frame in the received buffer or inbox frames
+        void processMessage(AbstractLink* link, const mavlink_message_t& message,
+                            quint64 timestamp, const quint8* data, int pos);
+
         class Impl;
         QScopedPointer<Impl> const d;
     };
@@ -0,0 +1,277 @@
+#include "mavlink_frame_parser.h"
+
+// MAVLink
+#include <mavlink.h>
+#include <mavlink_helpers.h>
+
+// Std
+#include <cstring>
+
+using namespace comm;
+
+namespace
+{
+    const int v1HeaderLength = 6;  // STX, len, seq, sysid, compid, msgid
+    const int v2HeaderLength = 10; // STX, len, incompat, compat, seq, sysid, compid, msgid[3]
+    const int checksumLength = 2;
+
+#ifndef MAVLINK_V2
+#if MAVLINK_CRC_EXTRA
+    const quint8 messageCrcs[256] = MAVLINK_MESSAGE_CRCS;
+#endif
+#endif
+
+    // Slicing-by-8 tables for the reflected 0x8408 polynomial, eight bytes per iteration
+    class CrcTables
+    {
+    public:
+        quint16 table[8][256];
+
+        CrcTables()
+        {
+            for (int byte = 0; byte < 256; ++byte)
+            {
+                quint16 crc = byte;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+                }
+                table[0][byte] = crc;
+            }
+
+            for (int slice = 1; slice < 8; ++slice)
+            {
+                for (int byte = 0; byte < 256; ++byte)
+                {
+                    quint16 crc = table[slice - 1][byte];
+                    table[slice][byte] = (crc >> 8) ^ table[0][crc & 0xFF];
+                }
+            }
+        }
+    };
+
+    const CrcTables crcTables;
+
+    inline bool isIdle(const mavlink_status_t* status)
+    {
+        return status->parse_state == MAVLINK_PARSE_STATE_UNINIT ||
+                status->parse_state == MAVLINK_PARSE_STATE_IDLE;
+    }
+
+    inline bool isStx(quint8 byte)
+    {
+#ifdef MAVLINK_V2
+        return byte == MAVLINK_STX || byte == MAVLINK_STX_MAVLINK1;
+#else
+        return byte == MAVLINK_STX;
+#endif
+    }
+
+    // Same status reporting, as mavlink_frame_char_buffer does at the end of each byte
+    void reportStatus(mavlink_status_t* state, mavlink_status_t* status)
+    {
+        status->parse_state = state->parse_state;
+        status->packet_idx = state->packet_idx;
+        status->current_rx_seq = state->current_rx_seq + 1;
+        status->packet_rx_success_count = state->packet_rx_success_count;
+        status->packet_rx_drop_count = state->parse_error;
+#ifdef MAVLINK_V2
+        status->flags = state->flags;
+#endif
+        state->parse_error = 0;
+    }
+}
+
+MavLinkFrameParser::MavLinkFrameParser()
+{
+    this->reset();
+}
+
+const mavlink_status_t* MavLinkFrameParser::state() const
+{
+    return &m_state;
+}
+
+void MavLinkFrameParser::reset()
+{
+    // Same as zero initialised static channel buffers of MAVLink
+    std::memset(&m_state, 0, sizeof(m_state));
+    std::memset(&m_buffer, 0, sizeof(m_buffer));
+}
+
+bool MavLinkFrameParser::parse(const quint8* data, int length, int& pos,
+                               mavlink_message_t* message, mavlink_status_t* status)
+{
+    while (pos < length)
+    {
+        // Frame started in previous buffer or rejected by fast path, finish it byte by byte
+        if (!::isIdle(&m_state))
+        {
+            if (this->parseChar(data[pos++], message, status)) return true;
+            continue;
+        }
+
+        int start = pos;
+        while (pos < length && !::isStx(data[pos])) ++pos;
+        if (pos > start) ::reportStatus(&m_state, status);
+        if (pos == length) break;
+
+        int frameLength = this->parseFrame(data + pos, length - pos, message);
+        if (frameLength)
+        {
+            pos += frameLength;
+
+            m_state.parse_state = MAVLINK_PARSE_STATE_IDLE;
+            m_state.current_rx_seq = message->seq;
+            if (m_state.packet_rx_success_count == 0) m_state.packet_rx_drop_count = 0;
+            m_state.packet_rx_success_count++;
+
+            ::reportStatus(&m_state, status);
+            return true;
+        }
+
+        // Incomplete, signed or broken frame goes to the original state machine
+        if (this->parseChar(data[pos++], message, status)) return true;
+    }
+
+    return false;
+}
+
+quint16 MavLinkFrameParser::crc(const quint8* data, int length, quint16 crc)
+{
+    const quint16 (*table)[256] = crcTables.table;
+
+    while (length >= 8)
+    {
+        crc = table[7][(data[0] ^ crc) & 0xFF] ^ table[6][(data[1] ^ (crc >> 8)) & 0xFF] ^
+              table[5][data[2]] ^ table[4][data[3]] ^ table[3][data[4]] ^
+              table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return crc;
+}
+
+bool MavLinkFrameParser::parseChar(quint8 byte, mavlink_message_t* message,
+                                   mavlink_status_t* status)
+{
+    // mavlink_parse_char on own context instead of mavlink_get_channel_buffer/status
+    quint8 result = mavlink_frame_char_buffer(&m_buffer, &m_state, byte, message, status);
+#ifdef MAVLINK_V2
+    if (result != MAVLINK_FRAMING_BAD_CRC && result != MAVLINK_FRAMING_BAD_SIGNATURE)
+#else
+    if (result != MAVLINK_FRAMING_BAD_CRC)
+#endif
+    {
+        return result == MAVLINK_FRAMING_OK;
+    }
+
+    _mav_parse_error(&m_state);
+    m_state.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+    m_state.parse_state = MAVLINK_PARSE_STATE_IDLE;
+    if (byte == MAVLINK_STX)
+    {
+        m_state.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+        m_buffer.len = 0;
+        mavlink_start_checksum(&m_buffer);
+    }
+    return false;
+}
+
+int MavLinkFrameParser::parseFrame(const quint8* frame, int available, mavlink_message_t* message)
+{
+    int headerLength = ::v1HeaderLength;
+    quint32 msgId = 0;
+    quint8 crcExtra = 0;
+
+#ifdef MAVLINK_V2
+    if (frame[0] == MAVLINK_STX)
+    {
+        // Incompatible flags and signing are left to the MAVLink library
+        if (available < ::v2HeaderLength || frame[2] != 0 || m_state.signing) return 0;
+
+        headerLength = ::v2HeaderLength;
+        msgId = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+    }
+    else
+    {
+        if (available < ::v1HeaderLength) return 0;
+
+        msgId = frame[5];
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgId);
+    if (!entry) return 0;
+    crcExtra = entry->crc_extra;
+#else
+    if (available < ::v1HeaderLength) return 0;
+
+    msgId = frame[5];
+#if MAVLINK_CRC_EXTRA
+    crcExtra = ::messageCrcs[msgId];
+#endif
+#endif
+
+    quint8 payloadLength = frame[1];
+    int frameLength = headerLength + payloadLength + ::checksumLength;
+    if (available < frameLength) return 0;
+
+    quint16 checksum = MavLinkFrameParser::crc(frame + 1, headerLength - 1 + payloadLength);
+#if defined(MAVLINK_V2) || MAVLINK_CRC_EXTRA
+    checksum = MavLinkFrameParser::crc(&crcExtra, 1, checksum);
+#else
+    Q_UNUSED(crcExtra)
+#endif
+
+    const quint8* ck = frame + headerLength + payloadLength;
+    if (ck[0] != (checksum & 0xFF) || ck[1] != (checksum >> 8)) return 0;
+
+    message->checksum = checksum;
+    message->magic = frame[0];
+    message->len = payloadLength;
+#ifdef MAVLINK_V2
+    if (headerLength == ::v2HeaderLength)
+    {
+        message->incompat_flags = frame[2];
+        message->compat_flags = frame[3];
+        message->seq = frame[4];
+        message->sysid = frame[5];
+        message->compid = frame[6];
+        m_state.flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    else
+    {
+        message->incompat_flags = 0;
+        message->compat_flags = 0;
+        message->seq = frame[2];
+        message->sysid = frame[3];
+        message->compid = frame[4];
+        m_state.flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    message->ck[0] = ck[0];
+    message->ck[1] = ck[1];
+#else
+    message->seq = frame[2];
+    message->sysid = frame[3];
+    message->compid = frame[4];
+#endif
+    message->msgid = msgId;
+
+    std::memcpy(_MAV_PAYLOAD_NON_CONST(message), frame + headerLength, payloadLength);
+#ifdef MAVLINK_V2
+    // Trailing zeros truncated by the sender are restored, like the library parser does
+    if (payloadLength < entry->max_msg_len)
+    {
+        std::memset(_MAV_PAYLOAD_NON_CONST(message) + payloadLength, 0,
+                    entry->max_msg_len - payloadLength);
+    }
+#endif
+
+    return frameLength;
+}
@@ -0,0 +1,40 @@
+#ifndef MAVLINK_FRAME_PARSER_H
+#define MAVLINK_FRAME_PARSER_H
+
+// Qt
+#include <QtGlobal>
+
+// MAVLink
+#include <mavlink_types.h>
+
+namespace comm
+{
+    // Buffer-oriented MAVLink parser: whole contiguous frames are validated at once,
+    // frames split between buffers, signed or broken go to the MAVLink state machine.
+    // Parser owns its context instead of the global channel, so any number can run at once.
+    class MavLinkFrameParser
+    {
+    public:
+        MavLinkFrameParser();
+
+        const mavlink_status_t* state() const; // Flags and counters as of MAVLink channel
+        void reset();
+
+        // Parses data from pos, returns true when message is complete and pos points after it.
+        // Status is filled as mavlink_parse_char do for the last consumed byte.
+        bool parse(const quint8* data, int length, int& pos,
+                   mavlink_message_t* message, mavlink_status_t* status);
+
+        // X.25 (CRC-16/MCRF4XX) checksum, same as MAVLink crc_accumulate
+        static quint16 crc(const quint8* data, int length, quint16 crc = 0xFFFF);
+
+    private:
+        bool parseChar(quint8 byte, mavlink_message_t* message, mavlink_status_t* status);
+        int parseFrame(const quint8* frame, int available, mavlink_message_t* message);
+
+        mavlink_status_t m_state;
+        mavlink_message_t m_buffer;
+    };
+}
+
+#endif // MAVLINK_FRAME_PARSER_H
@@ -0,0 +1,134 @@
+#include "mavlink_router.h"
+
+// MAVLink
+#include <mavlink.h>
+#include <mavlink_helpers.h>
+
+using namespace comm;
+
+namespace
+{
+    const qint64 duplicateWindow = 500; // ms, skew between redundant links
+
+    inline quint16 routeKey(quint8 systemId, quint8 componentId)
+    {
+        return quint16(systemId) << 8 | componentId;
+    }
+
+    // Target system and component of the message, zeroes for a broadcast
+    void target(const mavlink_message_t& message, quint8& systemId, quint8& componentId)
+    {
+        systemId = 0;
+        componentId = 0;
+
+#ifdef MAVLINK_V2
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+        if (!entry) return;
+
+        const quint8* payload = reinterpret_cast<const quint8*>(_MAV_PAYLOAD(&message));
+        if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) &&
+            entry->target_system_ofs < message.len)
+        {
+            systemId = payload[entry->target_system_ofs];
+        }
+        if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) &&
+            entry->target_component_ofs < message.len)
+        {
+            componentId = payload[entry->target_component_ofs];
+        }
+#else
+        Q_UNUSED(message) // No target offsets in v1 tables, everything is broadcast
+#endif
+    }
+}
+
+MavLinkRouter::MavLinkRouter()
+{
+    m_clock.start();
+}
+
+bool MavLinkRouter::learn(const mavlink_message_t& message, AbstractLink* link)
+{
+    return this->learn(message, link, m_clock.elapsed());
+}
+
+bool MavLinkRouter::learn(const mavlink_message_t& message, AbstractLink* link, qint64 time)
+{
+    const quint16 key = ::routeKey(message.sysid, message.compid);
+
+    Source& source = m_sources[key];
+    Seen& seen = source.seen[message.seq];
+
+    // Constant or wrapped sequence through the same link is a new frame, as well as the late one
+    if (seen.link && seen.link != link && seen.messageId == message.msgid &&
+        seen.checksum == message.checksum && time - seen.time < ::duplicateWindow)
+    {
+        return false;
+    }
+
+    seen.link = link;
+    seen.messageId = message.msgid;
+    seen.checksum = message.checksum;
+    seen.time = time;
+
+    m_routes[key] = link;
+    return true;
+}
+
+MavLinkRouter::Links MavLinkRouter::route(const mavlink_message_t& message, AbstractLink* from,
+                                          const QList<AbstractLink*>& links) const
+{
+    Links result;
+
+    quint8 systemId, componentId;
+    ::target(message, systemId, componentId);
+
+    if (!systemId)
+    {
+        for (AbstractLink* link: links)
+        {
+            if (link != from) result.append(link);
+        }
+        return result;
+    }
+
+    // Unknown targets are not flooded, nobody has seen them yet
+    for (auto it = m_routes.constBegin(); it != m_routes.constEnd(); ++it)
+    {
+        if (it.key() >> 8 != systemId) continue;
+        if (componentId && (it.key() & 0xFF) != componentId) continue;
+
+        if (it.value() != from && !result.contains(it.value())) result.append(it.value());
+    }
+
+    return result;
+}
+
+AbstractLink* MavLinkRouter::link(quint8 systemId, quint8 componentId) const
+{
+    return m_routes.value(::routeKey(systemId, componentId), nullptr);
+}
+
+void MavLinkRouter::removeLink(AbstractLink* link)
+{
+    // Address may be reused by a new link
+    for (Source& source: m_sources)
+    {
+        for (Seen& seen: source.seen)
+        {
+            if (seen.link == link) seen.link = nullptr;
+        }
+    }
+
+    for (auto it = m_routes.begin(); it != m_routes.end();)
+    {
+        if (it.value() == link) it = m_routes.erase(it);
+        else ++it;
+    }
+}
+
+void MavLinkRouter::clear()
+{
+    m_routes.clear();
+    m_sources.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef MAVLINK_ROUTER_H
+#define MAVLINK_ROUTER_H
+
+// Qt
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QVarLengthArray>
+#include <QElapsedTimer>
+
+// MAVLink
+#include <mavlink_types.h>
+
+namespace comm
+{
+    class AbstractLink;
+
+    // Learns which link each system and component talks through and selects links
+    // for forwarding: broadcasts go everywhere, targeted messages only to the target's link.
+    // Same frame coming shortly after through another, redundant link is recognised as duplicate.
+    class MavLinkRouter
+    {
+    public:
+        using Links = QVarLengthArray<AbstractLink*, 8>;
+
+        MavLinkRouter();
+
+        // Remembers source route, returns false for a duplicate of a recent frame. Frames are
+        // compared by sequence, id and checksum, repeats through the same link are never dropped
+        bool learn(const mavlink_message_t& message, AbstractLink* link);
+        bool learn(const mavlink_message_t& message, AbstractLink* link, qint64 time); // ms
+
+        // Links to forward message to, never the one it came from
+        Links route(const mavlink_message_t& message, AbstractLink* from,
+                    const QList<AbstractLink*>& links) const;
+
+        AbstractLink* link(quint8 systemId, quint8 componentId) const;
+
+        void removeLink(AbstractLink* link);
+        void clear();
+
+    private:
+        class Seen
+        {
+        public:
+            AbstractLink* link = nullptr; // Null is never seen
+            quint32 messageId = 0;
+            quint16 checksum = 0;
+            qint64 time = 0;
+        };
+
+        class Source
+        {
+        public:
+            QVector<Seen> seen = QVector<Seen>(256); // By sequence number
+        };
+
+        QElapsedTimer m_clock;
+
+        QHash<quint16, AbstractLink*> m_routes; // System and component to link
+        QHash<quint16, Source> m_sources;
+    };
+}
+
+#endif // MAVLINK_ROUTER_H
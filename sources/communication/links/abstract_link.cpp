@@ -2,26 +2,98 @@
 
 // Qt
 #include <QAbstractSocket>
+#include <QMetaMethod>
+#include <QIODevice>
 #include <QDebug>
 
+// Internal
+#include "i_link_receiver.h"
+
 using namespace comm;
 
+namespace
+{
+    const int readChunkSize = 16 * 1024;
+    const int queueLimit = 64 * 1024; // Per priority, frames over it are dropped
+    const int queueReserve = 1024;
+}
+
+void AbstractLink::OutboundQueue::take(int bytes, int frames)
+{
+    if (!frames) return;
+
+    data.remove(0, bytes);
+    ends.remove(0, frames);
+    for (int& end: ends) end -= bytes;
+}
+
 AbstractLink::AbstractLink(QObject* parent):
     QObject(parent)
-{}
+{
+    // Reserved capacity survives emptying, so steady traffic doesn't allocate
+    for (OutboundQueue& queue: m_queues)
+    {
+        queue.data.reserve(::queueReserve);
+        queue.ends.reserve(::queueReserve / 8);
+    }
+    m_outbound.reserve(::queueReserve);
+    m_packetEnds.reserve(::queueReserve / 8);
+}
 
 int AbstractLink::takeBytesReceived()
 {
-    int value = m_bytesReceived;
-    m_bytesReceived = 0;
-    return value;
+    return m_bytesReceived.fetchAndStoreRelaxed(0);
 }
 
 int AbstractLink::takeBytesSent()
 {
-    int value = m_bytesSent;
-    m_bytesSent = 0;
-    return value;
+    return m_bytesSent.fetchAndStoreRelaxed(0);
+}
+
+int AbstractLink::queuedBytes() const
+{
+    QMutexLocker locker(&m_queuesMutex);
+
+    int bytes = 0;
+    for (const OutboundQueue& queue: m_queues) bytes += queue.data.size();
+    return bytes;
+}
+
+quint64 AbstractLink::droppedFrames() const
+{
+    QMutexLocker locker(&m_queuesMutex);
+    return m_droppedFrames;
+}
+
+void AbstractLink::sendData(const char* data, int length, Priority priority)
+{
+    if (length <= 0) return;
+
+    {
+        QMutexLocker locker(&m_queuesMutex);
+
+        OutboundQueue& queue = m_queues[priority];
+        if (queue.data.size() + length > ::queueLimit)
+        {
+            m_droppedFrames++;
+            return;
+        }
+
+        queue.data.append(data, length);
+        queue.ends.append(queue.data.size());
+    }
+
+    this->scheduleFlush();
+}
+
+ILinkReceiver* AbstractLink::receiver() const
+{
+    return m_receiver.loadAcquire();
+}
+
+void AbstractLink::setReceiver(ILinkReceiver* receiver)
+{
+    m_receiver.storeRelease(receiver);
 }
 
 void AbstractLink::setConnected(bool connected)
@@ -31,16 +103,129 @@ void AbstractLink::setConnected(bool connected)
 
 void AbstractLink::sendData(const QByteArray& data)
 {
-    if (!this->sendDataImpl(data)) return;
+    this->sendData(data.constData(), data.size(), Normal);
+}
+
+bool AbstractLink::sendPackets(const QByteArray& data, const QVector<int>& ends)
+{
+    if (ends.count() == 1) return this->sendDataImpl(data);
+
+    bool ok = false;
+    int start = 0;
+    for (int end: ends)
+    {
+        if (this->sendDataImpl(QByteArray::fromRawData(data.constData() + start, end - start)))
+        {
+            ok = true;
+        }
+        start = end;
+    }
+    return ok;
+}
+
+int AbstractLink::maxPacketSize() const
+{
+    return 0;
+}
+
+qint64 AbstractLink::writeBudget() const
+{
+    return -1;
+}
 
-    m_bytesSent += data.size();
+void AbstractLink::scheduleFlush()
+{
+    if (!this->queuedBytes() || !m_flushScheduled.testAndSetOrdered(0, 1)) return;
+
+    QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+}
+
+void AbstractLink::flush()
+{
+    m_flushScheduled.storeRelease(0);
+
+    const qint64 budget = this->writeBudget();
+    const int packetLimit = this->maxPacketSize();
+    int packetStart = 0;
+
+    m_outbound.resize(0);
+    m_packetEnds.resize(0);
+
+    QMutexLocker locker(&m_queuesMutex);
+
+    for (int priority = Urgent; priority < PrioritiesCount; ++priority)
+    {
+        OutboundQueue& queue = m_queues[priority];
+
+        int start = 0;
+        int frames = 0;
+        for (; frames < queue.ends.count(); ++frames)
+        {
+            const int length = queue.ends.at(frames) - start;
+            if (priority != Urgent && budget >= 0 && m_outbound.size() + length > budget) break;
+
+            if (packetLimit && m_outbound.size() > packetStart &&
+                m_outbound.size() - packetStart + length > packetLimit)
+            {
+                m_packetEnds.append(m_outbound.size());
+                packetStart = m_outbound.size();
+            }
+
+            m_outbound.append(queue.data.constData() + start, length);
+            start += length;
+        }
+
+        queue.take(start, frames);
+        if (!queue.ends.isEmpty()) break; // Over budget, lower priorities wait as well
+    }
+    locker.unlock();
+
+    if (m_outbound.size() == packetStart) return;
+    m_packetEnds.append(m_outbound.size());
+
+    if (!this->sendPackets(m_outbound, m_packetEnds)) return;
+
+    m_bytesSent.fetchAndAddRelaxed(m_outbound.size());
     emit dataSent();
 }
 
+char* AbstractLink::receiveBuffer(int capacity)
+{
+    if (m_receiveBuffer.size() < capacity) m_receiveBuffer.resize(capacity);
+
+    return m_receiveBuffer.data();
+}
+
+void AbstractLink::receiveData(const char* data, int length)
+{
+    if (length <= 0) return;
+
+    m_bytesReceived.fetchAndAddRelaxed(length);
+
+    ILinkReceiver* receiver = m_receiver.loadAcquire();
+    if (receiver) receiver->receiveData(this, reinterpret_cast<const quint8*>(data), length);
+
+    emit received();
+
+    static const QMetaMethod dataReceivedSignal = QMetaMethod::fromSignal(
+                                                      &AbstractLink::dataReceived);
+    if (this->isSignalConnected(dataReceivedSignal)) emit dataReceived(QByteArray(data, length));
+}
+
+void AbstractLink::receiveAvailable(QIODevice* device)
+{
+    char* buffer = this->receiveBuffer(::readChunkSize);
+
+    qint64 length;
+    while ((length = device->read(buffer, ::readChunkSize)) > 0)
+    {
+        this->receiveData(buffer, length);
+    }
+}
+
 void AbstractLink::receiveData(const QByteArray& data)
 {
-    m_bytesReceived += data.size();
-    emit dataReceived(data);
+    this->receiveData(data.constData(), data.size());
 }
 
 void AbstractLink::onSocketError(int error)
@@ -3,14 +3,33 @@
 
 // Qt
 #include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
+class QIODevice;
 
 namespace comm
 {
+    class ILinkReceiver;
+
     class AbstractLink: public QObject
     {
         Q_OBJECT
 
     public:
+        // Outbound frames are queued and written in this order once per event loop pass
+        enum Priority
+        {
+            Urgent, // Commands, not held back by a saturated link
+            High,   // Mission protocol
+            Normal,
+            Low,    // Retranslated traffic
+            PrioritiesCount
+        };
+
         explicit AbstractLink(QObject* parent = nullptr);
 
         virtual bool isConnected() const = 0;
@@ -18,31 +37,77 @@ namespace comm
         int takeBytesReceived();
         int takeBytesSent();
 
+        int queuedBytes() const;
+        quint64 droppedFrames() const; // Outbound, over queue limit
+
+        // Copies frame into the queue of its priority, write happens on the next pass of the
+        // link thread. Safe to call from any thread, as received data is processed elsewhere.
+        void sendData(const char* data, int length, Priority priority);
+
+        ILinkReceiver* receiver() const;
+        void setReceiver(ILinkReceiver* receiver); // Not owned, called in the link thread
+
     public slots:
         void setConnected(bool connected);
         virtual void connectLink() = 0;
         virtual void disconnectLink() = 0;
 
-        void sendData(const QByteArray& data);
+        void sendData(const QByteArray& data); // Normal priority
 
     signals:
         void connectedChanged(bool connected);
         void errored(QString error);
-        void dataReceived(QByteArray data);
+        void dataReceived(QByteArray data); // Copies bytes, emitted only when connected
+        void received();
         void dataSent();
 
     protected:
+        // Data may wrap foreign memory, implementations copy it if it is kept after the call
         virtual bool sendDataImpl(const QByteArray& data) = 0;
 
+        // Packets lie one after another in data and end at given offsets, one write each
+        virtual bool sendPackets(const QByteArray& data, const QVector<int>& ends);
+        virtual int maxPacketSize() const; // Frames are never split, 0 is unlimited
+        virtual qint64 writeBudget() const; // Bytes device takes now, negative is unlimited
+
+        void scheduleFlush(); // When device drained, frames over budget are waiting
+
+        // Reusable receive buffer, grows to capacity once and is shared by all reads
+        char* receiveBuffer(int capacity);
+        void receiveData(const char* data, int length);
+        void receiveAvailable(QIODevice* device); // Drains device through receive buffer
+
     protected slots:
         void receiveData(const QByteArray& data);
 
     public slots: // QOverload require public
         void onSocketError(int error);
 
+    private slots:
+        void flush();
+
     private:
-        int m_bytesReceived = 0;
-        int m_bytesSent = 0;
+        class OutboundQueue
+        {
+        public:
+            QByteArray data;
+            QVector<int> ends; // Frame boundaries in data
+
+            void take(int bytes, int frames);
+        };
+
+        mutable QMutex m_queuesMutex;
+        OutboundQueue m_queues[PrioritiesCount];
+        quint64 m_droppedFrames = 0;
+        QAtomicInt m_flushScheduled;
+
+        QByteArray m_outbound; // Link thread only
+        QVector<int> m_packetEnds;
+
+        QAtomicPointer<ILinkReceiver> m_receiver;
+        QByteArray m_receiveBuffer;
+        QAtomicInt m_bytesReceived;
+        QAtomicInt m_bytesSent;
     };
 }
 
@@ -68,7 +68,7 @@ void BluetoothLink::onReadyRead()
 {
     if (!m_socket->isReadable()) return;
 
-    while (m_socket->bytesAvailable()) this->receiveData(m_socket->readAll());
+    this->receiveAvailable(m_socket);
 }
 
 void BluetoothLink::onError(int error)
@@ -0,0 +1,21 @@
+#ifndef I_LINK_RECEIVER_H
+#define I_LINK_RECEIVER_H
+
+#include <QtGlobal>
+
+namespace comm
+{
+    class AbstractLink;
+
+    class ILinkReceiver
+    {
+    public:
+        ILinkReceiver() {}
+        virtual ~ILinkReceiver() {}
+
+        // Called directly in the link thread, data is valid only during the call
+        virtual void receiveData(AbstractLink* link, const quint8* data, int length) = 0;
+    };
+}
+
+#endif // I_LINK_RECEIVER_H
@@ -6,6 +6,12 @@
 
 using namespace comm;
 
+namespace
+{
+    const int budgetFraction = 10; // Line time of a tenth of a second is kept in the port
+    const int minWriteBudget = 280; // Biggest MAVLink frame
+}
+
 SerialLink::SerialLink(const QString& portName, qint32 baudRate,
                        QObject* parent):
     AbstractLink(parent),
@@ -14,6 +20,7 @@ SerialLink::SerialLink(const QString& portName, qint32 baudRate,
     m_port->setBaudRate(baudRate);
 
     connect(m_port, &QSerialPort::readyRead, this, &SerialLink::readSerialData);
+    connect(m_port, &QSerialPort::bytesWritten, this, &SerialLink::scheduleFlush);
     connect(m_port, static_cast<void(QSerialPort::*)
             (QSerialPort::SerialPortError)>(&QSerialPort::error),
             this, &SerialLink::onError);
@@ -72,9 +79,16 @@ bool SerialLink::sendDataImpl(const QByteArray& data)
     return false;
 }
 
+qint64 SerialLink::writeBudget() const
+{
+    // Short port buffer keeps commands from waiting behind seconds of mission or relay data
+    qint64 lineBytes = qMax<qint64>(m_port->baudRate() / 10 / ::budgetFraction, ::minWriteBudget);
+    return qMax<qint64>(0, lineBytes - m_port->bytesToWrite());
+}
+
 void SerialLink::readSerialData()
 {
-    if (m_port->isReadable()) this->receiveData(m_port->readAll());
+    if (m_port->isReadable()) this->receiveAvailable(m_port);
 }
 
 void SerialLink::onError(int error)
@@ -33,6 +33,7 @@ namespace comm
 
     protected:
         bool sendDataImpl(const QByteArray& data) override;
+        qint64 writeBudget() const override;
 
     private slots:
         void readSerialData();
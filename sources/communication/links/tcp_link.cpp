@@ -71,5 +71,5 @@ bool TcpLink::sendDataImpl(const QByteArray& data)
 
 void TcpLink::onReadyRead()
 {
-    while (m_socket->bytesAvailable()) this->receiveData(m_socket->readAll());
+    this->receiveAvailable(m_socket);
 }
@@ -0,0 +1,162 @@
+#include "tlog_replay_link.h"
+
+// Qt
+#include <QTimerEvent>
+#include <QDebug>
+
+// Std
+#include <cstring>
+
+// Internal
+#include "tlog_reader.h"
+
+using namespace comm;
+
+namespace
+{
+    const int playbackInterval = 10; // ms
+    const int fastBatchSize = 64 * 1024; // Bytes per event loop pass in fast mode
+    const int maxFrameLength = 280; // MAVLink v2 with signature
+}
+
+TlogReplayLink::TlogReplayLink(const QString& path, double speed, QObject* parent):
+    AbstractLink(parent),
+    m_reader(new TlogReader()),
+    m_path(path),
+    m_speed(qMax(0.0, speed))
+{}
+
+TlogReplayLink::~TlogReplayLink()
+{}
+
+bool TlogReplayLink::isConnected() const
+{
+    return m_reader->isOpen();
+}
+
+QString TlogReplayLink::path() const
+{
+    return m_path;
+}
+
+double TlogReplayLink::speed() const
+{
+    return m_speed;
+}
+
+quint64 TlogReplayLink::startTime() const
+{
+    return m_reader->startTime();
+}
+
+quint64 TlogReplayLink::endTime() const
+{
+    return m_reader->endTime();
+}
+
+quint64 TlogReplayLink::position() const
+{
+    return m_reader->nextTimestamp();
+}
+
+void TlogReplayLink::connectLink()
+{
+    if (this->isConnected() || m_path.isEmpty()) return;
+
+    if (!m_reader->open(m_path))
+    {
+        emit errored(tr("Can't open flight log %1").arg(m_path));
+        return;
+    }
+
+    emit connectedChanged(true);
+    this->play();
+}
+
+void TlogReplayLink::disconnectLink()
+{
+    if (!this->isConnected()) return;
+
+    if (m_timer) this->killTimer(m_timer);
+    m_timer = 0;
+
+    m_reader->close();
+    emit connectedChanged(false);
+}
+
+void TlogReplayLink::setPath(const QString& path)
+{
+    if (m_path == path) return;
+
+    m_path = path;
+
+    if (this->isConnected())
+    {
+        this->disconnectLink();
+        this->connectLink();
+    }
+
+    emit pathChanged(path);
+}
+
+void TlogReplayLink::setSpeed(double speed)
+{
+    speed = qMax(0.0, speed);
+    if (qFuzzyCompare(m_speed, speed)) return;
+
+    m_speed = speed;
+    if (this->isConnected()) this->play();
+
+    emit speedChanged(speed);
+}
+
+void TlogReplayLink::seek(quint64 timestamp)
+{
+    if (!this->isConnected()) return;
+
+    m_reader->seek(timestamp);
+    this->play();
+}
+
+bool TlogReplayLink::sendDataImpl(const QByteArray& data)
+{
+    Q_UNUSED(data) // Nobody listens in a log
+
+    return this->isConnected();
+}
+
+void TlogReplayLink::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != m_timer) return AbstractLink::timerEvent(event);
+
+    // Batch never exceeds the limit by more than one frame
+    char* batch = this->receiveBuffer(::fastBatchSize + ::maxFrameLength);
+    int size = 0;
+    TlogReader::Frame frame;
+
+    quint64 until = m_anchor + quint64(m_clock.nsecsElapsed() / 1000 * m_speed);
+    while (size < ::fastBatchSize && !m_reader->atEnd() &&
+           (m_speed <= 0 || m_reader->nextTimestamp() <= until) && m_reader->next(frame))
+    {
+        std::memcpy(batch + size, frame.data, frame.length);
+        size += frame.length;
+    }
+
+    this->receiveData(batch, size);
+
+    if (m_reader->atEnd())
+    {
+        this->killTimer(m_timer);
+        m_timer = 0;
+        emit finished();
+    }
+}
+
+void TlogReplayLink::play()
+{
+    m_anchor = m_reader->nextTimestamp();
+    m_clock.start();
+
+    if (m_timer) this->killTimer(m_timer);
+    m_timer = m_reader->atEnd() ? 0 : this->startTimer(m_speed > 0 ? ::playbackInterval : 0);
+}
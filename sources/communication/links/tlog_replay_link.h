@@ -0,0 +1,63 @@
+#ifndef TLOG_REPLAY_LINK_H
+#define TLOG_REPLAY_LINK_H
+
+// Internal
+#include "abstract_link.h"
+
+// Qt
+#include <QElapsedTimer>
+
+namespace comm
+{
+    class TlogReader;
+
+    // Plays recorded tlog into the communicator as if it came from a vehicle
+    class TlogReplayLink: public AbstractLink
+    {
+        Q_OBJECT
+
+    public:
+        TlogReplayLink(const QString& path = QString(), double speed = 1.0,
+                       QObject* parent = nullptr);
+        ~TlogReplayLink() override;
+
+        bool isConnected() const override;
+
+        QString path() const;
+        double speed() const; // 1 is real time, 0 is as fast as possible
+
+        quint64 startTime() const;
+        quint64 endTime() const;
+        quint64 position() const;
+
+    public slots:
+        void connectLink() override;
+        void disconnectLink() override;
+
+        void setPath(const QString& path);
+        void setSpeed(double speed);
+        void seek(quint64 timestamp);
+
+    signals:
+        void pathChanged(QString path);
+        void speedChanged(double speed);
+        void finished();
+
+    protected:
+        bool sendDataImpl(const QByteArray& data) override;
+        void timerEvent(QTimerEvent* event) override;
+
+    private:
+        void play();
+
+        QScopedPointer<TlogReader> const m_reader;
+        QString m_path;
+        double m_speed;
+
+        QElapsedTimer m_clock;
+        quint64 m_anchor = 0; // Log time at clock start
+        int m_timer = 0;
+    };
+}
+
+#endif // TLOG_REPLAY_LINK_H
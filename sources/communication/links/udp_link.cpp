@@ -2,9 +2,82 @@
 
 // Qt
 #include <QUdpSocket>
+#include <QVarLengthArray>
+
+#ifdef Q_OS_LINUX
+// Linux
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+// Std
+#include <cstring>
+#endif
 
 using namespace comm;
 
+namespace
+{
+    const int datagramSize = 65507; // Inbound, largest UDP payload, anything less truncates
+    const int maxDatagramSize = 1472; // Outbound, fits Ethernet MTU without fragmentation
+#ifdef Q_OS_LINUX
+    const int batchSize = 16; // Slot pages are touched only as large as datagrams are
+
+    // Endpoint in the socket family, IPv4 is mapped for dual-stack sockets
+    bool toSocketAddress(const Endpoint& endpoint, int family,
+                         sockaddr_storage& storage, socklen_t& length)
+    {
+        std::memset(&storage, 0, sizeof(storage));
+
+        const QHostAddress address = endpoint.address();
+        bool isIPv4 = false;
+        const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+
+        if (family == AF_INET)
+        {
+            if (!isIPv4) return false;
+
+            sockaddr_in* in = reinterpret_cast<sockaddr_in*>(&storage);
+            in->sin_family = AF_INET;
+            in->sin_port = htons(endpoint.port());
+            in->sin_addr.s_addr = htonl(ipv4);
+            length = sizeof(sockaddr_in);
+            return true;
+        }
+
+        sockaddr_in6* in6 = reinterpret_cast<sockaddr_in6*>(&storage);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(endpoint.port());
+        if (isIPv4)
+        {
+            in6->sin6_addr.s6_addr[10] = 0xFF;
+            in6->sin6_addr.s6_addr[11] = 0xFF;
+            quint32 networkIPv4 = htonl(ipv4);
+            std::memcpy(&in6->sin6_addr.s6_addr[12], &networkIPv4, sizeof(networkIPv4));
+        }
+        else
+        {
+            const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+            std::memcpy(in6->sin6_addr.s6_addr, ipv6.c, sizeof(ipv6.c));
+        }
+        length = sizeof(sockaddr_in6);
+        return true;
+    }
+
+    bool sendAll(int descriptor, mmsghdr* messages, int count)
+    {
+        int sent = 0;
+        while (sent < count)
+        {
+            int result = ::sendmmsg(descriptor, messages + sent, count - sent, 0);
+            if (result <= 0) break;
+
+            sent += result;
+        }
+        return sent > 0;
+    }
+#endif
+}
+
 UdpLink::UdpLink(quint16 port, QObject* parent):
     AbstractLink(parent),
     m_socket(new QUdpSocket(this)),
@@ -121,23 +194,158 @@ bool UdpLink::sendDataImpl(const QByteArray& data)
     return ok;
 }
 
+bool UdpLink::sendPackets(const QByteArray& data, const QVector<int>& ends)
+{
+#ifdef Q_OS_LINUX
+    int descriptor = m_socket->socketDescriptor();
+    if (descriptor != -1) return this->sendBatch(descriptor, data, ends);
+#endif
+
+    return AbstractLink::sendPackets(data, ends);
+}
+
+int UdpLink::maxPacketSize() const
+{
+    return ::maxDatagramSize;
+}
+
 void UdpLink::onReadyRead()
 {
-    while (m_socket->hasPendingDatagrams())
+    if (!m_socket->hasPendingDatagrams()) return;
+
+    // Regular read first, it re-arms Qt notifier while the socket is bypassed for the rest
+    this->readDatagram();
+
+#ifdef Q_OS_LINUX
+    while (this->isConnected() && this->readBatch() == ::batchSize);
+    if (!this->isConnected()) return;
+#endif
+
+    while (m_socket->hasPendingDatagrams()) this->readDatagram();
+}
+
+void UdpLink::readDatagram()
+{
+    char* buffer = this->receiveBuffer(::datagramSize);
+
+    QHostAddress address;
+    quint16 port = 0;
+    qint64 length = m_socket->readDatagram(buffer, ::datagramSize, &address, &port);
+    if (length <= 0) return;
+
+    this->onSender(address, port);
+    this->receiveData(buffer, length);
+}
+
+#ifdef Q_OS_LINUX
+int UdpLink::readBatch()
+{
+    // Slots of one pooled buffer, no allocations per datagram
+    char* buffer = this->receiveBuffer(::batchSize * ::datagramSize);
+
+    mmsghdr messages[::batchSize];
+    iovec vectors[::batchSize];
+    sockaddr_storage senders[::batchSize];
+    std::memset(messages, 0, sizeof(messages));
+
+    for (int i = 0; i < ::batchSize; ++i)
     {
-        QByteArray datagram;
-        datagram.resize(m_socket->pendingDatagramSize());
+        vectors[i].iov_base = buffer + i * ::datagramSize;
+        vectors[i].iov_len = ::datagramSize;
+
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &senders[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
 
-        QHostAddress address;
-        quint16 port;
-        m_socket->readDatagram(datagram.data(), datagram.size(), &address, &port);
+    // Errors are left to the regular read, it reports them through the socket
+    int count = ::recvmmsg(m_socket->socketDescriptor(), messages, ::batchSize,
+                           MSG_DONTWAIT, nullptr);
+    if (count <= 0) return 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const msghdr& header = messages[i].msg_hdr;
+        const sockaddr* sender = reinterpret_cast<const sockaddr*>(&senders[i]);
 
-        Endpoint endpoint(address, port);
-        if (m_autoResponse && !m_endpoints.contains(endpoint))
+        // Sender is converted only when it changes, usually one vehicle fills whole batch
+        if (i == 0 || header.msg_namelen != messages[i - 1].msg_hdr.msg_namelen ||
+            std::memcmp(&senders[i], &senders[i - 1], header.msg_namelen))
         {
-            this->addEndpoint(endpoint);
+            quint16 port = sender->sa_family == AF_INET6 ?
+                               ntohs(reinterpret_cast<const sockaddr_in6*>(sender)->sin6_port) :
+                               ntohs(reinterpret_cast<const sockaddr_in*>(sender)->sin_port);
+            this->onSender(QHostAddress(sender), port);
         }
 
-        this->receiveData(datagram);
+        if (header.msg_flags & MSG_TRUNC) continue; // Broken frames only, slots fit any datagram
+
+        this->receiveData(static_cast<const char*>(vectors[i].iov_base), messages[i].msg_len);
+    }
+
+    return count;
+}
+
+bool UdpLink::sendBatch(int descriptor, const QByteArray& data, const QVector<int>& ends)
+{
+    sockaddr_storage local;
+    socklen_t localLength = sizeof(local);
+    if (::getsockname(descriptor, reinterpret_cast<sockaddr*>(&local), &localLength) != 0)
+    {
+        return AbstractLink::sendPackets(data, ends);
+    }
+
+    QVarLengthArray<sockaddr_storage, 8> addresses;
+    QVarLengthArray<socklen_t, 8> lengths;
+    for (const Endpoint& endpoint: m_endpoints)
+    {
+        sockaddr_storage address;
+        socklen_t length;
+        if (!::toSocketAddress(endpoint, local.ss_family, address, length)) continue;
+
+        addresses.append(address);
+        lengths.append(length);
     }
+
+    // Every packet to every endpoint, one syscall per batch
+    mmsghdr messages[::batchSize];
+    iovec vectors[::batchSize];
+    std::memset(messages, 0, sizeof(messages));
+
+    bool ok = false;
+    int count = 0;
+    int start = 0;
+    for (int end: ends)
+    {
+        for (int i = 0; i < addresses.count(); ++i)
+        {
+            vectors[count].iov_base = const_cast<char*>(data.constData() + start);
+            vectors[count].iov_len = end - start;
+
+            msghdr& header = messages[count].msg_hdr;
+            header.msg_iov = &vectors[count];
+            header.msg_iovlen = 1;
+            header.msg_name = &addresses[i];
+            header.msg_namelen = lengths.at(i);
+
+            if (++count < ::batchSize) continue;
+
+            if (::sendAll(descriptor, messages, count)) ok = true;
+            count = 0;
+        }
+        start = end;
+    }
+
+    if (count && ::sendAll(descriptor, messages, count)) ok = true;
+    return ok;
+}
+#endif
+
+void UdpLink::onSender(const QHostAddress& address, quint16 port)
+{
+    if (!m_autoResponse) return;
+
+    Endpoint endpoint(address, port);
+    if (!m_endpoints.contains(endpoint)) this->addEndpoint(endpoint);
 }
@@ -42,11 +42,20 @@ namespace comm
 
     protected:
         bool sendDataImpl(const QByteArray& data) override;
+        bool sendPackets(const QByteArray& data, const QVector<int>& ends) override;
+        int maxPacketSize() const override;
 
     private slots:
         void onReadyRead();
 
     private:
+        void readDatagram();
+#ifdef Q_OS_LINUX
+        int readBatch(); // Datagrams read by one recvmmsg
+        bool sendBatch(int descriptor, const QByteArray& data, const QVector<int>& ends);
+#endif
+        void onSender(const QHostAddress& address, quint16 port);
+
         QUdpSocket* m_socket;
         quint16 m_port;
         EndpointList m_endpoints;
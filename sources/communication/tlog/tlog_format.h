@@ -0,0 +1,67 @@
+#ifndef TLOG_FORMAT_H
+#define TLOG_FORMAT_H
+
+// Qt
+#include <QString>
+#include <QtEndian>
+
+// Session directory contains numbered segments, each one is a plain tlog file: every frame is
+// prefixed with big-endian microseconds since epoch, as MAVProxy and QGroundControl write them.
+// Unused tail of a preallocated segment is zeroed, so reading stops on the first zero magic.
+// Each segment has an index of (timestamp, offset) pairs, one per indexInterval of flight.
+
+namespace comm
+{
+    namespace tlog
+    {
+        const QString segmentSuffix = ".tlog";
+        const QString indexSuffix = ".tidx";
+
+        const int timestampSize = 8;
+        const quint64 indexInterval = 1000000; // us
+
+        class IndexEntry
+        {
+        public:
+            quint64 timestamp; // Big-endian on disk
+            quint64 offset;
+        };
+
+        inline QString segmentName(int number)
+        {
+            return QString("%1").arg(number, 6, 10, QChar('0')) + segmentSuffix;
+        }
+
+        inline QString indexName(const QString& segmentPath)
+        {
+            return segmentPath.left(segmentPath.length() - segmentSuffix.length()) + indexSuffix;
+        }
+
+        inline quint64 readTimestamp(const uchar* data)
+        {
+            return qFromBigEndian<quint64>(data);
+        }
+
+        inline void writeTimestamp(quint64 timestamp, uchar* data)
+        {
+            qToBigEndian<quint64>(timestamp, data);
+        }
+
+        // Frame length by its MAVLink header, 0 if there is no frame or it is incomplete
+        inline int frameLength(const uchar* frame, qint64 available)
+        {
+            if (available < 2) return 0;
+
+            int length = 0;
+            if (frame[0] == 0xFE) length = 6 + frame[1] + 2; // v1: header, payload, crc
+            else if (frame[0] == 0xFD && available > 2)      // v2, signature is optional
+            {
+                length = 10 + frame[1] + 2 + ((frame[2] & 0x01) ? 13 : 0);
+            }
+
+            return length <= available ? length : 0;
+        }
+    }
+}
+
+#endif // TLOG_FORMAT_H
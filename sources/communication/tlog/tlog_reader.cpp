@@ -0,0 +1,245 @@
+#include "tlog_reader.h"
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QVector>
+#include <QDebug>
+
+// Std
+#include <algorithm>
+
+// Internal
+#include "tlog_format.h"
+
+using namespace comm;
+
+class TlogReader::Impl
+{
+public:
+    class Segment
+    {
+    public:
+        QFile* file;
+        const uchar* data;
+        qint64 size;
+    };
+
+    class IndexEntry
+    {
+    public:
+        quint64 timestamp;
+        int segment;
+        qint64 offset;
+
+        bool operator <(const IndexEntry& other) const
+        {
+            return timestamp < other.timestamp;
+        }
+    };
+
+    QVector<Segment> segments;
+    QVector<IndexEntry> index; // Sorted by time through all segments
+
+    int segment = 0;
+    qint64 offset = 0;
+    quint64 endTime = 0;
+
+    // Frame is over when segment ends, preallocated zero tail starts or data is broken
+    bool frameAt(int segmentNumber, qint64 frameOffset, Frame& frame) const
+    {
+        if (segmentNumber >= segments.count()) return false;
+
+        const Segment& segment = segments.at(segmentNumber);
+        qint64 available = segment.size - frameOffset - tlog::timestampSize;
+        if (available <= 0) return false;
+
+        const uchar* data = segment.data + frameOffset;
+        frame.length = tlog::frameLength(data + tlog::timestampSize, available);
+        if (!frame.length) return false;
+
+        frame.timestamp = tlog::readTimestamp(data);
+        frame.data = data + tlog::timestampSize;
+        return true;
+    }
+
+    void skipSegmentEnds()
+    {
+        Frame frame;
+        while (segment < segments.count() && !this->frameAt(segment, offset, frame))
+        {
+            segment++;
+            offset = 0;
+        }
+    }
+
+    bool mapSegment(const QString& path)
+    {
+        QFile* file = new QFile(path);
+        uchar* data = nullptr;
+
+        if (!file->open(QIODevice::ReadOnly) || file->size() == 0 ||
+            !(data = file->map(0, file->size())))
+        {
+            qWarning() << "Can't map tlog segment" << path << file->errorString();
+            delete file;
+            return false;
+        }
+
+        segments.append({ file, data, file->size() });
+        return true;
+    }
+
+    void loadIndex(int segmentNumber)
+    {
+        QFile file(tlog::indexName(segments.at(segmentNumber).file->fileName()));
+        if (file.open(QIODevice::ReadOnly))
+        {
+            tlog::IndexEntry entry;
+            while (file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) == sizeof(entry))
+            {
+                index.append({ qFromBigEndian(entry.timestamp), segmentNumber,
+                               qint64(qFromBigEndian(entry.offset)) });
+            }
+            return;
+        }
+
+        // Foreign tlog, build the same index in one pass
+        Frame frame;
+        quint64 nextTimestamp = 0;
+        for (qint64 frameOffset = 0; this->frameAt(segmentNumber, frameOffset, frame);
+             frameOffset += tlog::timestampSize + frame.length)
+        {
+            if (frame.timestamp < nextTimestamp) continue;
+
+            index.append({ frame.timestamp, segmentNumber, frameOffset });
+            nextTimestamp = frame.timestamp + tlog::indexInterval;
+        }
+    }
+
+    quint64 lastTimestamp() const
+    {
+        if (index.isEmpty()) return 0;
+
+        Frame frame;
+        quint64 timestamp = index.last().timestamp;
+        for (qint64 frameOffset = index.last().offset;
+             this->frameAt(index.last().segment, frameOffset, frame);
+             frameOffset += tlog::timestampSize + frame.length)
+        {
+            timestamp = frame.timestamp;
+        }
+        return timestamp;
+    }
+};
+
+TlogReader::TlogReader():
+    d(new Impl())
+{}
+
+TlogReader::~TlogReader()
+{
+    this->close();
+}
+
+bool TlogReader::open(const QString& path)
+{
+    this->close();
+
+    QFileInfo info(path);
+    if (info.isDir())
+    {
+        QDir dir(path);
+        for (const QString& name: dir.entryList({ "*" + tlog::segmentSuffix }, QDir::Files,
+                                                QDir::Name))
+        {
+            d->mapSegment(dir.filePath(name));
+        }
+    }
+    else
+    {
+        d->mapSegment(path);
+    }
+
+    if (d->segments.isEmpty()) return false;
+
+    for (int segment = 0; segment < d->segments.count(); ++segment) d->loadIndex(segment);
+    std::stable_sort(d->index.begin(), d->index.end());
+
+    d->endTime = d->lastTimestamp();
+    d->skipSegmentEnds();
+
+    return true;
+}
+
+void TlogReader::close()
+{
+    for (const Impl::Segment& segment: d->segments)
+    {
+        segment.file->unmap(const_cast<uchar*>(segment.data));
+        delete segment.file;
+    }
+
+    d->segments.clear();
+    d->index.clear();
+    d->segment = 0;
+    d->offset = 0;
+    d->endTime = 0;
+}
+
+bool TlogReader::isOpen() const
+{
+    return !d->segments.isEmpty();
+}
+
+quint64 TlogReader::startTime() const
+{
+    return d->index.isEmpty() ? 0 : d->index.first().timestamp;
+}
+
+quint64 TlogReader::endTime() const
+{
+    return d->endTime;
+}
+
+bool TlogReader::atEnd() const
+{
+    return d->segment >= d->segments.count();
+}
+
+quint64 TlogReader::nextTimestamp() const
+{
+    Frame frame;
+    return d->frameAt(d->segment, d->offset, frame) ? frame.timestamp : d->endTime;
+}
+
+bool TlogReader::next(Frame& frame)
+{
+    if (!d->frameAt(d->segment, d->offset, frame)) return false;
+
+    d->offset += tlog::timestampSize + frame.length;
+    d->skipSegmentEnds();
+
+    return true;
+}
+
+void TlogReader::seek(quint64 timestamp)
+{
+    if (d->index.isEmpty()) return;
+
+    // Last indexed frame before timestamp, then forward by frames
+    Impl::IndexEntry key = { timestamp, 0, 0 };
+    auto it = std::upper_bound(d->index.constBegin(), d->index.constEnd(), key);
+    if (it != d->index.constBegin()) --it;
+
+    d->segment = it->segment;
+    d->offset = it->offset;
+    d->skipSegmentEnds();
+
+    Frame frame;
+    while (d->frameAt(d->segment, d->offset, frame) && frame.timestamp < timestamp)
+    {
+        this->next(frame);
+    }
+}
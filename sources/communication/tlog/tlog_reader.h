@@ -0,0 +1,46 @@
+#ifndef TLOG_READER_H
+#define TLOG_READER_H
+
+// Qt
+#include <QScopedPointer>
+#include <QString>
+
+namespace comm
+{
+    // Sequential reader over memory-mapped tlog segments with seeking by time index.
+    // Accepts recorder's session directory or a single tlog file of any ground station.
+    class TlogReader
+    {
+    public:
+        class Frame
+        {
+        public:
+            quint64 timestamp = 0;
+            const uchar* data = nullptr; // Points into mapped segment, valid until close
+            int length = 0;
+        };
+
+        TlogReader();
+        ~TlogReader();
+
+        bool open(const QString& path);
+        void close();
+        bool isOpen() const;
+
+        quint64 startTime() const;
+        quint64 endTime() const;
+
+        bool atEnd() const;
+        quint64 nextTimestamp() const; // Timestamp of the frame next() will return
+        bool next(Frame& frame);
+
+        void seek(quint64 timestamp); // To the first frame not earlier than timestamp
+
+    private:
+        class Impl;
+        QScopedPointer<Impl> const d;
+        Q_DISABLE_COPY(TlogReader)
+    };
+}
+
+#endif // TLOG_READER_H
@@ -0,0 +1,290 @@
+#include "tlog_recorder.h"
+
+// Qt
+#include <QThread>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QVector>
+#include <QAtomicInteger>
+#include <QDebug>
+
+// Std
+#include <cstring>
+
+// Internal
+#include "tlog_format.h"
+
+using namespace comm;
+
+namespace
+{
+    const int recordHeaderSize = 10; // Host-order timestamp and frame length, ring only
+    const int minBufferSize = 4096;
+    const int idleInterval = 5; // ms, writer sleeps when ring is empty
+
+    quint32 roundUpToPowerOfTwo(int value)
+    {
+        quint32 result = 1;
+        while (result < quint32(value)) result <<= 1;
+        return result;
+    }
+}
+
+class TlogRecorder::Impl
+{
+public:
+    class Writer: public QThread
+    {
+    public:
+        explicit Writer(Impl* impl): impl(impl)
+        {
+            this->setObjectName("Tlog writer thread");
+        }
+
+    protected:
+        void run() override
+        {
+            impl->writeLoop();
+        }
+
+    private:
+        Impl* const impl;
+    };
+
+    QVector<quint8> buffer;
+    quint8* const data; // Detached once, accessed from both threads
+    const quint32 mask;
+
+    QAtomicInteger<quint32> head; // Published by producer
+    QAtomicInteger<quint32> tail; // Released by writer
+    QAtomicInteger<quint64> recorded;
+    QAtomicInteger<quint64> dropped;
+    QAtomicInt recording;
+    QAtomicInt stopRequested;
+
+    const qint64 segmentSize;
+    QString sessionPath;
+    Writer writer;
+
+    // Writer thread state
+    QFile segment;
+    QFile index;
+    uchar* map = nullptr;
+    qint64 used = 0;
+    int segmentNumber = 0;
+    quint64 nextIndexTimestamp = 0;
+    bool failed = false;
+
+    Impl(int bufferSize, qint64 segmentSize):
+        buffer(::roundUpToPowerOfTwo(qMax(bufferSize, ::minBufferSize))),
+        data(buffer.data()),
+        mask(buffer.count() - 1),
+        segmentSize(segmentSize),
+        writer(this)
+    {}
+
+    void copyIn(quint32 position, const void* source, int length)
+    {
+        quint32 offset = position & mask;
+        int first = qMin<int>(length, mask + 1 - offset);
+
+        std::memcpy(data + offset, source, first);
+        std::memcpy(data, static_cast<const quint8*>(source) + first, length - first);
+    }
+
+    void copyOut(quint32 position, void* target, int length) const
+    {
+        quint32 offset = position & mask;
+        int first = qMin<int>(length, mask + 1 - offset);
+
+        std::memcpy(target, data + offset, first);
+        std::memcpy(static_cast<quint8*>(target) + first, data, length - first);
+    }
+
+    void writeLoop()
+    {
+        while (!stopRequested.loadAcquire())
+        {
+            if (!this->drain()) QThread::msleep(::idleInterval);
+        }
+
+        this->drain();
+        this->closeSegment();
+    }
+
+    bool drain()
+    {
+        quint32 position = tail.load();
+        const quint32 end = head.loadAcquire();
+        if (position == end) return false;
+
+        while (position != end)
+        {
+            quint64 timestamp;
+            quint16 length;
+            this->copyOut(position, &timestamp, sizeof(timestamp));
+            this->copyOut(position + sizeof(timestamp), &length, sizeof(length));
+
+            this->writeFrame(timestamp, position + ::recordHeaderSize, length);
+
+            position += ::recordHeaderSize + length;
+            tail.storeRelease(position);
+        }
+
+        return true;
+    }
+
+    void writeFrame(quint64 timestamp, quint32 position, int length)
+    {
+        qint64 size = tlog::timestampSize + length;
+        if (map && used + size > segmentSize) this->closeSegment();
+        if (!map && !this->openSegment())
+        {
+            dropped.ref();
+            return;
+        }
+
+        // First frame of the segment is always indexed
+        if (timestamp >= nextIndexTimestamp)
+        {
+            tlog::IndexEntry entry = { qToBigEndian(timestamp), qToBigEndian<quint64>(used) };
+            index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            nextIndexTimestamp = timestamp + tlog::indexInterval;
+        }
+
+        tlog::writeTimestamp(timestamp, map + used);
+        this->copyOut(position, map + used + tlog::timestampSize, length);
+        used += size;
+        recorded.ref();
+    }
+
+    bool openSegment()
+    {
+        if (failed) return false;
+
+        QString path = sessionPath + "/" + tlog::segmentName(segmentNumber++);
+
+        segment.setFileName(path);
+        if (!segment.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+            !segment.resize(segmentSize) ||
+            !(map = segment.map(0, segmentSize)))
+        {
+            qWarning() << "Can't create tlog segment" << path << segment.errorString();
+            segment.close();
+            failed = true;
+            return false;
+        }
+
+        index.setFileName(tlog::indexName(path));
+        if (!index.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qWarning() << "Can't create tlog index" << index.fileName() << index.errorString();
+        }
+
+        used = 0;
+        nextIndexTimestamp = 0;
+        return true;
+    }
+
+    void closeSegment()
+    {
+        if (!map) return;
+
+        segment.unmap(map);
+        map = nullptr;
+
+        segment.resize(used); // Cut preallocated tail
+        segment.close();
+        index.close();
+    }
+};
+
+TlogRecorder::TlogRecorder(int bufferSize, qint64 segmentSize):
+    d(new Impl(bufferSize, segmentSize))
+{}
+
+TlogRecorder::~TlogRecorder()
+{
+    this->stop();
+}
+
+bool TlogRecorder::start(const QString& directory)
+{
+    if (this->isRecording()) return false;
+
+    QDir dir(directory);
+    QString session = QDateTime::currentDateTime().toString("yyyy.MM.dd-hh.mm.ss");
+    if (!dir.mkpath(session))
+    {
+        qWarning() << "Can't create tlog directory" << dir.filePath(session);
+        return false;
+    }
+
+    d->sessionPath = dir.absoluteFilePath(session);
+    d->head.store(0);
+    d->tail.store(0);
+    d->segmentNumber = 0;
+    d->failed = false;
+
+    d->stopRequested.storeRelease(0);
+    d->writer.start();
+    d->recording.storeRelease(1);
+
+    return true;
+}
+
+void TlogRecorder::stop()
+{
+    if (!this->isRecording()) return;
+
+    d->recording.storeRelease(0);
+    d->stopRequested.storeRelease(1);
+    d->writer.wait();
+}
+
+bool TlogRecorder::isRecording() const
+{
+    return d->recording.loadAcquire();
+}
+
+QString TlogRecorder::sessionPath() const
+{
+    return d->sessionPath;
+}
+
+bool TlogRecorder::record(const quint8* frame, int length, quint64 timestamp)
+{
+    if (!d->recording.loadAcquire()) return false;
+
+    const quint32 size = ::recordHeaderSize + length;
+    const quint32 head = d->head.load();
+    if (d->mask + 1 - (head - d->tail.loadAcquire()) < size)
+    {
+        d->dropped.ref();
+        return false;
+    }
+
+    const quint16 frameLength = length;
+    d->copyIn(head, &timestamp, sizeof(timestamp));
+    d->copyIn(head + sizeof(timestamp), &frameLength, sizeof(frameLength));
+    d->copyIn(head + ::recordHeaderSize, frame, length);
+
+    d->head.storeRelease(head + size);
+    return true;
+}
+
+quint64 TlogRecorder::recordedFrames() const
+{
+    return d->recorded.load();
+}
+
+quint64 TlogRecorder::droppedFrames() const
+{
+    return d->dropped.load();
+}
+
+quint64 TlogRecorder::currentTimestamp()
+{
+    return quint64(QDateTime::currentMSecsSinceEpoch()) * 1000;
+}
@@ -0,0 +1,40 @@
+#ifndef TLOG_RECORDER_H
+#define TLOG_RECORDER_H
+
+// Qt
+#include <QScopedPointer>
+#include <QString>
+
+namespace comm
+{
+    // Flight data recorder. Communication thread pushes raw frames into a preallocated ring,
+    // writer thread drains it into memory-mapped tlog segments and their time indices.
+    class TlogRecorder
+    {
+    public:
+        explicit TlogRecorder(int bufferSize = 4 * 1024 * 1024,
+                              qint64 segmentSize = 64 * 1024 * 1024);
+        ~TlogRecorder();
+
+        bool start(const QString& directory); // Creates new session directory in it
+        void stop();
+
+        bool isRecording() const;
+        QString sessionPath() const;
+
+        // Never blocks, frame is dropped when writer lags behind by whole buffer
+        bool record(const quint8* frame, int length, quint64 timestamp);
+
+        quint64 recordedFrames() const;
+        quint64 droppedFrames() const;
+
+        static quint64 currentTimestamp(); // Microseconds since epoch
+
+    private:
+        class Impl;
+        QScopedPointer<Impl> const d;
+        Q_DISABLE_COPY(TlogRecorder)
+    };
+}
+
+#endif // TLOG_RECORDER_H
@@ -4,23 +4,40 @@
 // Qt
 #include <QSqlQuery>
 #include <QHash>
+#include <QVector>
+#include <QMetaProperty>
 #include <QSharedPointer>
 
+// Internal
+#include "db_writer.h"
+
 namespace db
 {
+    // Entities are written through the DbWriter when one is running: ids are given in memory,
+    // changes are visible at once and reach the disk behind, reads from disk overlay the rows
+    // the writer has not committed yet.
     template <class T>
     class GenericRepository
     {
     public:
-        GenericRepository(const QString& tableName);
+        // Null writer keeps the repository synchronous, like migrations do
+        GenericRepository(const QString& tableName, DbWriter* writer = DbWriter::instance());
         virtual ~GenericRepository();
 
         QSharedPointer<T> read(int id, bool reload = false);
+        // All rows matching the condition in one query, loaded entities are kept as they are
+        QList<QSharedPointer<T> > load(const QString& condition = QString());
         bool insert(const QSharedPointer<T>& entity);
         bool update(const QSharedPointer<T>& entity);
         bool remove(const QSharedPointer<T>& entity);
 
         bool save(const QSharedPointer<T>& entity);
+
+        // Batches go in one transaction, nothing is changed if any entity fails. Written behind
+        // rows fail in the writer thread only, so these succeed once the rows are enqueued
+        bool saveAll(const QList<QSharedPointer<T> >& entities);
+        bool removeAll(const QList<QSharedPointer<T> >& entities);
+
         bool contains(int id);
         void unload(int id);
         void clear();
@@ -31,16 +48,48 @@ namespace db
         QList< QSharedPointer<T> > loadedEntities() const;
 
     protected:
+        // Table column bound to the property of T
+        class Column
+        {
+        public:
+            QString name;
+            QMetaProperty property;
+        };
+
         bool runQuerry();
-        QStringList propertyNames(const QMetaObject& meta);
+        bool runQuerry(QSqlQuery& query);
+        void prepareQueries();
+
+        bool beginTransaction();
+        bool endTransaction(bool owned, bool succeeded);
 
-        void bindQuery(QSqlQuery& query, const QMetaObject& meta, T* entity);
-        void updateFromQuery(const QSqlQuery& query, const QMetaObject& meta, T* entity);
+        bool insertRow(const QSharedPointer<T>& entity);
+        bool updateRow(const QSharedPointer<T>& entity);
+        bool removeRow(const QSharedPointer<T>& entity);
+
+        int nextId();
+        DbWriter::Row row(const QSharedPointer<T>& entity, bool removed = false) const;
+
+        void bindQuery(QSqlQuery& query, T* entity);
+        void updateFromQuery(const QSqlQuery& query, T* entity);
+        void updateFromRow(const DbWriter::Row& row, T* entity);
+        void writeColumn(int index, const QVariant& value, T* entity);
+
+        QString source(); // Table or the subquery with rows not written yet
 
     private:
         QSqlQuery m_query;
+        QSqlQuery m_insertQuery;
+        QSqlQuery m_updateQuery;
+        QSqlQuery m_readQuery;
+        QSqlQuery m_removeQuery;
+        QSqlQuery m_pendingQuery; // Prepared on the first read with rows not written yet
+
         const QString m_tableName;
+        QVector<Column> m_columns; // Resolved once, in table order
         QStringList m_columnNames;
+        DbWriter* const m_writer;
+        int m_lastId = -1; // Unknown until the first written behind insert
         QHash<int, QSharedPointer<T> > m_map;
     };
 }
@@ -4,18 +4,33 @@
 #include "generic_repository.h"
 
 // Qt
-#include <QMetaProperty>
+#include <QSqlDatabase>
 #include <QSqlError>
+#include <QStringList>
 #include <QDebug>
 
 using namespace db;
 
 template<class T>
-GenericRepository<T>::GenericRepository(const QString& tableName):
-    m_tableName(tableName)
+GenericRepository<T>::GenericRepository(const QString& tableName, DbWriter* writer):
+    m_tableName(tableName),
+    m_writer(writer)
 {
+    // Stored properties, id is handled apart
+    const QMetaObject& meta = T::staticMetaObject;
     m_query.exec("PRAGMA table_info(" + m_tableName + ")");
-    while (m_query.next()) m_columnNames.append(m_query.value(1).toString());
+    while (m_query.next())
+    {
+        QString name = m_query.value(1).toString();
+        int index = meta.indexOfProperty(name.toLatin1().constData());
+        if (index < meta.propertyOffset()) continue;
+
+        m_columns.append({ name, meta.property(index) });
+        m_columnNames.append(name);
+    }
+    m_query.finish();
+
+    this->prepareQueries();
 }
 
 template<class T>
@@ -25,28 +40,10 @@ GenericRepository<T>::~GenericRepository()
 template<class T>
 bool GenericRepository<T>::insert(const QSharedPointer<T>& entity)
 {
-    QStringList names;
-    QStringList values;
-
-    for (const QString& name: this->propertyNames(T::staticMetaObject))
-    {
-        if (!m_columnNames.contains(name)) continue;
-
-        names.append(name);
-        values.append(":" + name);
-    }
-
-    m_query.prepare("INSERT INTO " + m_tableName + " (" +
-                    names.join(", ") + ") VALUES (" + values.join(", ") + ")");
-    this->bindQuery(m_query, T::staticMetaObject, entity.data());
+    if (!this->insertRow(entity)) return false;
 
-    if (this->runQuerry())
-    {
-        entity->setId(m_query.lastInsertId().toInt());
-        m_map[entity->id()] = entity;
-        return true;
-    }
-    return false;
+    m_map[entity->id()] = entity;
+    return true;
 }
 
 template<class T>
@@ -56,40 +53,74 @@ QSharedPointer<T> GenericRepository<T>::read(int id, bool reload)
 
     if (!contains || reload)
     {
-        m_query.prepare("SELECT * FROM " + m_tableName + " WHERE id = :id");
-        m_query.bindValue(":id", id);
+        QSharedPointer<T> entity;
 
-        if (this->runQuerry() && m_query.next())
+        // Row not written yet is newer than the database one
+        DbWriter::Row pending;
+        if (m_writer && m_writer->pendingRow(m_tableName, id, &pending))
         {
-            QSharedPointer<T> entity = contains ? m_map[id] :
-                                                  QSharedPointer<T>::create();
+            if (pending.removed) return entity;
+
+            entity = contains ? m_map[id] : QSharedPointer<T>::create();
             entity->setId(id);
-            this->updateFromQuery(m_query, T::staticMetaObject, entity.data());
+            this->updateFromRow(pending, entity.data());
             m_map[id] = entity;
             return entity;
         }
-        return QSharedPointer<T>();
+
+        m_readQuery.bindValue(0, id);
+        if (this->runQuerry(m_readQuery) && m_readQuery.next())
+        {
+            entity = contains ? m_map[id] : QSharedPointer<T>::create();
+            entity->setId(id);
+            this->updateFromQuery(m_readQuery, entity.data());
+            m_map[id] = entity;
+        }
+        m_readQuery.finish();
+        return entity;
     }
     return m_map[id];
 }
 
 template<class T>
-bool GenericRepository<T>::update(const QSharedPointer<T>& entity)
+QList<QSharedPointer<T> > GenericRepository<T>::load(const QString& condition)
 {
-    QStringList placeholders;
+    QList<QSharedPointer<T> > entities;
+
+    QStringList names({ "id" });
+    for (const Column& column: m_columns) names.append(column.name);
 
-    for (const QString& name: this->propertyNames(T::staticMetaObject))
+    QString string("SELECT " + names.join(", ") + " FROM " + this->source());
+    if (!condition.isEmpty()) string += (" " + condition);
+
+    // Rows are streamed, not cached by the driver
+    m_query.setForwardOnly(true);
+    m_query.prepare(string);
+    if (!this->runQuerry()) return entities;
+
+    while (m_query.next())
     {
-        if (m_columnNames.contains(name)) placeholders.append(name + " = :" + name);
+        int id = m_query.value(0).toInt();
+        QSharedPointer<T> entity = m_map.value(id);
+        if (entity.isNull())
+        {
+            entity = QSharedPointer<T>::create();
+            entity->setId(id);
+            this->updateFromQuery(m_query, entity.data());
+            m_map[id] = entity;
+        }
+        entities.append(entity);
     }
+    m_query.finish();
 
-    m_query.prepare("UPDATE " + m_tableName + " SET " +
-                    placeholders.join(", ") + " WHERE id = :id");
+    return entities;
+}
 
-    m_query.bindValue(":id", entity->id());
-    this->bindQuery(m_query, T::staticMetaObject, entity.data());
+template<class T>
+bool GenericRepository<T>::update(const QSharedPointer<T>& entity)
+{
+    if (!this->updateRow(entity)) return false;
 
-    if (!this->runQuerry()) return false;
     m_map[entity->id()] = entity;
     return true;
 }
@@ -97,9 +128,7 @@ bool GenericRepository<T>::update(const QSharedPointer<T>& entity)
 template<class T>
 bool GenericRepository<T>::remove(const QSharedPointer<T>& entity)
 {
-    m_query.prepare("DELETE FROM " + m_tableName + " WHERE id = :id");
-    m_query.bindValue(":id", entity->id());
-    if (!this->runQuerry()) return false;
+    if (!this->removeRow(entity)) return false;
     this->unload(entity->id());
     // Don't set id to 0, it can be usefull for someone else
     return true;
@@ -119,6 +148,79 @@ bool GenericRepository<T>::save(const QSharedPointer<T>& entity)
     return true;
 }
 
+template<class T>
+bool GenericRepository<T>::saveAll(const QList<QSharedPointer<T> >& entities)
+{
+    if (m_writer)
+    {
+        QList<DbWriter::Row> rows;
+        for (const QSharedPointer<T>& entity: entities)
+        {
+            if (entity->id() <= 0) entity->setId(this->nextId());
+            rows.append(this->row(entity));
+        }
+        m_writer->write(rows);
+
+        for (const QSharedPointer<T>& entity: entities) m_map[entity->id()] = entity;
+        return true;
+    }
+
+    bool owned = this->beginTransaction();
+
+    QList<QSharedPointer<T> > inserted;
+    bool succeeded = true;
+    for (const QSharedPointer<T>& entity: entities)
+    {
+        bool isNew = entity->id() <= 0;
+        if (!(isNew ? this->insertRow(entity) : this->updateRow(entity)))
+        {
+            succeeded = false;
+            break;
+        }
+        if (isNew) inserted.append(entity);
+    }
+
+    if (!this->endTransaction(owned, succeeded))
+    {
+        // Inserted rows are rolled back
+        if (owned) for (const QSharedPointer<T>& entity: inserted) entity->setId(0);
+        return false;
+    }
+
+    for (const QSharedPointer<T>& entity: entities) m_map[entity->id()] = entity;
+    return true;
+}
+
+template<class T>
+bool GenericRepository<T>::removeAll(const QList<QSharedPointer<T> >& entities)
+{
+    if (m_writer)
+    {
+        QList<DbWriter::Row> rows;
+        for (const QSharedPointer<T>& entity: entities) rows.append(this->row(entity, true));
+        m_writer->write(rows);
+
+        for (const QSharedPointer<T>& entity: entities) this->unload(entity->id());
+        return true;
+    }
+
+    bool owned = this->beginTransaction();
+
+    bool succeeded = true;
+    for (const QSharedPointer<T>& entity: entities)
+    {
+        if (this->removeRow(entity)) continue;
+
+        succeeded = false;
+        break;
+    }
+
+    if (!this->endTransaction(owned, succeeded)) return false;
+
+    for (const QSharedPointer<T>& entity: entities) this->unload(entity->id());
+    return true;
+}
+
 template<class T>
 bool GenericRepository<T>::contains(int id)
 {
@@ -142,13 +244,14 @@ QList<int> GenericRepository<T>::selectId(const QString& condition)
 {
     QList<int> idList;
 
-    QString string("SELECT id FROM " + m_tableName);
+    QString string("SELECT id FROM " + this->source());
     if (!condition.isEmpty()) string += (" " + condition);
     m_query.prepare(string);
 
     if (!this->runQuerry()) return idList;
 
-    while (m_query.next()) idList.append(m_query.value("id").toInt());
+    while (m_query.next()) idList.append(m_query.value(0).toInt());
+    m_query.finish();
 
     return idList;
 }
@@ -168,54 +271,232 @@ QList<QSharedPointer<T> > GenericRepository<T>::loadedEntities() const
 template<class T>
 bool GenericRepository<T>::runQuerry()
 {
-    if (m_query.exec()) return true;
+    return this->runQuerry(m_query);
+}
+
+template<class T>
+bool GenericRepository<T>::runQuerry(QSqlQuery& query)
+{
+    if (query.exec()) return true;
 
     // TODO: log with db log level
-    qDebug() << m_query.lastError() << m_query.executedQuery();
+    qDebug() << query.lastError() << query.executedQuery();
     return false;
 }
 
 template<class T>
-QStringList GenericRepository<T>::propertyNames(const QMetaObject& meta)
+void GenericRepository<T>::prepareQueries()
 {
-    QStringList list;
+    // Statements are prepared once and bound by position
+    QStringList names;
+    QStringList placeholders;
+    QStringList assignments;
+    for (const Column& column: m_columns)
+    {
+        names.append(column.name);
+        placeholders.append("?");
+        assignments.append(column.name + " = ?");
+    }
 
-    for (int i = meta.propertyOffset(); i < meta.propertyCount(); ++i)
+    if (m_columns.isEmpty())
+    {
+        m_insertQuery.prepare("INSERT INTO " + m_tableName + " DEFAULT VALUES");
+    }
+    else
     {
-        list.append(meta.property(i).name());
+        m_insertQuery.prepare("INSERT INTO " + m_tableName + " (" + names.join(", ") +
+                              ") VALUES (" + placeholders.join(", ") + ")");
+        m_updateQuery.prepare("UPDATE " + m_tableName + " SET " + assignments.join(", ") +
+                              " WHERE id = ?");
     }
 
-    return list;
+    names.prepend("id");
+    m_readQuery.prepare("SELECT " + names.join(", ") + " FROM " + m_tableName +
+                        " WHERE id = ?");
+    m_removeQuery.prepare("DELETE FROM " + m_tableName + " WHERE id = ?");
+}
+
+template<class T>
+bool GenericRepository<T>::beginTransaction()
+{
+    // Fails inside an outer transaction, which is left to its owner
+    return QSqlDatabase::database().transaction();
+}
+
+template<class T>
+bool GenericRepository<T>::endTransaction(bool owned, bool succeeded)
+{
+    if (!owned) return succeeded;
+
+    QSqlDatabase database = QSqlDatabase::database();
+    if (succeeded && database.commit()) return true;
+
+    if (succeeded) qDebug() << database.lastError();
+    database.rollback();
+    return false;
 }
 
 template<class T>
-void GenericRepository<T>::bindQuery(QSqlQuery& query, const QMetaObject& meta, T* entity)
+bool GenericRepository<T>::insertRow(const QSharedPointer<T>& entity)
 {
-    for (int i = meta.propertyOffset(); i < meta.propertyCount(); ++i)
+    if (m_writer)
     {
-        QString name = meta.property(i).name();
-        if (!m_columnNames.contains(name)) continue;
+        entity->setId(this->nextId());
+        m_writer->write(this->row(entity));
+        return true;
+    }
+
+    this->bindQuery(m_insertQuery, entity.data());
+    if (!this->runQuerry(m_insertQuery)) return false;
+
+    entity->setId(m_insertQuery.lastInsertId().toInt());
+    return true;
+}
+
+template<class T>
+bool GenericRepository<T>::updateRow(const QSharedPointer<T>& entity)
+{
+    // Nothing but id to update
+    if (m_columns.isEmpty()) return true;
 
-        query.bindValue(QString(":") + name, meta.property(i).readOnGadget(entity));
+    if (m_writer)
+    {
+        m_writer->write(this->row(entity));
+        return true;
     }
+
+    this->bindQuery(m_updateQuery, entity.data());
+    m_updateQuery.bindValue(m_columns.count(), entity->id());
+    return this->runQuerry(m_updateQuery);
 }
 
 template<class T>
-void GenericRepository<T>::updateFromQuery(const QSqlQuery& query, const QMetaObject& meta, T* entity)
+bool GenericRepository<T>::removeRow(const QSharedPointer<T>& entity)
 {
-    for (int i = meta.propertyOffset(); i < meta.propertyCount(); ++i)
+    if (m_writer)
     {
-        QString name = meta.property(i).name();
-        if (!m_columnNames.contains(name)) continue;
+        m_writer->write(this->row(entity, true));
+        return true;
+    }
 
-        QVariant value = query.value(meta.property(i).name());
+    m_removeQuery.bindValue(0, entity->id());
+    return this->runQuerry(m_removeQuery);
+}
+
+template<class T>
+int GenericRepository<T>::nextId()
+{
+    // Writer is the only one inserting into the table, so the maximum is read once
+    if (m_lastId < 0)
+    {
+        m_lastId = 0;
+        for (int id: m_writer->pendingRows(m_tableName).keys()) m_lastId = qMax(m_lastId, id);
 
-        // workaround for enums
-        if (!meta.property(i).writeOnGadget(entity, value) && !value.isNull())
+        if (m_query.exec("SELECT MAX(id) FROM " + m_tableName) && m_query.next())
         {
-            meta.property(i).writeOnGadget(entity, value.toInt());
+            m_lastId = qMax(m_lastId, m_query.value(0).toInt());
         }
+        m_query.finish();
     }
+    return ++m_lastId;
+}
+
+template<class T>
+DbWriter::Row GenericRepository<T>::row(const QSharedPointer<T>& entity, bool removed) const
+{
+    // Snapshot, the entity may change before the row is written
+    DbWriter::Row row;
+    row.table = m_tableName;
+    row.id = entity->id();
+    row.removed = removed;
+    if (removed) return row;
+
+    row.columns = m_columnNames;
+    for (const Column& column: m_columns)
+    {
+        row.values.append(column.property.readOnGadget(entity.data()));
+    }
+    return row;
+}
+
+template<class T>
+void GenericRepository<T>::bindQuery(QSqlQuery& query, T* entity)
+{
+    for (int i = 0; i < m_columns.count(); ++i)
+    {
+        query.bindValue(i, m_columns.at(i).property.readOnGadget(entity));
+    }
+}
+
+template<class T>
+void GenericRepository<T>::updateFromQuery(const QSqlQuery& query, T* entity)
+{
+    for (int i = 0; i < m_columns.count(); ++i)
+    {
+        this->writeColumn(i, query.value(i + 1), entity); // After id
+    }
+}
+
+template<class T>
+void GenericRepository<T>::updateFromRow(const DbWriter::Row& row, T* entity)
+{
+    for (int i = 0; i < m_columns.count(); ++i) this->writeColumn(i, row.values.value(i), entity);
+}
+
+template<class T>
+void GenericRepository<T>::writeColumn(int index, const QVariant& value, T* entity)
+{
+    const QMetaProperty& property = m_columns.at(index).property;
+
+    // workaround for enums
+    if (!property.writeOnGadget(entity, value) && !value.isNull())
+    {
+        property.writeOnGadget(entity, value.toInt());
+    }
+}
+
+template<class T>
+QString GenericRepository<T>::source()
+{
+    QHash<int, DbWriter::Row> pending;
+    if (m_writer) pending = m_writer->pendingRows(m_tableName);
+    if (pending.isEmpty()) return m_tableName;
+
+    // Rows not written yet go to a temporary table of this connection and replace the database
+    // ones, so conditions and ordering apply to both
+    QStringList names({ "id" });
+    names.append(m_columnNames);
+    const QString temporary = "pending_" + m_tableName;
+
+    if (m_pendingQuery.lastQuery().isEmpty())
+    {
+        m_query.exec("CREATE TEMP TABLE IF NOT EXISTS " + temporary + " AS SELECT " +
+                     names.join(", ") + " FROM " + m_tableName + " WHERE 0");
+        m_query.finish();
+        m_pendingQuery.prepare("INSERT INTO " + temporary + " (" + names.join(", ") +
+                               ") VALUES (?" + QString(", ?").repeated(m_columns.count()) + ")");
+    }
+    m_query.exec("DELETE FROM " + temporary);
+    m_query.finish();
+
+    QStringList ids;
+    for (const DbWriter::Row& row: pending)
+    {
+        ids.append(QString::number(row.id));
+        if (row.removed) continue;
+
+        m_pendingQuery.bindValue(0, row.id);
+        for (int i = 0; i < row.values.count(); ++i)
+        {
+            m_pendingQuery.bindValue(i + 1, row.values.at(i));
+        }
+        this->runQuerry(m_pendingQuery);
+    }
+    m_pendingQuery.finish();
+
+    return "(SELECT " + names.join(", ") + " FROM " + m_tableName + " WHERE id NOT IN (" +
+            ids.join(", ") + ") UNION ALL SELECT " + names.join(", ") + " FROM " + temporary +
+            ") AS " + m_tableName;
 }
 
 #endif // GENERIC_REPOSITORY_IMPL_H
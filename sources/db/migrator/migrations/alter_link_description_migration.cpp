@@ -25,7 +25,7 @@ bool AlterLinkDescriptionMigration::up()
                          "parameters TEXT,"
                          "autoConnect BOOLEAN)") || !m_query.exec()) return false;
 
-    GenericRepository<dto::LinkDescription> linkRepository("links");
+    GenericRepository<dto::LinkDescription> linkRepository("links", nullptr);
 
     LinkDescriptionPtr defaultUdpLink = LinkDescriptionPtr::create();
     defaultUdpLink->setType(LinkDescription::Udp);
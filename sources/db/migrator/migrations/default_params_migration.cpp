@@ -19,7 +19,7 @@ using namespace db;
 
 bool DefaultParamsMigration::up()
 {
-    GenericRepository<dto::LinkDescription> linkRepository("links");
+    GenericRepository<dto::LinkDescription> linkRepository("links", nullptr);
 
     LinkDescriptionPtr udpLink = LinkDescriptionPtr::create();
     udpLink->setType(LinkDescription::Udp);
@@ -37,7 +37,7 @@ bool DefaultParamsMigration::up()
     serialLink->setAutoConnect(true);
     linkRepository.save(serialLink);
 
-    GenericRepository<dto::Vehicle> vehicleRepository("vehicles");
+    GenericRepository<dto::Vehicle> vehicleRepository("vehicles", nullptr);
 
     VehiclePtr vehicle = VehiclePtr::create();
     vehicle->setMavId(1);
@@ -0,0 +1,388 @@
+#include "db_writer.h"
+
+// Qt
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+// Std
+#include <climits>
+
+using namespace db;
+
+namespace
+{
+    const QString connectionType = "QSQLITE";
+    const QString connectionName = "db_writer";
+    const QString memoryDatabase = ":memory:"; // Not shared between connections
+    const int maxAttempts = 3; // Commits of one batch before it is given up
+    const unsigned long retryDelay = 100; // ms, lets a concurrent lock go
+}
+
+DbWriter* DbWriter::lastCreatedWriter = nullptr;
+
+class DbWriter::Impl
+{
+public:
+    class Writer: public QThread
+    {
+    public:
+        explicit Writer(Impl* impl): impl(impl)
+        {
+            this->setObjectName("Database writer thread");
+        }
+
+    protected:
+        void run() override
+        {
+            impl->writeLoop();
+        }
+
+    private:
+        Impl* const impl;
+    };
+
+    class Pending
+    {
+    public:
+        quint64 sequence; // Of the latest write
+        Row row;
+    };
+
+    using Queue = QMap<quint64, Row>; // By sequence, written in this order
+    using Key = QPair<QString, int>;
+    using Statements = QHash<QString, QSqlQuery>;
+
+    QString databaseName;
+
+    mutable QMutex mutex;
+    QWaitCondition started;
+    QWaitCondition queued;
+    QWaitCondition written;
+
+    Queue queue;
+    QHash<Key, quint64> places; // Sequence of the latest queued write of each row
+    QString runTable; // Of the rows enqueued lately one after another
+    quint64 runStart = 0;
+    QHash<QString, QHash<int, Pending> > unwritten; // Queued or being written rows by table
+    quint64 enqueued = 0;
+    quint64 committed = 0; // Everything enqueued up to it is written or lost
+    quint64 lost = 0; // Batch up to it has failed rows or is given up after failed commits
+    quint64 reported = 0; // Loss already returned by flush
+    bool ready = false;
+    bool running = false;
+    bool stopping = false;
+
+    Writer thread;
+
+    Impl(): thread(this) {}
+
+    void enqueue(const Row& row)
+    {
+        ++enqueued;
+        unwritten[row.table].insert(row.id, { enqueued, row });
+
+        if (row.table != runTable)
+        {
+            runTable = row.table;
+            runStart = enqueued;
+        }
+
+        // Rows of one table don't reference each other, so the write is coalesced with a queued
+        // one unless rows of other tables went between them and may reference or be referenced
+        Key key(row.table, row.id);
+        auto it = places.constFind(key);
+        if (it != places.constEnd() && it.value() >= runStart)
+        {
+            queue[it.value()] = row;
+            return;
+        }
+
+        places.insert(key, enqueued);
+        queue.insert(enqueued, row);
+    }
+
+    void writeLoop()
+    {
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase(::connectionType,
+                                                              ::connectionName);
+            database.setDatabaseName(databaseName);
+
+            bool ok = database.open();
+            if (ok)
+            {
+                // WAL lets the main connection read while batches are committed
+                QSqlQuery pragma(database);
+                pragma.exec("PRAGMA foreign_keys = ON");
+                pragma.exec("PRAGMA journal_mode = WAL");
+            }
+            else
+            {
+                qWarning() << "Database writer can't open" << databaseName
+                           << database.lastError();
+            }
+
+            mutex.lock();
+            ready = true;
+            running = ok;
+            started.wakeAll();
+            mutex.unlock();
+
+            if (ok) this->drainLoop(database);
+            database.close();
+        }
+        QSqlDatabase::removeDatabase(::connectionName);
+    }
+
+    void drainLoop(QSqlDatabase& database)
+    {
+        Statements statements;
+        int attempts = 0;
+
+        forever
+        {
+            Queue batch;
+            quint64 target;
+            {
+                QMutexLocker locker(&mutex);
+                while (queue.isEmpty() && !stopping) queued.wait(&mutex);
+                if (queue.isEmpty()) return;
+
+                batch.swap(queue);
+                places.clear();
+                target = enqueued;
+            }
+
+            // Failed row is logged and skipped, the rest of the batch still goes
+            int failed = 0;
+            bool owned = database.transaction();
+            for (const Row& row: batch)
+            {
+                if (!this->execute(database, statements, row)) ++failed;
+            }
+
+            if (owned && !database.commit())
+            {
+                qWarning() << "Database writer can't commit" << database.lastError();
+                database.rollback();
+
+                if (++attempts < ::maxAttempts)
+                {
+                    this->requeue(batch);
+                    QThread::msleep(::retryDelay);
+                    continue;
+                }
+
+                qWarning() << "Database writer batch is lost," << batch.count() << "rows";
+                failed = batch.count();
+            }
+            else if (failed > 0)
+            {
+                qWarning() << "Database writer lost" << failed << "rows of the batch";
+            }
+            attempts = 0;
+
+            mutex.lock();
+            if (failed > 0) lost = target;
+            committed = target;
+            this->forget(target);
+            written.wakeAll();
+            mutex.unlock();
+        }
+    }
+
+    void forget(quint64 target)
+    {
+        // Written and lost rows are read from the database again
+        for (auto table = unwritten.begin(); table != unwritten.end();)
+        {
+            for (auto it = table->begin(); it != table->end();)
+            {
+                if (it->sequence <= target) it = table->erase(it);
+                else ++it;
+            }
+
+            if (table->isEmpty()) table = unwritten.erase(table);
+            else ++table;
+        }
+    }
+
+    void requeue(const Queue& batch)
+    {
+        QMutexLocker locker(&mutex);
+
+        // Failed rows go before the ones written meanwhile, newer snapshots land over them
+        for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+        {
+            queue.insert(it.key(), it.value());
+        }
+    }
+
+    bool execute(QSqlDatabase& database, Statements& statements, const Row& row)
+    {
+        if (row.removed)
+        {
+            QSqlQuery& query = this->statement(database, statements, "DELETE FROM " +
+                                               row.table + " WHERE id = ?");
+            query.bindValue(0, row.id);
+            return this->run(query);
+        }
+
+        // Update of existing row, insert with the id given by repository otherwise
+        if (!row.columns.isEmpty())
+        {
+            QSqlQuery& query = this->statement(database, statements, "UPDATE " + row.table +
+                                               " SET " + row.columns.join(" = ?, ") +
+                                               " = ? WHERE id = ?");
+            for (int i = 0; i < row.values.count(); ++i) query.bindValue(i, row.values.at(i));
+            query.bindValue(row.values.count(), row.id);
+
+            if (!this->run(query)) return false;
+            if (query.numRowsAffected() > 0) return true;
+        }
+
+        QStringList names = row.columns;
+        names.prepend("id");
+        QSqlQuery& query = this->statement(database, statements, "INSERT INTO " + row.table +
+                                           " (" + names.join(", ") + ") VALUES (?" +
+                                           QString(", ?").repeated(row.columns.count()) + ")");
+        query.bindValue(0, row.id);
+        for (int i = 0; i < row.values.count(); ++i) query.bindValue(i + 1, row.values.at(i));
+        return this->run(query);
+    }
+
+    QSqlQuery& statement(QSqlDatabase& database, Statements& statements, const QString& text)
+    {
+        auto it = statements.find(text);
+        if (it != statements.end()) return *it;
+
+        it = statements.insert(text, QSqlQuery(database));
+        it->prepare(text);
+        return *it;
+    }
+
+    bool run(QSqlQuery& query)
+    {
+        bool ok = query.exec();
+        if (!ok) qWarning() << query.lastError() << query.lastQuery();
+        query.finish();
+        return ok;
+    }
+};
+
+DbWriter::DbWriter():
+    d(new Impl())
+{
+    d->databaseName = QSqlDatabase::database().databaseName();
+    if (d->databaseName.isEmpty() || d->databaseName == ::memoryDatabase) return;
+
+    d->thread.start();
+
+    QMutexLocker locker(&d->mutex);
+    while (!d->ready) d->started.wait(&d->mutex);
+
+    if (d->running) DbWriter::lastCreatedWriter = this;
+}
+
+DbWriter::~DbWriter()
+{
+    if (DbWriter::lastCreatedWriter == this) DbWriter::lastCreatedWriter = nullptr;
+
+    d->mutex.lock();
+    d->stopping = true;
+    d->queued.wakeAll();
+    d->mutex.unlock();
+
+    d->thread.wait();
+}
+
+DbWriter* DbWriter::instance()
+{
+    return DbWriter::lastCreatedWriter;
+}
+
+bool DbWriter::isRunning() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->running;
+}
+
+int DbWriter::pending() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->queue.count();
+}
+
+QHash<int, DbWriter::Row> DbWriter::pendingRows(const QString& table) const
+{
+    QHash<int, Row> rows;
+
+    QMutexLocker locker(&d->mutex);
+    const QHash<int, Impl::Pending> pending = d->unwritten.value(table);
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it)
+    {
+        rows.insert(it.key(), it->row);
+    }
+    return rows;
+}
+
+bool DbWriter::pendingRow(const QString& table, int id, Row* row) const
+{
+    QMutexLocker locker(&d->mutex);
+    auto rows = d->unwritten.constFind(table);
+    if (rows == d->unwritten.constEnd()) return false;
+
+    auto it = rows->constFind(id);
+    if (it == rows->constEnd()) return false;
+
+    *row = it->row;
+    return true;
+}
+
+void DbWriter::write(const Row& row)
+{
+    QMutexLocker locker(&d->mutex);
+    d->enqueue(row);
+    d->queued.wakeOne();
+}
+
+void DbWriter::write(const QList<Row>& rows)
+{
+    if (rows.isEmpty()) return;
+
+    // One lock keeps the rows in one batch
+    QMutexLocker locker(&d->mutex);
+    for (const Row& row: rows) d->enqueue(row);
+    d->queued.wakeOne();
+}
+
+bool DbWriter::flush(int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&d->mutex);
+    const quint64 target = d->enqueued;
+    while (d->committed < target && d->running)
+    {
+        unsigned long left = ULONG_MAX;
+        if (timeout >= 0) left = qMax<qint64>(0, timeout - timer.elapsed());
+
+        if (!d->written.wait(&d->mutex, left) && timeout >= 0) break;
+    }
+
+    if (d->committed < target) return false;
+    if (d->lost <= d->reported) return true;
+
+    d->reported = d->lost;
+    return false;
+}
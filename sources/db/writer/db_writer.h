@@ -0,0 +1,62 @@
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+// Qt
+#include <QScopedPointer>
+#include <QHash>
+#include <QStringList>
+#include <QVariantList>
+
+namespace db
+{
+    // Write-behind persistence thread with its own connection to the database file. Rows are
+    // snapshots taken on enqueue and written in that order, pending writes of the same row are
+    // coalesced until a row of another table goes between them. Every drained batch is
+    // committed in one transaction.
+    class DbWriter
+    {
+    public:
+        class Row
+        {
+        public:
+            QString table;
+            int id = 0;
+            bool removed = false;
+            QStringList columns; // Without id
+            QVariantList values;
+        };
+
+        // Database of the default connection, which must be open
+        DbWriter();
+        ~DbWriter(); // Flushes pending rows
+
+        static DbWriter* instance(); // Null if there is no running writer
+
+        bool isRunning() const;
+        int pending() const;
+
+        // Latest writes of the table's rows not committed yet, readers overlay them on the
+        // database instead of waiting for a flush
+        QHash<int, Row> pendingRows(const QString& table) const;
+        bool pendingRow(const QString& table, int id, Row* row) const;
+
+        // Never blocks on disk, rows reach it in the order of enqueuing
+        void write(const Row& row);
+        void write(const QList<Row>& rows);
+
+        // Barrier, waits until everything enqueued before is committed. False on timeout or if
+        // a row or a batch was lost since the previous flush, failed commit is retried a few
+        // times first
+        bool flush(int timeout = -1);
+
+    private:
+        class Impl;
+        QScopedPointer<Impl> const d;
+
+        static DbWriter* lastCreatedWriter;
+
+        Q_DISABLE_COPY(DbWriter)
+    };
+}
+
+#endif // DB_WRITER_H
@@ -17,7 +17,9 @@
 
 #include "description_link_factory.h"
 #include "mavlink_communicator_factory.h"
+#include "mavlink_communicator.h"
 #include "communicator_worker.h"
+#include "tlog_recorder.h"
 
 #include "notification_bus.h"
 
@@ -33,6 +35,7 @@ public:
     QThread* commThread;
     CommunicatorWorker* commWorker;
     comm::MavLinkCommunicator* communicator = nullptr;
+    QScopedPointer<comm::TlogRecorder> recorder;
 
     GenericRepository<dto::LinkDescription> linkRepository;
 
@@ -42,7 +45,7 @@ public:
 
     void loadDescriptions(const QString& condition = QString())
     {
-        for (int id: linkRepository.selectId(condition)) linkRepository.read(id);
+        linkRepository.load(condition);
     }
 
     dto::LinkStatisticsPtr getlinkStatistics(int linkId)
@@ -170,6 +173,17 @@ void CommunicationService::init()
                 settings::Provider::boolValue(settings::communication::retranslationEnabled));
 
     d->communicator = commFactory.create();
+
+    if (settings::Provider::boolValue(settings::communication::tlogEnabled))
+    {
+        d->recorder.reset(new comm::TlogRecorder());
+        if (d->recorder->start(settings::Provider::value(
+                                   settings::communication::tlogDirectory).toString()))
+        {
+            d->communicator->setRecorder(d->recorder.data());
+        }
+    }
+
     d->communicator->moveToThread(d->commThread);
     d->commWorker->setCommunicator(d->communicator);
 
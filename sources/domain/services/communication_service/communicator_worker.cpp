@@ -2,11 +2,14 @@
 
 // Qt
 #include <QTimerEvent>
+#include <QTimer>
 #include <QTime>
 #include <QThread>
 #include <QDebug>
 
 // Internal
+#include "settings_provider.h"
+
 #include "link_description.h"
 
 #include "abstract_communicator.h"
@@ -25,6 +28,14 @@ namespace
         case comm::AbstractCommunicator::Unknown: return dto::LinkDescription::UnknownProtocol;
         }
     }
+
+    // Links may live on their own threads, everything but sending goes through their loop
+    template<typename Call>
+    void inLinkThread(comm::AbstractLink* link, Call call)
+    {
+        if (link->thread() == QThread::currentThread()) call();
+        else QTimer::singleShot(0, link, call);
+    }
 }
 
 using namespace comm;
@@ -35,8 +46,33 @@ class CommunicatorWorker::Impl
 public:
     comm::AbstractCommunicator* communicator = nullptr;
     QMap<int, comm::AbstractLink*> descriptedLinks;
+    QList<QThread*> linkThreads; // Links read and parse there, handlers stay in worker
 
     int statisticsTimer = 0;
+
+    QThread* leastLoadedThread() const
+    {
+        QThread* result = nullptr;
+        int minLinks = 0;
+        for (QThread* thread: linkThreads)
+        {
+            int links = 0;
+            for (comm::AbstractLink* link: descriptedLinks) links += link->thread() == thread;
+
+            if (!result || links < minLinks)
+            {
+                result = thread;
+                minLinks = links;
+            }
+        }
+        return result;
+    }
+
+    void deleteLink(comm::AbstractLink* link)
+    {
+        if (link->thread() == QThread::currentThread()) delete link;
+        else link->deleteLater(); // Or when its thread finishes
+    }
 };
 
 CommunicatorWorker::CommunicatorWorker(QObject* parent):
@@ -53,10 +89,33 @@ CommunicatorWorker::CommunicatorWorker(QObject* parent):
             this, &CommunicatorWorker::setLinkConnectedImpl);
 
     d->statisticsTimer = this->startTimer(::second);
+
+    int linkThreads = settings::Provider::value(settings::communication::linkThreads).toInt();
+    for (int i = 0; i < linkThreads; ++i)
+    {
+        QThread* thread = new QThread();
+        thread->setObjectName(QString("Link thread %1").arg(i + 1));
+        thread->start();
+        d->linkThreads.append(thread);
+    }
 }
 
 CommunicatorWorker::~CommunicatorWorker()
-{}
+{
+    for (AbstractLink* link: d->descriptedLinks.values())
+    {
+        if (d->communicator) d->communicator->removeLink(link);
+        d->deleteLink(link);
+    }
+    d->descriptedLinks.clear();
+
+    for (QThread* thread: d->linkThreads)
+    {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+}
 
 void CommunicatorWorker::onMavLinkStatisticsChanged(AbstractLink* link,
                                                     int packetsReceived,
@@ -119,18 +178,24 @@ void CommunicatorWorker::updateLinkImpl(int linkId,
     if (d->descriptedLinks.contains(linkId))
     {
         link = d->descriptedLinks[linkId];
-        factory->update(link);
+        ::inLinkThread(link, [link, factory]() { factory->update(link); });
     }
     else
     {
         link = factory->create();
         if (!link) return;
 
-        link->setParent(this);
+        QThread* thread = d->leastLoadedThread();
+        if (thread) link->moveToThread(thread);
+        else link->setParent(this);
+
+        // Activity signals only notify, no need to pass them through worker loop
         connect(link, &AbstractLink::connectedChanged, this, [this, linkId](bool connected) {
             emit linkStatusChanged(linkId, connected); });
-        connect(link, &AbstractLink::dataReceived, this, [this, linkId]() { emit linkRecv(linkId); });
-        connect(link, &AbstractLink::dataSent, this, [this, linkId]() { emit linkSent(linkId); });
+        connect(link, &AbstractLink::received, this, [this, linkId]() {
+            emit linkRecv(linkId); }, Qt::DirectConnection);
+        connect(link, &AbstractLink::dataSent, this, [this, linkId]() {
+            emit linkSent(linkId); }, Qt::DirectConnection);
         connect(link, &AbstractLink::errored, this,
                 [this, linkId](const QString& error) { emit linkErrored(linkId, error); });
 
@@ -139,8 +204,10 @@ void CommunicatorWorker::updateLinkImpl(int linkId,
 
         if (autoconnect)
         {
-            link->connectLink();
-            emit linkStatusChanged(linkId, link->isConnected());
+            ::inLinkThread(link, [this, link, linkId]() {
+                link->connectLink();
+                emit linkStatusChanged(linkId, link->isConnected());
+            });
         }
     }
 }
@@ -152,14 +219,14 @@ void CommunicatorWorker::removeLinkImpl(int linkId)
         AbstractLink* link = d->descriptedLinks.take(linkId);
 
         if (d->communicator) d->communicator->removeLink(link);
-        delete link;
+        d->deleteLink(link);
     }
 }
 
 void CommunicatorWorker::setLinkConnectedImpl(int linkId, bool connected)
 {
-    AbstractLink* link = d->descriptedLinks[linkId];
-    if (link) link->setConnected(connected);
+    AbstractLink* link = d->descriptedLinks.value(linkId);
+    if (link) ::inLinkThread(link, [link, connected]() { link->setConnected(connected); });
 }
 
 void CommunicatorWorker::timerEvent(QTimerEvent* event)
@@ -2,7 +2,11 @@
 
 // Qt
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 #include <QMutexLocker>
+#include <QThread>
 #include <QGeoCoordinate>
 
 // Internal
@@ -14,6 +18,9 @@
 
 #include "generic_repository.h"
 
+// Std
+#include <algorithm>
+
 using namespace dto;
 using namespace domain;
 
@@ -28,6 +35,11 @@ public:
 
     QMap <int, MissionItemPtr> currentItems;
 
+    // Loaded items of each mission ordered by sequence, so dense sequences are list positions
+    QHash<int, MissionItemPtrList> missionItems;
+    QHash<int, int> itemMissions; // Mission of indexed item by item id
+    QSet<int> loadedMissions; // With all the items loaded
+
     Impl():
         mutex(QMutex::Recursive),
         missionRepository("missions"),
@@ -35,19 +47,102 @@ public:
         assignmentRepository("mission_assignments")
     {}
 
-    void loadMissions(const QString& condition = QString())
+    // Returns missions loaded now
+    QList<int> loadMissionItems(const QList<int>& missionIds)
     {
-        for (int id: missionRepository.selectId(condition)) missionRepository.read(id);
+        QList<int> loaded;
+        QStringList ids;
+        for (int missionId: missionIds)
+        {
+            if (loadedMissions.contains(missionId)) continue;
+
+            loadedMissions.insert(missionId);
+            loaded.append(missionId);
+            ids.append(QString::number(missionId));
+        }
+        if (loaded.isEmpty()) return loaded;
+
+        // Ordered rows are appended to the index
+        for (const MissionItemPtr& item: itemRepository.load(
+                 "WHERE missionId IN (" + ids.join(", ") + ") ORDER BY missionId, sequence"))
+        {
+            this->indexItem(item);
+        }
+        return loaded;
     }
 
-    void loadMissionItems(const QString& condition = QString())
+    // Other threads, like the communication one, never wait for the database: they get what is
+    // indexed now and the load is queued to the service's thread
+    void requireItems(MissionService* service, int missionId)
     {
-        for (int id: itemRepository.selectId(condition)) itemRepository.read(id);
+        if (loadedMissions.contains(missionId)) return;
+
+        if (QThread::currentThread() == service->thread())
+        {
+            service->loadMissionItems({ missionId });
+        }
+        else
+        {
+            QMetaObject::invokeMethod(service, "loadMissionItems", Qt::QueuedConnection,
+                                      Q_ARG(QList<int>, QList<int>({ missionId })));
+        }
+    }
+
+    static bool precedes(const MissionItemPtr& first, const MissionItemPtr& second)
+    {
+        return first->sequence() < second->sequence();
     }
 
-    void loadMissionAssignments(const QString& condition = QString())
+    static int itemPosition(const MissionItemPtrList& items, const MissionItemPtr& item)
     {
-        for (int id: assignmentRepository.selectId(condition)) assignmentRepository.read(id);
+        // Sequence is usually actual or just shifted by one
+        for (int position: { item->sequence(), item->sequence() - 1, item->sequence() + 1 })
+        {
+            if (position >= 0 && position < items.count() && items.at(position) == item)
+            {
+                return position;
+            }
+        }
+        return items.indexOf(item);
+    }
+
+    void indexItem(const MissionItemPtr& item)
+    {
+        auto indexed = itemMissions.constFind(item->id());
+        if (indexed != itemMissions.constEnd() && indexed.value() != item->missionId())
+        {
+            this->unindexItem(item);
+        }
+
+        MissionItemPtrList& items = missionItems[item->missionId()];
+        int position = Impl::itemPosition(items, item);
+        if (position > -1)
+        {
+            // Items are resequenced one by one, in place while the order holds
+            if ((position == 0 || items.at(position - 1)->sequence() <= item->sequence()) &&
+                (position == items.count() - 1 ||
+                 items.at(position + 1)->sequence() >= item->sequence())) return;
+
+            items.removeAt(position);
+        }
+
+        items.insert(std::upper_bound(items.begin(), items.end(), item, Impl::precedes), item);
+        itemMissions[item->id()] = item->missionId();
+    }
+
+    void unindexItem(const MissionItemPtr& item)
+    {
+        auto indexed = itemMissions.find(item->id());
+        if (indexed == itemMissions.end()) return;
+
+        auto items = missionItems.find(indexed.value());
+        if (items != missionItems.end())
+        {
+            int position = Impl::itemPosition(items.value(), item);
+            if (position > -1) items->removeAt(position);
+            if (items->isEmpty()) missionItems.erase(items);
+        }
+        itemMissions.erase(indexed);
     }
 };
 
@@ -58,10 +153,18 @@ MissionService::MissionService(QObject* parent):
     qRegisterMetaType<dto::MissionPtr>("dto::MissionPtr");
     qRegisterMetaType<dto::MissionItemPtr>("dto::MissionItemPtr");
     qRegisterMetaType<dto::MissionAssignmentPtr>("dto::MissionAssignmentPtr");
+    qRegisterMetaType<QList<int> >("QList<int>");
 
-    d->loadMissions();
-    d->loadMissionItems();
-    d->loadMissionAssignments();
+    d->missionRepository.load();
+
+    // Items of the other missions are loaded when they are opened, assigned ones are kept loaded
+    // for the communication
+    QList<int> assigned;
+    for (const MissionAssignmentPtr& assignment: d->assignmentRepository.load())
+    {
+        assigned.append(assignment->missionId());
+    }
+    this->loadMissionItems(assigned);
 }
 
 MissionService::~MissionService()
@@ -79,8 +182,11 @@ MissionItemPtr MissionService::missionItem(int id) const
 {
     QMutexLocker locker(&d->mutex);
 
-    if (id) return d->itemRepository.read(id);
-    return MissionItemPtr();
+    if (!id) return MissionItemPtr();
+
+    MissionItemPtr item = d->itemRepository.read(id);
+    if (item && !d->itemMissions.contains(id)) d->indexItem(item);
+    return item;
 }
 
 MissionAssignmentPtr MissionService::assignment(int id) const
@@ -177,15 +283,16 @@ dto::MissionItemPtr MissionService::addNewMissionItem(int missionId,
         item->setLongitude(coordinate.longitude());
     }
 
-    // TODO: querry by sequence
+    dto::MissionItemPtrList shifted;
     for (const dto::MissionItemPtr& other: this->missionItems(missionId))
     {
         if (other->sequence() < sequence) continue;
 
         other->setSequence(other->sequence() + 1);
         other->setStatus(dto::MissionItem::NotActual);
-        this->save(other);
+        shifted.append(other);
     }
+    if (!shifted.isEmpty()) this->save(shifted);
 
     if (!this->save(item)) return dto::MissionItemPtr();
 
@@ -234,26 +341,35 @@ MissionAssignmentPtr MissionService::vehicleAssignment(int vehicleId) const
     return MissionAssignmentPtr();
 }
 
-MissionItemPtrList MissionService::missionItems(int missionId) const
+MissionItemPtrList MissionService::missionItems(int missionId)
 {
     QMutexLocker locker(&d->mutex);
 
-    QMap<int, MissionItemPtr> items;
-    for (const MissionItemPtr& item: d->itemRepository.loadedEntities())
-    {
-        if (item->missionId() == missionId) items[item->sequence()] = item;
-    }
-    return items.values();
+    d->requireItems(this, missionId);
+    return d->missionItems.value(missionId);
 }
 
-MissionItemPtr MissionService::missionItem(int missionId, int sequence) const
+MissionItemPtr MissionService::missionItem(int missionId, int sequence)
 {
     QMutexLocker locker(&d->mutex);
 
-    for (const MissionItemPtr& item: d->itemRepository.loadedEntities())
+    d->requireItems(this, missionId);
+
+    auto it = d->missionItems.constFind(missionId);
+    if (it == d->missionItems.constEnd() || sequence < 0) return MissionItemPtr();
+
+    const MissionItemPtrList& items = it.value();
+    if (sequence < items.count() && items.at(sequence)->sequence() == sequence)
     {
-        if (item->missionId() == missionId && item->sequence() == sequence) return item;
+        return items.at(sequence);
     }
+
+    // Sequence gaps, look for it by order
+    auto found = std::lower_bound(items.constBegin(), items.constEnd(), sequence,
+                                  [](const MissionItemPtr& item, int sequence) {
+        return item->sequence() < sequence;
+    });
+    if (found != items.constEnd() && (*found)->sequence() == sequence) return *found;
     return MissionItemPtr();
 }
 
@@ -266,6 +382,7 @@ bool MissionService::save(const MissionPtr& mission)
 
     if (isNew)
     {
+        d->loadedMissions.insert(mission->id()); // Nothing to load yet
         settings::Provider::setValue(settings::mission::mission + QString::number(mission->id()) +
                                      "/" + settings::visibility, true);
         emit missionAdded(mission);
@@ -286,12 +403,43 @@ bool MissionService::save(const MissionItemPtr& item)
     item->clearSuperfluousParameters();
     if (!d->itemRepository.save(item)) return false;
 
+    d->indexItem(item);
     emit (isNew ? missionItemAdded(item) : missionItemChanged(item));
     if (isNew) this->fixMissionItemCount(item->missionId());
 
     return true;
 }
 
+bool MissionService::save(const MissionItemPtrList& items)
+{
+    QMutexLocker locker(&d->mutex);
+
+    QList<bool> isNew;
+    for (const MissionItemPtr& item: items)
+    {
+        isNew.append(item->id() == 0);
+        item->clearSuperfluousParameters();
+    }
+
+    if (!d->itemRepository.saveAll(items)) return false;
+
+    // Indexed all at once, so shifted sequences keep their order
+    for (const MissionItemPtr& item: items) d->indexItem(item);
+
+    QList<int> grownMissions;
+    for (int i = 0; i < items.count(); ++i)
+    {
+        emit (isNew.at(i) ? missionItemAdded(items.at(i)) : missionItemChanged(items.at(i)));
+        if (isNew.at(i) && !grownMissions.contains(items.at(i)->missionId()))
+        {
+            grownMissions.append(items.at(i)->missionId());
+        }
+    }
+
+    for (int missionId: grownMissions) this->fixMissionItemCount(missionId);
+    return true;
+}
+
 bool MissionService::save(const MissionAssignmentPtr& assignment)
 {
     QMutexLocker locker(&d->mutex);
@@ -299,6 +447,8 @@ bool MissionService::save(const MissionAssignmentPtr& assignment)
     bool isNew = assignment->id() == 0;
     if (!d->assignmentRepository.save(assignment)) return false;
 
+    d->requireItems(this, assignment->missionId());
+
     emit (isNew ? assignmentAdded(assignment) : assignmentChanged(assignment));
     return true;
 }
@@ -310,12 +460,11 @@ bool MissionService::remove(const MissionPtr& mission)
     MissionAssignmentPtr assignment = this->missionAssignment(mission->id());
     if (assignment && !this->remove(assignment)) return false;
 
-    for (const MissionItemPtr& item: this->missionItems(mission->id()))
-    {
-        if (!this->remove(item)) return false;
-    }
+    MissionItemPtrList items = this->missionItems(mission->id());
+    if (!items.isEmpty() && !this->remove(items)) return false;
 
     if (!d->missionRepository.remove(mission)) return false;
+    d->loadedMissions.remove(mission->id());
 
     settings::Provider::remove(settings::mission::mission + QString::number(mission->id()));
 
@@ -330,11 +479,31 @@ bool MissionService::remove(const MissionItemPtr& item)
     // TODO: remove from current
     if (!d->itemRepository.remove(item)) return false;
 
+    d->unindexItem(item);
+
     this->fixMissionItemOrder(item->missionId());
     emit missionItemRemoved(item);
     return true;
 }
 
+bool MissionService::remove(const MissionItemPtrList& items)
+{
+    QMutexLocker locker(&d->mutex);
+
+    if (!d->itemRepository.removeAll(items)) return false;
+
+    QList<int> missions;
+    for (const MissionItemPtr& item: items)
+    {
+        d->unindexItem(item);
+        if (!missions.contains(item->missionId())) missions.append(item->missionId());
+    }
+
+    for (int missionId: missions) this->fixMissionItemOrder(missionId);
+    for (const MissionItemPtr& item: items) emit missionItemRemoved(item);
+    return true;
+}
+
 bool MissionService::remove(const MissionAssignmentPtr& assignment)
 {
     QMutexLocker locker(&d->mutex);
@@ -364,13 +533,19 @@ void MissionService::unload(const MissionPtr& mission)
     QMutexLocker locker(&d->mutex);
 
     d->missionRepository.unload(mission->id());
+    d->loadedMissions.remove(mission->id());
 }
 
 void MissionService::unload(const MissionItemPtr& item)
 {
     QMutexLocker locker(&d->mutex);
 
+    d->unindexItem(item);
     d->itemRepository.unload(item->id());
+    d->loadedMissions.remove(item->missionId()); // Reloaded with the next request
+
+    // Assigned mission is wanted by the communication, reloaded ahead
+    if (this->missionAssignment(item->missionId())) d->requireItems(this, item->missionId());
 }
 
 void MissionService::unload(const MissionAssignmentPtr& assignment)
@@ -380,21 +555,30 @@ void MissionService::unload(const MissionAssignmentPtr& assignment)
     d->assignmentRepository.unload(assignment->id());
 }
 
+void MissionService::loadMissionItems(const QList<int>& missionIds)
+{
+    QMutexLocker locker(&d->mutex);
+
+    for (int missionId: d->loadMissionItems(missionIds)) emit missionItemsLoaded(missionId);
+}
+
 void MissionService::fixMissionItemOrder(int missionId)
 {
     QMutexLocker locker(&d->mutex);
 
     int counter = 0;
+    MissionItemPtrList changed;
     for (const MissionItemPtr& item : this->missionItems(missionId))
     {
         if (item->sequence() != counter)
         {
             item->setSequence(counter);
             item->setStatus(MissionItem::NotActual);
-            this->save(item);
+            changed.append(item);
         }
         counter++;
     }
+    if (!changed.isEmpty()) this->save(changed);
 
     this->fixMissionItemCount(missionId);
 }
@@ -480,10 +664,15 @@ void MissionService::swapItems(const MissionItemPtr& first, const MissionItemPtr
     int seq = first->sequence();
     first->setSequence(second->sequence());
     second->setSequence(seq);
+    first->setStatus(MissionItem::NotActual);
+    second->setStatus(MissionItem::NotActual);
 
     if (!d->itemRepository.save(first)) return;
     if (!d->itemRepository.save(second)) return;
 
+    d->indexItem(first);
+    d->indexItem(second);
+
     emit missionItemChanged(first);
     emit missionItemChanged(second);
 }
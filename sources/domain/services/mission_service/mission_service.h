@@ -25,11 +25,13 @@ namespace domain
         dto::MissionAssignmentPtr missionAssignment(int missionId) const;
         dto::MissionAssignmentPtr vehicleAssignment(int vehicleId) const;
 
-        dto::MissionItemPtrList missionItems(int missionId) const;
-        dto::MissionItemPtr missionItem(int missionId, int sequence) const;
+        // Items of the mission are loaded with the first request, requests from other threads
+        // get the loaded items only and queue the load. Assigned missions are kept loaded
+        dto::MissionItemPtrList missionItems(int missionId);
+        dto::MissionItemPtr missionItem(int missionId, int sequence);
 
         dto::MissionPtrList missions() const;
-        dto::MissionItemPtrList missionItems() const;
+        dto::MissionItemPtrList missionItems() const; // Loaded ones only
         dto::MissionAssignmentPtrList missionAssignments() const;
 
         dto::MissionItemPtr currentWaypoint(int vehicleId) const;
@@ -44,12 +46,16 @@ namespace domain
         bool save(const dto::MissionPtr& mission);
         bool save(const dto::MissionItemPtr& item);
         bool save(const dto::MissionAssignmentPtr& assignment);
+        bool save(const dto::MissionItemPtrList& items); // In one transaction
 
         bool remove(const dto::MissionPtr& mission);
         bool remove(const dto::MissionItemPtr& item);
         bool remove(const dto::MissionAssignmentPtr& assignment);
+        bool remove(const dto::MissionItemPtrList& items);
 
 public slots:
+        void loadMissionItems(const QList<int>& missionIds); // Not loaded ones, in one query
+
         void unload(const dto::MissionPtr& mission);
         void unload(const dto::MissionItemPtr& item);
         void unload(const dto::MissionAssignmentPtr& assignment);
@@ -73,6 +79,7 @@ public slots:
         void missionItemAdded(dto::MissionItemPtr item);
         void missionItemRemoved(dto::MissionItemPtr item);
         void missionItemChanged(dto::MissionItemPtr item);
+        void missionItemsLoaded(int missionId);
         void currentItemChanged(int vehicleId,
                                 dto::MissionItemPtr oldOne,
                                 dto::MissionItemPtr newOne);
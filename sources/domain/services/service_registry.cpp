@@ -4,6 +4,7 @@
 #include <QDebug>
 
 // Internal
+#include "db_writer.h"
 #include "mission_service.h"
 #include "vehicle_service.h"
 #include "telemetry_service.h"
@@ -20,6 +21,7 @@ ServiceRegistry* ServiceRegistry::lastCreatedRegistry = nullptr;
 class ServiceRegistry::Impl
 {
 public:
+    db::DbWriter writer; // First, services' repositories pick it up and it outlives them
     MissionService missionService;
     VehicleService vehicleService;
     TelemetryService telemetryService;
@@ -0,0 +1,384 @@
+#include "telemetry_archive.h"
+
+// Qt
+#include <QThread>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QHash>
+#include <QAtomicInteger>
+#include <QtNumeric>
+#include <QDebug>
+
+// Std
+#include <algorithm>
+#include <limits>
+
+// Internal
+#include "telemetry_archive_format.h"
+
+using namespace domain;
+
+namespace
+{
+    const int idleInterval = 5; // ms, writer sleeps when ring is empty
+    const qint64 flushInterval = 5000; // ms, chunks reach the file at least that often
+
+    quint32 roundUpToPowerOfTwo(int value)
+    {
+        quint32 result = 1;
+        while (result < quint32(value)) result <<= 1;
+        return result;
+    }
+}
+
+class TelemetryArchive::Impl
+{
+public:
+    class Writer: public QThread
+    {
+    public:
+        explicit Writer(Impl* impl): impl(impl)
+        {
+            this->setObjectName("Telemetry archive thread");
+        }
+
+    protected:
+        void run() override
+        {
+            impl->writeLoop();
+        }
+
+    private:
+        Impl* const impl;
+    };
+
+    class Sample
+    {
+    public:
+        quint64 key;
+        qint64 time;
+        double value;
+    };
+
+    // Column chunk of one series level, written as a block when full
+    class Chunk
+    {
+    public:
+        QByteArray columns[4];
+        qint64 previous[4];
+        quint32 count = 0;
+        qint64 firstTime = 0;
+        qint64 lastTime = 0;
+
+        void append(qint64 time, const qint64* values, int valueCount)
+        {
+            if (!count)
+            {
+                firstTime = lastTime = time;
+                for (int i = 1; i <= valueCount; ++i) previous[i] = 0;
+            }
+
+            archive::writeVarint(quint64(time - lastTime), columns[0]);
+            for (int i = 1; i <= valueCount; ++i)
+            {
+                archive::writeVarint(archive::zigzag(values[i - 1] - previous[i]), columns[i]);
+                previous[i] = values[i - 1];
+            }
+
+            lastTime = time;
+            count++;
+        }
+    };
+
+    class Bucket
+    {
+    public:
+        qint64 start = 0;
+        double min = 0;
+        double max = 0;
+        double sum = 0;
+        int count = 0;
+    };
+
+    class Series
+    {
+    public:
+        Chunk chunks[archive::levels];
+        Bucket buckets[archive::levels]; // Open bucket of each pyramid level, raw one unused
+        qint64 lastTime = std::numeric_limits<qint64>::min();
+    };
+
+    QVector<Sample> buffer;
+    Sample* const data; // Detached once, accessed from both threads
+    const quint32 mask;
+    const quint32 chunkSamples;
+
+    QAtomicInteger<quint32> head; // Published by producer
+    QAtomicInteger<quint32> tail; // Released by writer
+    QAtomicInteger<quint64> recorded;
+    QAtomicInteger<quint64> dropped;
+    QAtomicInt recording;
+    QAtomicInt stopRequested;
+
+    QFile file;
+    Writer writer;
+
+    // Writer thread state
+    QHash<quint64, Series*> series;
+    QByteArray block;
+    bool failed = false;
+
+    Impl(int bufferSamples, int chunkSamples):
+        buffer(::roundUpToPowerOfTwo(qMax(bufferSamples, 2))),
+        data(buffer.data()),
+        mask(buffer.count() - 1),
+        chunkSamples(qMax(chunkSamples, 1)),
+        writer(this)
+    {}
+
+    void writeLoop()
+    {
+        QElapsedTimer flushTimer;
+        flushTimer.start();
+
+        while (!stopRequested.loadAcquire())
+        {
+            if (!this->drain()) QThread::msleep(::idleInterval);
+
+            if (flushTimer.elapsed() < ::flushInterval) continue;
+
+            this->flushChunks();
+            flushTimer.restart();
+        }
+
+        this->drain();
+
+        // Last buckets are partial, but the flight is over
+        for (auto it = series.constBegin(); it != series.constEnd(); ++it)
+        {
+            for (int level = 1; level < archive::levels; ++level)
+            {
+                if (!it.value()->buckets[level].count) continue;
+
+                this->closeBucket(it.key(), it.value(), level);
+            }
+        }
+        this->flushChunks();
+
+        qDeleteAll(series);
+        series.clear();
+        file.close();
+    }
+
+    bool drain()
+    {
+        quint32 position = tail.load();
+        const quint32 end = head.loadAcquire();
+        if (position == end) return false;
+
+        while (position != end)
+        {
+            const Sample& sample = data[position & mask];
+            this->process(sample.key, sample.time, sample.value);
+
+            tail.storeRelease(++position);
+        }
+
+        return true;
+    }
+
+    void process(quint64 key, qint64 time, double value)
+    {
+        Series*& entry = series[key];
+        if (!entry) entry = new Series();
+
+        // Columns and pyramid need time order
+        time = qMax(time, entry->lastTime);
+        entry->lastTime = time;
+
+        qint64 fixed = archive::toFixed(value);
+        this->append(key, entry, 0, time, &fixed);
+
+        for (int level = 1; level < archive::levels; ++level)
+        {
+            Bucket& bucket = entry->buckets[level];
+            qint64 interval = archive::levelInterval(level);
+            qint64 start = time - time % interval;
+
+            if (bucket.count && bucket.start != start) this->closeBucket(key, entry, level);
+            if (!bucket.count)
+            {
+                bucket.start = start;
+                bucket.min = value;
+                bucket.max = value;
+                bucket.sum = 0;
+            }
+
+            bucket.min = qMin(bucket.min, value);
+            bucket.max = qMax(bucket.max, value);
+            bucket.sum += value;
+            bucket.count++;
+        }
+
+        recorded.ref();
+    }
+
+    void closeBucket(quint64 key, Series* entry, int level)
+    {
+        Bucket& bucket = entry->buckets[level];
+        const qint64 values[3] = { archive::toFixed(bucket.min), archive::toFixed(bucket.max),
+                                   archive::toFixed(bucket.sum / bucket.count) };
+
+        this->append(key, entry, level, bucket.start, values);
+        bucket.count = 0;
+    }
+
+    void append(quint64 key, Series* entry, int level, qint64 time, const qint64* values)
+    {
+        Chunk& chunk = entry->chunks[level];
+        chunk.append(time, values, archive::columnCount(level) - 1);
+
+        if (chunk.count >= chunkSamples) this->writeBlock(key, level, chunk);
+    }
+
+    void writeBlock(quint64 key, int level, Chunk& chunk)
+    {
+        archive::BlockHeader header;
+        header.level = level;
+        header.key = key;
+        header.count = chunk.count;
+        header.firstTime = chunk.firstTime;
+        header.lastTime = chunk.lastTime;
+
+        const int columns = archive::columnCount(level);
+        for (int i = 0; i < columns; ++i) header.size += chunk.columns[i].size();
+
+        block.resize(archive::blockHeaderSize);
+        archive::writeBlockHeader(header, reinterpret_cast<uchar*>(block.data()));
+        for (int i = 0; i < columns; ++i)
+        {
+            block.append(chunk.columns[i]);
+            chunk.columns[i].clear();
+        }
+        chunk.count = 0;
+
+        if (failed) return;
+
+        if (file.write(block) != block.size())
+        {
+            qWarning() << "Can't write telemetry archive" << file.fileName() << file.errorString();
+            failed = true;
+        }
+    }
+
+    void flushChunks()
+    {
+        for (auto it = series.constBegin(); it != series.constEnd(); ++it)
+        {
+            for (int level = 0; level < archive::levels; ++level)
+            {
+                Chunk& chunk = it.value()->chunks[level];
+                if (chunk.count) this->writeBlock(it.key(), level, chunk);
+            }
+        }
+
+        file.flush();
+    }
+};
+
+TelemetryArchive::TelemetryArchive(int bufferSamples, int chunkSamples):
+    d(new Impl(bufferSamples, chunkSamples))
+{}
+
+TelemetryArchive::~TelemetryArchive()
+{
+    this->stop();
+}
+
+bool TelemetryArchive::start(const QString& directory)
+{
+    if (this->isRecording()) return false;
+
+    QDir dir(directory);
+    if (!dir.mkpath("."))
+    {
+        qWarning() << "Can't create telemetry archive directory" << directory;
+        return false;
+    }
+
+    QString name = QDateTime::currentDateTime().toString("yyyy.MM.dd-hh.mm.ss");
+    d->file.setFileName(dir.absoluteFilePath(name + archive::fileSuffix));
+    if (!d->file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Can't create telemetry archive" << d->file.fileName()
+                   << d->file.errorString();
+        return false;
+    }
+
+    uchar header[archive::fileHeaderSize];
+    std::copy(archive::magic.constBegin(), archive::magic.constEnd(), header);
+    qToLittleEndian<quint32>(archive::version, header + 4);
+    d->file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    d->head.store(0);
+    d->tail.store(0);
+    d->failed = false;
+
+    d->stopRequested.storeRelease(0);
+    d->writer.start();
+    d->recording.storeRelease(1);
+
+    return true;
+}
+
+void TelemetryArchive::stop()
+{
+    if (!this->isRecording()) return;
+
+    d->recording.storeRelease(0);
+    d->stopRequested.storeRelease(1);
+    d->writer.wait();
+}
+
+bool TelemetryArchive::isRecording() const
+{
+    return d->recording.loadAcquire();
+}
+
+QString TelemetryArchive::filePath() const
+{
+    return d->file.fileName();
+}
+
+bool TelemetryArchive::record(quint64 key, qint64 time, double value)
+{
+    if (!d->recording.loadAcquire() || !qIsFinite(value)) return false;
+
+    const quint32 head = d->head.load();
+    if (head - d->tail.loadAcquire() > d->mask)
+    {
+        d->dropped.ref();
+        return false;
+    }
+
+    Impl::Sample& sample = d->data[head & d->mask];
+    sample.key = key;
+    sample.time = time;
+    sample.value = value;
+
+    d->head.storeRelease(head + 1);
+    return true;
+}
+
+quint64 TelemetryArchive::recordedSamples() const
+{
+    return d->recorded.load();
+}
+
+quint64 TelemetryArchive::droppedSamples() const
+{
+    return d->dropped.load();
+}
@@ -0,0 +1,39 @@
+#ifndef TELEMETRY_ARCHIVE_H
+#define TELEMETRY_ARCHIVE_H
+
+// Qt
+#include <QScopedPointer>
+#include <QString>
+
+namespace domain
+{
+    // Persistent telemetry store. GUI thread pushes decoded samples into a preallocated ring,
+    // writer thread encodes them into column chunks of a flight file and builds the min/max/mean
+    // pyramid of every series on the way.
+    class TelemetryArchive
+    {
+    public:
+        explicit TelemetryArchive(int bufferSamples = 65536, int chunkSamples = 4096);
+        ~TelemetryArchive();
+
+        bool start(const QString& directory); // Creates new flight file in it
+        void stop();
+
+        bool isRecording() const;
+        QString filePath() const;
+
+        // Never blocks, sample is dropped when writer lags behind by whole buffer. Key is
+        // archive::seriesKey, single producer.
+        bool record(quint64 key, qint64 time, double value);
+
+        quint64 recordedSamples() const;
+        quint64 droppedSamples() const;
+
+    private:
+        class Impl;
+        QScopedPointer<Impl> const d;
+        Q_DISABLE_COPY(TelemetryArchive)
+    };
+}
+
+#endif // TELEMETRY_ARCHIVE_H
@@ -0,0 +1,145 @@
+#ifndef TELEMETRY_ARCHIVE_FORMAT_H
+#define TELEMETRY_ARCHIVE_FORMAT_H
+
+// Qt
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+#include <QtMath>
+#include <QtNumeric>
+
+// Internal
+#include "telemetry.h"
+
+// Flight file is a header followed by blocks, appended by the writer thread. Each block is one
+// column chunk of one series: raw samples (level 0) or buckets of a pyramid level. Level 1
+// buckets span baseInterval, each next level is levelFactor times wider. Block payload holds
+// columns one after another: times as varint deltas from the previous time (the first one from
+// header's firstTime), then values as zigzag varint deltas of fixed-point numbers. Raw blocks
+// have one value column, bucket blocks have min, max and mean columns. Truncated tail block is
+// ignored by the reader.
+
+namespace domain
+{
+    namespace archive
+    {
+        const QByteArray magic = "JTLA";
+        const quint32 version = 1;
+        const QString fileSuffix = ".jtla";
+
+        const int fileHeaderSize = 8; // Magic, little-endian version
+        const int blockHeaderSize = 40;
+
+        const int levels = 5; // Raw and four pyramid levels
+        const qint64 baseInterval = 1000; // ms
+        const qint64 levelFactor = 10;
+        const double valueScale = 1e7; // Fixed-point resolution, 1 cm of a coordinate degree
+        const double fixedLimit = 4.6e18; // Below 2^62, so deltas of two values fit qint64 too
+
+        // Little-endian on disk
+        class BlockHeader
+        {
+        public:
+            quint32 size = 0; // Payload
+            quint8 level = 0;
+            quint64 key = 0;
+            quint32 count = 0;
+            qint64 firstTime = 0; // ms since epoch
+            qint64 lastTime = 0;
+        };
+
+        inline qint64 levelInterval(int level)
+        {
+            qint64 interval = level ? baseInterval : 0;
+            for (int i = 1; i < level; ++i) interval *= levelFactor;
+            return interval;
+        }
+
+        inline int columnCount(int level)
+        {
+            return level ? 4 : 2;
+        }
+
+        // Vehicle, slots of node and parameter, component of vector and coordinate values
+        inline quint64 seriesKey(int vehicleId, Telemetry::TelemetryId node,
+                                 Telemetry::TelemetryId parameter, int component = 0)
+        {
+            return (quint64(quint32(vehicleId)) << 24) |
+                    (quint64(quint8(Telemetry::slot(node))) << 16) |
+                    (quint64(quint8(Telemetry::slot(parameter))) << 8) | quint8(component);
+        }
+
+        inline void writeBlockHeader(const BlockHeader& header, uchar* data)
+        {
+            qToLittleEndian<quint32>(header.size, data);
+            data[4] = header.level;
+            data[5] = data[6] = data[7] = 0;
+            qToLittleEndian<quint64>(header.key, data + 8);
+            qToLittleEndian<quint32>(header.count, data + 16);
+            qToLittleEndian<quint32>(0, data + 20);
+            qToLittleEndian<qint64>(header.firstTime, data + 24);
+            qToLittleEndian<qint64>(header.lastTime, data + 32);
+        }
+
+        inline BlockHeader readBlockHeader(const uchar* data)
+        {
+            BlockHeader header;
+            header.size = qFromLittleEndian<quint32>(data);
+            header.level = data[4];
+            header.key = qFromLittleEndian<quint64>(data + 8);
+            header.count = qFromLittleEndian<quint32>(data + 16);
+            header.firstTime = qFromLittleEndian<qint64>(data + 24);
+            header.lastTime = qFromLittleEndian<qint64>(data + 32);
+            return header;
+        }
+
+        // Values beyond about 4.6e11 are clamped, NaN is stored as zero
+        inline qint64 toFixed(double value)
+        {
+            double scaled = value * valueScale;
+            if (qIsNaN(scaled)) return 0;
+
+            return qRound64(qBound(-fixedLimit, scaled, fixedLimit));
+        }
+
+        inline double fromFixed(qint64 value)
+        {
+            return value / valueScale;
+        }
+
+        inline quint64 zigzag(qint64 value)
+        {
+            return (quint64(value) << 1) ^ quint64(value >> 63);
+        }
+
+        inline qint64 unzigzag(quint64 value)
+        {
+            return qint64(value >> 1) ^ -qint64(value & 1);
+        }
+
+        inline void writeVarint(quint64 value, QByteArray& data)
+        {
+            while (value >= 0x80)
+            {
+                data.append(char(value | 0x80));
+                value >>= 7;
+            }
+            data.append(char(value));
+        }
+
+        // False on truncated data
+        inline bool readVarint(const uchar*& data, const uchar* end, quint64& value)
+        {
+            value = 0;
+            for (int shift = 0; data < end && shift < 64; shift += 7)
+            {
+                quint8 byte = *data++;
+                value |= quint64(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+    }
+}
+
+#endif // TELEMETRY_ARCHIVE_FORMAT_H
@@ -0,0 +1,248 @@
+#include "telemetry_archive_reader.h"
+
+// Qt
+#include <QFile>
+#include <QHash>
+#include <QDebug>
+
+// Std
+#include <algorithm>
+#include <limits>
+
+// Internal
+#include "telemetry_archive_format.h"
+
+using namespace domain;
+
+class TelemetryArchiveReader::Impl
+{
+public:
+    class Block
+    {
+    public:
+        qint64 firstTime;
+        qint64 lastTime;
+        qint64 offset; // Of payload
+        quint32 size;
+        quint32 count;
+    };
+
+    class Series
+    {
+    public:
+        QVector<Block> levels[archive::levels]; // Time ordered, as written
+    };
+
+    QFile file;
+    const uchar* data = nullptr;
+    qint64 size = 0;
+
+    QHash<quint64, Series> series;
+    qint64 startTime = 0;
+    qint64 endTime = 0;
+
+    void index()
+    {
+        startTime = std::numeric_limits<qint64>::max();
+        endTime = std::numeric_limits<qint64>::min();
+
+        qint64 offset = archive::fileHeaderSize;
+        while (offset + archive::blockHeaderSize <= size)
+        {
+            archive::BlockHeader header = archive::readBlockHeader(data + offset);
+            offset += archive::blockHeaderSize;
+
+            // Truncated or broken tail, writer was interrupted. Every value takes a byte at least,
+            // so a count the payload can't hold is broken too and would oversize the decoding
+            if (header.level >= archive::levels || offset + header.size > size ||
+                quint64(header.count) * archive::columnCount(header.level) > header.size) break;
+
+            series[header.key].levels[header.level].append(
+            { header.firstTime, header.lastTime, offset, header.size, header.count });
+            offset += header.size;
+
+            if (header.level) continue;
+
+            startTime = qMin(startTime, header.firstTime);
+            endTime = qMax(endTime, header.lastTime);
+        }
+
+        if (startTime > endTime) startTime = endTime = 0;
+    }
+
+    bool decode(const Block& block, int level, qint64 from, qint64 to,
+                QVector<Bucket>& result) const
+    {
+        const uchar* position = data + block.offset;
+        const uchar* end = position + block.size;
+
+        const int first = result.count();
+        result.resize(first + block.count);
+        Bucket* buckets = result.data() + first;
+
+        quint64 raw;
+        qint64 time = block.firstTime;
+        for (quint32 i = 0; i < block.count; ++i)
+        {
+            if (!archive::readVarint(position, end, raw))
+            {
+                result.resize(first); // No half decoded buckets
+                return false;
+            }
+
+            time += raw;
+            buckets[i].time = time;
+        }
+
+        for (int column = 1; column < archive::columnCount(level); ++column)
+        {
+            qint64 fixed = 0;
+            for (quint32 i = 0; i < block.count; ++i)
+            {
+                if (!archive::readVarint(position, end, raw))
+                {
+                    result.resize(first);
+                    return false;
+                }
+
+                fixed += archive::unzigzag(raw);
+                double value = archive::fromFixed(fixed);
+
+                if (column == 1) buckets[i].min = buckets[i].max = buckets[i].mean = value;
+                else if (column == 2) buckets[i].max = value;
+                else buckets[i].mean = value;
+            }
+        }
+
+        // Bucket is in range when it covers any part of it
+        const qint64 reach = qMax<qint64>(archive::levelInterval(level) - 1, 0);
+        Bucket* last = std::remove_if(buckets, buckets + block.count,
+                                      [from, to, reach](const Bucket& bucket) {
+            return bucket.time + reach < from || bucket.time > to;
+        });
+        result.resize(first + (last - buckets));
+        return true;
+    }
+};
+
+TelemetryArchiveReader::TelemetryArchiveReader():
+    d(new Impl())
+{}
+
+TelemetryArchiveReader::~TelemetryArchiveReader()
+{
+    this->close();
+}
+
+bool TelemetryArchiveReader::open(const QString& path)
+{
+    this->close();
+
+    d->file.setFileName(path);
+    if (!d->file.open(QIODevice::ReadOnly) || d->file.size() < archive::fileHeaderSize ||
+        !(d->data = d->file.map(0, d->file.size())))
+    {
+        qWarning() << "Can't map telemetry archive" << path << d->file.errorString();
+        d->file.close();
+        return false;
+    }
+
+    if (QByteArray::fromRawData(reinterpret_cast<const char*>(d->data),
+                                archive::magic.size()) != archive::magic ||
+        qFromLittleEndian<quint32>(d->data + 4) != archive::version)
+    {
+        qWarning() << "Not a telemetry archive" << path;
+        this->close();
+        return false;
+    }
+
+    d->size = d->file.size();
+    d->index();
+    return true;
+}
+
+void TelemetryArchiveReader::close()
+{
+    if (d->data) d->file.unmap(const_cast<uchar*>(d->data));
+    d->file.close();
+
+    d->data = nullptr;
+    d->size = 0;
+    d->series.clear();
+    d->startTime = 0;
+    d->endTime = 0;
+}
+
+bool TelemetryArchiveReader::isOpen() const
+{
+    return d->data;
+}
+
+qint64 TelemetryArchiveReader::startTime() const
+{
+    return d->startTime;
+}
+
+qint64 TelemetryArchiveReader::endTime() const
+{
+    return d->endTime;
+}
+
+QList<quint64> TelemetryArchiveReader::keys() const
+{
+    return d->series.keys();
+}
+
+int TelemetryArchiveReader::level(quint64 key, qint64 from, qint64 to, int maxPoints) const
+{
+    auto it = d->series.constFind(key);
+    if (it == d->series.constEnd()) return 0;
+
+    // Raw samples are counted by whole blocks, buckets by their width
+    qint64 samples = 0;
+    for (const Impl::Block& block: it->levels[0])
+    {
+        if (block.lastTime >= from && block.firstTime <= to) samples += block.count;
+    }
+    if (samples <= maxPoints) return 0;
+
+    for (int level = 1; level < archive::levels; ++level)
+    {
+        if ((to - from) / archive::levelInterval(level) + 1 <= maxPoints) return level;
+    }
+
+    return archive::levels - 1;
+}
+
+QVector<TelemetryArchiveReader::Bucket> TelemetryArchiveReader::query(quint64 key, qint64 from,
+                                                                       qint64 to,
+                                                                       int maxPoints) const
+{
+    return this->buckets(key, from, to, this->level(key, from, to, maxPoints));
+}
+
+QVector<TelemetryArchiveReader::Bucket> TelemetryArchiveReader::buckets(quint64 key, qint64 from,
+                                                                         qint64 to,
+                                                                         int level) const
+{
+    QVector<Bucket> result;
+
+    auto it = d->series.constFind(key);
+    if (it == d->series.constEnd() || level < 0 || level >= archive::levels) return result;
+
+    const QVector<Impl::Block>& blocks = it->levels[level];
+    const qint64 reach = qMax<qint64>(archive::levelInterval(level) - 1, 0);
+
+    // First block reaching the range
+    auto block = std::lower_bound(blocks.constBegin(), blocks.constEnd(), from,
+                                  [reach](const Impl::Block& block, qint64 time) {
+        return block.lastTime + reach < time;
+    });
+
+    for (; block != blocks.constEnd() && block->firstTime <= to; ++block)
+    {
+        if (!d->decode(*block, level, from, to, result)) break;
+    }
+
+    return result;
+}
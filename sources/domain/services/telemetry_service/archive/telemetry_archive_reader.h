@@ -0,0 +1,50 @@
+#ifndef TELEMETRY_ARCHIVE_READER_H
+#define TELEMETRY_ARCHIVE_READER_H
+
+// Qt
+#include <QScopedPointer>
+#include <QString>
+#include <QList>
+#include <QVector>
+
+namespace domain
+{
+    // Memory-mapped reader of a telemetry archive flight file. Block index is built on open,
+    // queries decode only blocks of the coarsest sufficient level in the requested range.
+    class TelemetryArchiveReader
+    {
+    public:
+        class Bucket
+        {
+        public:
+            qint64 time = 0; // Sample time or bucket start, ms since epoch
+            double min = 0;
+            double max = 0;
+            double mean = 0; // Raw samples have all three equal
+        };
+
+        TelemetryArchiveReader();
+        ~TelemetryArchiveReader();
+
+        bool open(const QString& path);
+        void close();
+        bool isOpen() const;
+
+        qint64 startTime() const;
+        qint64 endTime() const;
+        QList<quint64> keys() const; // archive::seriesKey of recorded series
+
+        // Level with at most maxPoints buckets in the range, 0 means raw samples
+        int level(quint64 key, qint64 from, qint64 to, int maxPoints) const;
+
+        QVector<Bucket> query(quint64 key, qint64 from, qint64 to, int maxPoints) const;
+        QVector<Bucket> buckets(quint64 key, qint64 from, qint64 to, int level) const;
+
+    private:
+        class Impl;
+        QScopedPointer<Impl> const d;
+        Q_DISABLE_COPY(TelemetryArchiveReader)
+    };
+}
+
+#endif // TELEMETRY_ARCHIVE_READER_H
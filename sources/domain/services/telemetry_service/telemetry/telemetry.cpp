@@ -1,14 +1,232 @@
 #include "telemetry.h"
 
 // Qt
+#include <QMetaEnum>
+#include <QDateTime>
 #include <QDebug>
 
+// Internal
+#include "telemetry_queue.h"
+#include "telemetry_history.h"
+
 using namespace domain;
 
+namespace
+{
+    const int queueCapacity = 512;
+
+    // Dense slot numbering built once from moc-generated TelemetryId metadata
+    class SlotTable
+    {
+    public:
+        QVector<int> slotById;
+        QVector<Telemetry::TelemetryId> idBySlot;
+
+        SlotTable()
+        {
+            QMetaEnum metaEnum = QMetaEnum::fromType<Telemetry::TelemetryId>();
+
+            int maxId = 0;
+            for (int i = 0; i < metaEnum.keyCount(); ++i) maxId = qMax(maxId, metaEnum.value(i));
+
+            slotById.fill(-1, maxId + 1);
+            for (int i = 0; i < metaEnum.keyCount(); ++i)
+            {
+                slotById[metaEnum.value(i)] = idBySlot.count();
+                idBySlot.append(static_cast<Telemetry::TelemetryId>(metaEnum.value(i)));
+            }
+
+            Q_ASSERT(idBySlot.count() <= Telemetry::maxSlots);
+        }
+    };
+
+    const SlotTable& slotTable()
+    {
+        static const SlotTable table;
+        return table;
+    }
+
+    bool isReal(int type)
+    {
+        return type == QMetaType::Double || type == QMetaType::Float;
+    }
+}
+
+Telemetry::SlotValues::SlotValues(int count):
+    m_numbers(count),
+    m_types(count, QMetaType::UnknownType)
+{}
+
+QVariant Telemetry::SlotValues::value(int slot) const
+{
+    const Number& number = m_numbers.at(slot);
+    switch (m_types.at(slot))
+    {
+    case QMetaType::UnknownType:
+        return QVariant();
+    case QMetaType::Bool:
+        return QVariant(bool(number.integer));
+    case QMetaType::Int:
+        return QVariant(int(number.integer));
+    case QMetaType::UInt:
+        return QVariant(uint(number.integer));
+    case QMetaType::LongLong:
+        return QVariant(qlonglong(number.integer));
+    case QMetaType::ULongLong:
+        return QVariant(qulonglong(number.integer));
+    case QMetaType::Float:
+        return QVariant(float(number.real));
+    case QMetaType::Double:
+        return QVariant(number.real);
+    default:
+        return m_variants.at(slot);
+    }
+}
+
+bool Telemetry::SlotValues::set(int slot, const QVariant& value)
+{
+    // Scalars are read in place, no conversions and no variant comparison
+    const int type = value.userType();
+    const void* data = value.constData();
+    Number number;
+    switch (type)
+    {
+    case QMetaType::Bool:
+        number.integer = *static_cast<const bool*>(data);
+        break;
+    case QMetaType::Int:
+        number.integer = *static_cast<const int*>(data);
+        break;
+    case QMetaType::UInt:
+        number.integer = *static_cast<const uint*>(data);
+        break;
+    case QMetaType::LongLong:
+        number.integer = *static_cast<const qlonglong*>(data);
+        break;
+    case QMetaType::ULongLong:
+        number.integer = qint64(*static_cast<const qulonglong*>(data));
+        break;
+    case QMetaType::Float:
+        number.real = *static_cast<const float*>(data);
+        break;
+    case QMetaType::Double:
+        number.real = *static_cast<const double*>(data);
+        break;
+    default:
+        return this->setVariant(slot, type, value);
+    }
+
+    const int oldType = m_types.at(slot);
+    if (oldType == type)
+    {
+        const Number& old = m_numbers.at(slot);
+        if (::isReal(type) ? old.real == number.real : old.integer == number.integer)
+        {
+            return false;
+        }
+    }
+    else if (!m_variants.isEmpty() && m_variants.at(slot).isValid())
+    {
+        m_variants[slot] = QVariant(); // Drop the value of another kind
+    }
+
+    m_numbers[slot] = number;
+    if (oldType != type) m_types[slot] = type;
+    return true;
+}
+
+bool Telemetry::SlotValues::setVariant(int slot, int type, const QVariant& value)
+{
+    if (m_variants.isEmpty())
+    {
+        if (type == QMetaType::UnknownType && m_types.at(slot) == type) return false;
+
+        m_variants.resize(m_types.count());
+    }
+    else if (m_types.at(slot) == type && m_variants.at(slot) == value)
+    {
+        return false;
+    }
+
+    m_variants[slot] = value;
+    if (m_types.at(slot) != type) m_types[slot] = type;
+    return true;
+}
+
+Telemetry::TelemetryMap::TelemetryMap()
+{}
+
+Telemetry::TelemetryMap::TelemetryMap(const SlotValues& values, const SlotMask& mask):
+    m_values(values),
+    m_mask(mask)
+{}
+
+bool Telemetry::TelemetryMap::contains(TelemetryId id) const
+{
+    int slot = Telemetry::slot(id);
+    return slot > -1 && m_mask.test(slot);
+}
+
+QVariant Telemetry::TelemetryMap::value(TelemetryId id, const QVariant& defaultValue) const
+{
+    int slot = Telemetry::slot(id);
+    if (slot < 0 || !m_mask.test(slot)) return defaultValue;
+
+    return m_values.value(slot);
+}
+
+QVariant Telemetry::TelemetryMap::operator[](TelemetryId id) const
+{
+    return this->value(id);
+}
+
+int Telemetry::TelemetryMap::count() const
+{
+    return m_mask.count();
+}
+
+bool Telemetry::TelemetryMap::isEmpty() const
+{
+    return m_mask.none();
+}
+
+Telemetry::TelemetryList Telemetry::TelemetryMap::keys() const
+{
+    TelemetryList keys;
+    for (int slot = 0; slot < Telemetry::slotCount(); ++slot)
+    {
+        if (m_mask.test(slot)) keys.append(Telemetry::slotId(slot));
+    }
+    return keys;
+}
+
+Telemetry::SlotMask Telemetry::TelemetryMap::mask() const
+{
+    return m_mask;
+}
+
+int Telemetry::slotCount()
+{
+    return ::slotTable().idBySlot.count();
+}
+
+int Telemetry::slot(TelemetryId id)
+{
+    const QVector<int>& slotById = ::slotTable().slotById;
+    return id >= 0 && id < slotById.count() ? slotById.at(id) : -1;
+}
+
+Telemetry::TelemetryId Telemetry::slotId(int slot)
+{
+    return ::slotTable().idBySlot.at(slot);
+}
+
 Telemetry::Telemetry(TelemetryId id, Telemetry* parentNode):
     QObject(parentNode),
     m_id(id),
-    m_parentNode(parentNode)
+    m_values(Telemetry::slotCount()),
+    m_parentNode(parentNode),
+    m_queue(parentNode ? nullptr : new TelemetryQueue(::queueCapacity))
 {
     if (parentNode) parentNode->addChildNode(this);
 }
@@ -16,6 +234,8 @@ Telemetry::Telemetry(TelemetryId id, Telemetry* parentNode):
 Telemetry::~Telemetry()
 {
     if (m_parentNode) m_parentNode->removeChildNode(this);
+
+    delete m_queue;
 }
 
 Telemetry::TelemetryId Telemetry::id() const
@@ -25,29 +245,26 @@ Telemetry::TelemetryId Telemetry::id() const
 
 QVariant Telemetry::parameter(TelemetryId id) const
 {
-    return m_parameters.value(id);
+    int slot = Telemetry::slot(id);
+    if (slot < 0 || !m_present.test(slot)) return QVariant();
+
+    return m_values.value(slot);
 }
 
 Telemetry::TelemetryMap Telemetry::parameters() const
 {
-    return m_parameters;
+    return TelemetryMap(m_values, m_present);
 }
 
 QList<Telemetry::TelemetryId> Telemetry::changedParameterKeys() const
 {
-    return m_changedParameters;
+    return TelemetryMap(m_values, m_changed).keys();
 }
 
 Telemetry::TelemetryMap Telemetry::takeChangedParameters()
 {
-    QMap<TelemetryId, QVariant> parameters;
-
-    while (!m_changedParameters.isEmpty())
-    {
-        TelemetryId key = m_changedParameters.takeFirst();
-        parameters[key] = m_parameters[key];
-    }
-
+    TelemetryMap parameters(m_values, m_changed);
+    m_changed.reset();
     return parameters;
 }
 
@@ -58,12 +275,15 @@ Telemetry* Telemetry::parentNode() const
 
 Telemetry* Telemetry::childNode(TelemetryId id)
 {
-    if (!m_childNodes.contains(id))
+    int slot = Telemetry::slot(id);
+    if (slot < 0) return nullptr;
+
+    if (m_childNodes.isEmpty() || !m_childNodes.at(slot))
     {
         new Telemetry(id, this);
     }
 
-    return m_childNodes.value(id, nullptr);
+    return m_childNodes.at(slot);
 }
 
 Telemetry* Telemetry::childNode(const TelemetryList& path)
@@ -81,15 +301,36 @@ Telemetry* Telemetry::childNode(const TelemetryList& path)
 
 QList<Telemetry*> Telemetry::childNodes() const
 {
-    return m_childNodes.values();
+    QList<Telemetry*> childNodes;
+    for (Telemetry* childNode: m_childNodes)
+    {
+        if (childNode) childNodes.append(childNode);
+    }
+    return childNodes;
+}
+
+TelemetryQueue* Telemetry::queue() const
+{
+    return m_queue;
+}
+
+void Telemetry::setHistory(TelemetryHistory* history, int vehicleId)
+{
+    if (!m_queue) return;
+
+    m_history = history;
+    m_historyId = vehicleId;
 }
 
 void Telemetry::setParameter(TelemetryId key, const QVariant& value)
 {
-    if (m_parameters.contains(key) && m_parameters[key] == value) return;
+    int slot = Telemetry::slot(key);
+    if (slot < 0) return;
 
-    m_parameters[key] = value;
-    m_changedParameters.append(key);
+    if (!m_values.set(slot, value) && m_present.test(slot)) return;
+
+    m_present.set(slot);
+    m_changed.set(slot);
 }
 
 void Telemetry::setParameter(const TelemetryList& path, const QVariant& value)
@@ -111,19 +352,52 @@ void Telemetry::notify()
         child->notify();
     }
 
-    if (m_changedParameters.empty()) return;
+    if (m_changed.none()) return;
 
     emit parametersChanged(this->takeChangedParameters());
     emit parametersUpdated(this->parameters());
 }
 
+int Telemetry::processQueue()
+{
+    if (!m_queue) return 0;
+
+    int count = 0;
+    qint64 time = 0;
+    TelemetryQueue::Update update;
+    while (m_queue->take(update))
+    {
+        Telemetry* node = this;
+        for (int i = 0; i < update.depth - 1; ++i) node = node->childNode(update.path[i]);
+
+        TelemetryId id = update.path[update.depth - 1];
+        node->setParameter(id, update.value);
+        count++;
+
+        if (!m_history) continue;
+
+        if (!time) time = QDateTime::currentMSecsSinceEpoch(); // Once per processing
+        m_history->append(m_historyId, node->id(), id, time, update.value);
+    }
+
+    if (count) this->notify();
+    return count;
+}
+
 void Telemetry::addChildNode(Telemetry* childNode)
 {
-    m_childNodes[childNode->id()] = childNode;
+    int slot = Telemetry::slot(childNode->id());
+    if (slot < 0) return;
+
+    if (m_childNodes.isEmpty()) m_childNodes.fill(nullptr, Telemetry::slotCount());
+    m_childNodes[slot] = childNode;
 }
 
 void Telemetry::removeChildNode(Telemetry* childNode)
 {
-    m_childNodes.remove(childNode->id());
+    int slot = Telemetry::slot(childNode->id());
+    if (slot < 0 || m_childNodes.isEmpty()) return;
+
+    m_childNodes[slot] = nullptr;
 }
 
@@ -3,7 +3,11 @@
 
 //Internal
 #include <QObject>
-#include <QMap>
+#include <QVector>
+#include <QVariant>
+
+// Std
+#include <bitset>
 
 // TODO: unit support
 
@@ -140,6 +144,9 @@
 
 namespace domain
 {
+    class TelemetryQueue;
+    class TelemetryHistory;
+
     class Telemetry: public QObject
     {
         Q_OBJECT
@@ -259,7 +266,61 @@ namespace domain
         };
 
         using TelemetryList = QList<TelemetryId>;
-        using TelemetryMap = QMap<TelemetryId, QVariant>;
+
+        // Every TelemetryId has fixed slot, slots are numbered from TelemetryId meta enum
+        static const int maxSlots = 128;
+        using SlotMask = std::bitset<maxSlots>;
+
+        static int slotCount();
+        static int slot(TelemetryId id);
+        static TelemetryId slotId(int slot);
+
+        // Slot values in columns by kind: scalars are kept unboxed with their meta type, other
+        // values go to variants column allocated with the first of them. Copies share columns.
+        class SlotValues
+        {
+        public:
+            union Number
+            {
+                double real;
+                qint64 integer; // Integers and bools
+            };
+
+            explicit SlotValues(int count = 0);
+
+            QVariant value(int slot) const;
+            bool set(int slot, const QVariant& value); // False if the slot has the same value
+
+        private:
+            bool setVariant(int slot, int type, const QVariant& value);
+
+            QVector<Number> m_numbers;
+            QVector<int> m_types; // Meta type of the slot value, unknown for unset slots
+            QVector<QVariant> m_variants;
+        };
+
+        // Read-only view over node's slots, shares values with the node until it changes them
+        class TelemetryMap
+        {
+        public:
+            TelemetryMap();
+            TelemetryMap(const SlotValues& values, const SlotMask& mask);
+
+            bool contains(TelemetryId id) const;
+            QVariant value(TelemetryId id, const QVariant& defaultValue = QVariant()) const;
+            template <typename T>
+            T value(TelemetryId id) const { return this->value(id).template value<T>(); }
+            QVariant operator[](TelemetryId id) const;
+
+            int count() const;
+            bool isEmpty() const;
+            TelemetryList keys() const;
+            SlotMask mask() const;
+
+        private:
+            SlotValues m_values;
+            SlotMask m_mask;
+        };
 
         Telemetry(TelemetryId id, Telemetry* parentNode = nullptr);
         ~Telemetry() override;
@@ -267,6 +328,8 @@ namespace domain
         TelemetryId id() const;
 
         QVariant parameter(TelemetryId id) const;
+        template <typename T>
+        T parameter(TelemetryId id) const { return this->parameter(id).template value<T>(); }
         TelemetryMap parameters() const;
 
         QList<TelemetryId> changedParameterKeys() const;
@@ -277,11 +340,19 @@ namespace domain
         Telemetry* childNode(const TelemetryList& path);
         QList<Telemetry*> childNodes() const;
 
+        // Ingestion queue, root nodes only
+        TelemetryQueue* queue() const;
+
+        // Queued updates are also appended to the history of the vehicle, root nodes only
+        void setHistory(TelemetryHistory* history, int vehicleId);
+
     public slots:
         void setParameter(TelemetryId id, const QVariant& value);
         void setParameter(const TelemetryList& path, const QVariant& value);
         void notify();
 
+        int processQueue(); // Apply queued updates and notify, returns updates count
+
     signals:
         void parametersChanged(Telemetry::TelemetryMap parameters); // Only changed parameters
         void parametersUpdated(Telemetry::TelemetryMap parameters); // All node's parameters
@@ -292,14 +363,21 @@ namespace domain
 
     private:
         const TelemetryId m_id;
-        TelemetryMap m_parameters;
-        TelemetryList m_changedParameters;
+        SlotValues m_values;
+        SlotMask m_present;
+        SlotMask m_changed;
 
         Telemetry* const m_parentNode;
-        QMap<TelemetryId, Telemetry*> m_childNodes;
+        QVector<Telemetry*> m_childNodes; // Indexed by slot, allocated with first child
+
+        TelemetryQueue* const m_queue;
+        TelemetryHistory* m_history = nullptr;
+        int m_historyId = 0;
 
         Q_ENUM(TelemetryId)
     };
 }
 
+Q_DECLARE_METATYPE(domain::Telemetry::TelemetryMap)
+
 #endif // TELEMETRY_NODE_H
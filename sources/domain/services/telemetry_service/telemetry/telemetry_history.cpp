@@ -0,0 +1,149 @@
+#include "telemetry_history.h"
+
+// Qt
+#include <QDebug>
+
+// Internal
+#include "telemetry_archive.h"
+#include "telemetry_archive_format.h"
+
+using namespace domain;
+
+TelemetryHistory::TelemetryHistory(qint64 budget, int capacity):
+    m_budget(budget),
+    m_capacity(qMax(2, capacity))
+{}
+
+TelemetryHistory::~TelemetryHistory()
+{
+    this->clear();
+}
+
+qint64 TelemetryHistory::budget() const
+{
+    return m_budget;
+}
+
+qint64 TelemetryHistory::usage() const
+{
+    return m_usage;
+}
+
+int TelemetryHistory::capacity() const
+{
+    return m_capacity;
+}
+
+quint64 TelemetryHistory::droppedSamples() const
+{
+    return m_droppedSamples;
+}
+
+TelemetryArchive* TelemetryHistory::archive() const
+{
+    return m_archive;
+}
+
+void TelemetryHistory::setArchive(TelemetryArchive* archive)
+{
+    m_archive = archive;
+}
+
+void TelemetryHistory::append(int vehicleId, Telemetry::TelemetryId node,
+                              Telemetry::TelemetryId parameter, qint64 time,
+                              const QVariant& value)
+{
+    quint64 key = TelemetryHistory::key(vehicleId, node, parameter);
+    bool archived = m_archive && m_archive->isRecording();
+
+    switch (value.userType())
+    {
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+    case QMetaType::Bool:
+    {
+        double scalar = value.toDouble();
+        this->append(m_scalars, key, time, scalar);
+
+        if (archived) m_archive->record(archive::seriesKey(vehicleId, node, parameter),
+                                        time, scalar);
+        break;
+    }
+    case QMetaType::QVector3D:
+    {
+        QVector3D vector = value.value<QVector3D>();
+        this->append(m_vectors, key, time, vector);
+
+        if (!archived) break;
+        for (int component = 0; component < 3; ++component)
+        {
+            m_archive->record(archive::seriesKey(vehicleId, node, parameter, component),
+                              time, vector[component]);
+        }
+        break;
+    }
+    default:
+        if (value.userType() != qMetaTypeId<QGeoCoordinate>()) break;
+
+        QGeoCoordinate coordinate = value.value<QGeoCoordinate>();
+        this->append(m_coordinates, key, time, coordinate);
+
+        if (!archived) break;
+        m_archive->record(archive::seriesKey(vehicleId, node, parameter, 0),
+                          time, coordinate.latitude());
+        m_archive->record(archive::seriesKey(vehicleId, node, parameter, 1),
+                          time, coordinate.longitude());
+        m_archive->record(archive::seriesKey(vehicleId, node, parameter, 2),
+                          time, coordinate.altitude());
+        break;
+    }
+}
+
+void TelemetryHistory::clear()
+{
+    qDeleteAll(m_scalars);
+    qDeleteAll(m_vectors);
+    qDeleteAll(m_coordinates);
+    m_scalars.clear();
+    m_vectors.clear();
+    m_coordinates.clear();
+
+    m_usage = 0;
+}
+
+quint64 TelemetryHistory::key(int vehicleId, Telemetry::TelemetryId node,
+                              Telemetry::TelemetryId parameter)
+{
+    // Slots fit in a byte (Telemetry::maxSlots)
+    return (quint64(quint32(vehicleId)) << 16) | (quint8(Telemetry::slot(node)) << 8) |
+            quint8(Telemetry::slot(parameter));
+}
+
+template <typename T>
+void TelemetryHistory::append(Rings<T>& rings, quint64 key, qint64 time, const T& value)
+{
+    TelemetryRing<T>* ring = rings.value(key, nullptr);
+    if (!ring)
+    {
+        qint64 size = sizeof(TelemetryRing<T>) +
+                qint64(sizeof(typename TelemetryRing<T>::Sample)) * m_capacity;
+        if (m_usage + size > m_budget)
+        {
+            m_droppedSamples++;
+            return;
+        }
+
+        ring = new TelemetryRing<T>(m_capacity);
+        rings.insert(key, ring);
+        m_usage += size;
+    }
+
+    ring->append(time, value);
+}
@@ -0,0 +1,183 @@
+#ifndef TELEMETRY_HISTORY_H
+#define TELEMETRY_HISTORY_H
+
+// Qt
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+#include <QGeoCoordinate>
+
+// Internal
+#include "telemetry.h"
+
+namespace domain
+{
+    class TelemetryArchive;
+
+    // Fixed-capacity ring of timestamped samples, the oldest sample is overwritten when full.
+    // Samples go in time order, so time queries are binary searches.
+    template <typename T>
+    class TelemetryRing
+    {
+    public:
+        class Sample
+        {
+        public:
+            qint64 time = 0; // Milliseconds since epoch
+            T value = T();
+        };
+
+        explicit TelemetryRing(int capacity):
+            m_samples(qMax(1, capacity))
+        {}
+
+        int capacity() const { return m_samples.count(); }
+        int count() const { return m_count; }
+        bool isEmpty() const { return m_count == 0; }
+        quint64 appended() const { return m_appended; } // Total, to follow overwritten samples
+
+        const Sample& at(int index) const // Zero is the oldest sample
+        {
+            int slot = m_first + index;
+            return m_samples.at(slot < m_samples.count() ? slot : slot - m_samples.count());
+        }
+        const Sample& last() const { return this->at(m_count - 1); }
+
+        void append(qint64 time, const T& value)
+        {
+            int slot = m_first + m_count;
+            if (slot >= m_samples.count()) slot -= m_samples.count();
+
+            if (m_count < m_samples.count()) m_count++;
+            else if (++m_first == m_samples.count()) m_first = 0;
+
+            // Clock stepping back must not break the order
+            Sample& sample = m_samples[slot];
+            sample.time = m_count > 1 ? qMax(time, this->at(m_count - 2).time) : time;
+            sample.value = value;
+            m_appended++;
+        }
+
+        // Index of the first sample at or after the time, count if there is no such sample
+        int lowerBound(qint64 time) const
+        {
+            int first = 0;
+            int length = m_count;
+            while (length > 0)
+            {
+                int half = length / 2;
+                if (this->at(first + half).time < time)
+                {
+                    first += half + 1;
+                    length -= half + 1;
+                }
+                else
+                {
+                    length = half;
+                }
+            }
+            return first;
+        }
+
+        // Index of the first sample after the time
+        int upperBound(qint64 time) const
+        {
+            int index = this->lowerBound(time);
+            while (index < m_count && this->at(index).time == time) ++index;
+            return index;
+        }
+
+        // Latest value at the time, false when history starts later
+        bool valueAt(qint64 time, T& value) const
+        {
+            int index = this->upperBound(time);
+            if (index == 0) return false;
+
+            value = this->at(index - 1).value;
+            return true;
+        }
+
+        QVector<Sample> range(qint64 from, qint64 to) const
+        {
+            QVector<Sample> samples;
+            int end = this->upperBound(to);
+            for (int index = this->lowerBound(from); index < end; ++index)
+            {
+                samples.append(this->at(index));
+            }
+            return samples;
+        }
+
+        void clear()
+        {
+            m_first = 0;
+            m_count = 0;
+        }
+
+    private:
+        QVector<Sample> m_samples;
+        int m_first = 0;
+        int m_count = 0;
+        quint64 m_appended = 0;
+    };
+
+    // Per vehicle history of numeric, vector and coordinate parameters, addressed by the node
+    // and the parameter ids. Series are allocated with the first value until budget is spent.
+    class TelemetryHistory
+    {
+    public:
+        TelemetryHistory(qint64 budget, int capacity); // Budget in bytes, capacity in samples
+        ~TelemetryHistory();
+
+        qint64 budget() const;
+        qint64 usage() const;
+        int capacity() const;
+        quint64 droppedSamples() const; // Of series not fitted in budget
+
+        // Appended values are recorded to the archive too, vectors and coordinates by component
+        TelemetryArchive* archive() const;
+        void setArchive(TelemetryArchive* archive);
+
+        // Only double, QVector3D and QGeoCoordinate series are stored
+        template <typename T>
+        const TelemetryRing<T>* series(int vehicleId, Telemetry::TelemetryId node,
+                                       Telemetry::TelemetryId parameter) const
+        {
+            return this->rings(static_cast<T*>(nullptr)).value(
+                        TelemetryHistory::key(vehicleId, node, parameter), nullptr);
+        }
+
+        void append(int vehicleId, Telemetry::TelemetryId node, Telemetry::TelemetryId parameter,
+                    qint64 time, const QVariant& value);
+
+        void clear();
+
+    private:
+        template <typename T>
+        using Rings = QHash<quint64, TelemetryRing<T>*>;
+
+        static quint64 key(int vehicleId, Telemetry::TelemetryId node,
+                           Telemetry::TelemetryId parameter);
+
+        const Rings<double>& rings(double*) const { return m_scalars; }
+        const Rings<QVector3D>& rings(QVector3D*) const { return m_vectors; }
+        const Rings<QGeoCoordinate>& rings(QGeoCoordinate*) const { return m_coordinates; }
+
+        template <typename T>
+        void append(Rings<T>& rings, quint64 key, qint64 time, const T& value);
+
+        const qint64 m_budget;
+        const int m_capacity;
+        qint64 m_usage = 0;
+        quint64 m_droppedSamples = 0;
+        TelemetryArchive* m_archive = nullptr;
+
+        Rings<double> m_scalars;
+        Rings<QVector3D> m_vectors;
+        Rings<QGeoCoordinate> m_coordinates;
+
+        Q_DISABLE_COPY(TelemetryHistory)
+    };
+}
+
+#endif // TELEMETRY_HISTORY_H
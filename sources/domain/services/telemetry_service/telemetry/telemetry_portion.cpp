@@ -1,23 +1,21 @@
 #include "telemetry_portion.h"
 
+// Internal
+#include "telemetry_queue.h"
+
 using namespace domain;
 
 TelemetryPortion::TelemetryPortion(Telemetry* node):
-    QObject(nullptr),
-    m_node(node)
+    m_queue(node ? node->queue() : nullptr)
+{}
+
+TelemetryPortion::~TelemetryPortion()
 {
-    if (node)
-    {
-        connect(this, &TelemetryPortion::setParameter,
-                node, QOverload< const QList< Telemetry::TelemetryId >&,
-                const QVariant& > ::of(&Telemetry::setParameter));
-    }
+    if (m_queue) m_queue->commit();
 }
 
-TelemetryPortion::~TelemetryPortion()
+void TelemetryPortion::setParameter(std::initializer_list<Telemetry::TelemetryId> path,
+                                    const QVariant& value)
 {
-    if (m_node)
-    {
-        QMetaObject::invokeMethod(m_node, "notify", Qt::QueuedConnection);
-    }
+    if (m_queue) m_queue->stage(path, value);
 }
@@ -1,24 +1,30 @@
 #ifndef TELEMETRY_PORTION_H
 #define TELEMETRY_PORTION_H
 
+// Std
+#include <initializer_list>
+
 // Internal
 #include "telemetry.h"
 
 namespace domain
 {
-    class TelemetryPortion: public QObject
-    {
-        Q_OBJECT
+    class TelemetryQueue;
 
+    // Stages parameters in root node's queue, they became visible together on destruction
+    class TelemetryPortion
+    {
     public:
         explicit TelemetryPortion(Telemetry* node);
-        ~TelemetryPortion() override;
+        ~TelemetryPortion();
 
-    signals:
-        void setParameter(const Telemetry::TelemetryList& path, const QVariant& value);
+        void setParameter(std::initializer_list<Telemetry::TelemetryId> path,
+                          const QVariant& value);
 
     private:
-        Telemetry* m_node;
+        TelemetryQueue* const m_queue;
+
+        Q_DISABLE_COPY(TelemetryPortion)
     };
 }
 
@@ -0,0 +1,75 @@
+#include "telemetry_queue.h"
+
+// Qt
+#include <QDebug>
+
+using namespace domain;
+
+namespace
+{
+    int roundUpToPowerOfTwo(int value)
+    {
+        int result = 2;
+        while (result < value) result <<= 1;
+        return result;
+    }
+}
+
+TelemetryQueue::TelemetryQueue(int capacity):
+    m_updates(::roundUpToPowerOfTwo(capacity)),
+    m_data(m_updates.data()),
+    m_mask(m_updates.count() - 1),
+    m_head(0),
+    m_tail(0),
+    m_staged(0),
+    m_dropped(0)
+{}
+
+int TelemetryQueue::capacity() const
+{
+    return m_updates.count() - 1; // One slot separates full and empty states
+}
+
+int TelemetryQueue::dropped() const
+{
+    return m_dropped.load();
+}
+
+bool TelemetryQueue::stage(std::initializer_list<Telemetry::TelemetryId> path,
+                           const QVariant& value)
+{
+    int next = (m_staged + 1) & m_mask;
+    if (next == m_head.loadAcquire() || path.size() > maxDepth || path.size() == 0)
+    {
+        m_dropped.ref();
+        return false;
+    }
+
+    Update& update = m_data[m_staged];
+    update.depth = 0;
+    for (Telemetry::TelemetryId id: path) update.path[update.depth++] = id;
+    update.value = value;
+
+    m_staged = next;
+    return true;
+}
+
+void TelemetryQueue::commit()
+{
+    m_tail.storeRelease(m_staged);
+}
+
+bool TelemetryQueue::take(Update& update)
+{
+    int head = m_head.load();
+    if (head == m_tail.loadAcquire()) return false;
+
+    Update& slot = m_data[head];
+    update.depth = slot.depth;
+    for (int i = 0; i < slot.depth; ++i) update.path[i] = slot.path[i];
+    update.value.swap(slot.value);
+    slot.value.clear(); // Release value memory in consumer thread
+
+    m_head.storeRelease((head + 1) & m_mask);
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+// Qt
+#include <QVector>
+#include <QVariant>
+#include <QAtomicInt>
+
+// Std
+#include <initializer_list>
+
+// Internal
+#include "telemetry.h"
+
+namespace domain
+{
+    // Single-producer/single-consumer ring of telemetry updates. Communication thread stages
+    // updates and commits them with one release store, GUI thread takes them once per frame.
+    class TelemetryQueue
+    {
+    public:
+        static const int maxDepth = 3;
+
+        class Update
+        {
+        public:
+            Telemetry::TelemetryId path[maxDepth];
+            int depth = 0;
+            QVariant value;
+        };
+
+        explicit TelemetryQueue(int capacity); // Rounded up to power of two
+
+        int capacity() const;
+        int dropped() const;
+
+        // Producer
+        bool stage(std::initializer_list<Telemetry::TelemetryId> path, const QVariant& value);
+        void commit();
+
+        // Consumer
+        bool take(Update& update);
+
+    private:
+        QVector<Update> m_updates;
+        Update* const m_data; // Detached once, accessed from both threads
+        const int m_mask;
+
+        QAtomicInt m_head;      // First update not taken by consumer
+        QAtomicInt m_tail;      // First update not committed by producer
+        int m_staged;           // Producer-local tail
+        QAtomicInt m_dropped;
+
+        Q_DISABLE_COPY(TelemetryQueue)
+    };
+}
+
+#endif // TELEMETRY_QUEUE_H
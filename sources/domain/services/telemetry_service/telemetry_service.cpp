@@ -2,6 +2,7 @@
 
 // Qt
 #include <QMap>
+#include <QTimerEvent>
 #include <QDebug>
 
 // Internal
@@ -12,12 +13,19 @@
 
 #include "telemetry.h"
 #include "telemetry_portion.h"
+#include "telemetry_history.h"
+#include "telemetry_archive.h"
 #include "vehicle_telemetry_factory.h"
 
 #include "vehicle_types.h"
 
 using namespace domain;
 
+namespace
+{
+    const int processInterval = 16; // Once per frame at 60 fps
+}
+
 class TelemetryService::Impl
 {
 public:
@@ -25,10 +33,24 @@ public:
 
     QMap<int, Telemetry*> vehicleNodes;
     Telemetry radioNode;
+    TelemetryHistory history;
+    TelemetryArchive archive;
+
+    int processTimer = 0;
 
     Impl():
-        radioNode(Telemetry::Root)
+        radioNode(Telemetry::Root),
+        history(settings::Provider::value(settings::telemetry::historyBudget).toLongLong(),
+                settings::Provider::value(settings::telemetry::historyCapacity).toInt())
     {}
+
+    Telemetry* createVehicleNode(int vehicleId)
+    {
+        VehicleTelemetryFactory factory;
+        Telemetry* node = factory.create();
+        node->setHistory(&history, vehicleId);
+        return node;
+    }
 };
 
 TelemetryService::TelemetryService(VehicleService* service, QObject* parent):
@@ -42,15 +64,25 @@ TelemetryService::TelemetryService(VehicleService* service, QObject* parent):
     connect(d->service, &VehicleService::vehicleAdded, this, &TelemetryService::onVehicleAdded);
     connect(d->service, &VehicleService::vehicleRemoved, this, &TelemetryService::onVehicleRemoved);
 
-    VehicleTelemetryFactory factory;
     for (const dto::VehiclePtr& vehicle: d->service->vehicles())
     {
-        d->vehicleNodes[vehicle->id()] = factory.create();
+        d->vehicleNodes[vehicle->id()] = d->createVehicleNode(vehicle->id());
     }
+
+    if (settings::Provider::boolValue(settings::telemetry::archiveEnabled))
+    {
+        QVariant directory = settings::Provider::value(settings::telemetry::archiveDirectory);
+        if (d->archive.start(directory.toString())) d->history.setArchive(&d->archive);
+    }
+
+    d->processTimer = this->startTimer(::processInterval);
 }
 
 TelemetryService::~TelemetryService()
-{}
+{
+    d->history.setArchive(nullptr);
+    d->archive.stop();
+}
 
 QList<Telemetry*> TelemetryService::rootNodes() const
 {
@@ -77,12 +109,26 @@ Telemetry* TelemetryService::radioNode() const
     return &d->radioNode;
 }
 
+TelemetryHistory* TelemetryService::history() const
+{
+    return &d->history;
+}
+
+void TelemetryService::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != d->processTimer) return QObject::timerEvent(event);
+
+    for (Telemetry* node: this->rootNodes())
+    {
+        node->processQueue();
+    }
+}
+
 void TelemetryService::onVehicleAdded(const dto::VehiclePtr& vehicle)
 {
     if (d->vehicleNodes.contains(vehicle->id())) return;
 
-    VehicleTelemetryFactory factory;
-    d->vehicleNodes[vehicle->id()] = factory.create();
+    d->vehicleNodes[vehicle->id()] = d->createVehicleNode(vehicle->id());
 }
 
 void TelemetryService::onVehicleRemoved(const dto::VehiclePtr& vehicle)
@@ -8,6 +8,7 @@ namespace domain
 {
     class VehicleService;
     class Telemetry;
+    class TelemetryHistory;
 
     class TelemetryService: public QObject
     {
@@ -23,6 +24,11 @@ namespace domain
         // TODO: multiply radio telemetry
         Telemetry* radioNode() const;
 
+        TelemetryHistory* history() const; // Of vehicle nodes
+
+    protected:
+        void timerEvent(QTimerEvent* event) override;
+
     private slots:
         void onVehicleAdded(const dto::VehiclePtr& vehicle);
         void onVehicleRemoved(const dto::VehiclePtr& vehicle);
@@ -2,8 +2,12 @@
 
 // Qt
 #include <QMutexLocker>
+#include <QHash>
 #include <QDebug>
 
+// Std
+#include <memory>
+
 // Internal
 #include "settings_provider.h"
 
@@ -19,18 +23,52 @@ using namespace domain;
 class VehicleService::Impl
 {
 public:
+    // Immutable mav id index, replaced as a whole by writers and read without locking
+    class MavIdIndex
+    {
+    public:
+        QHash<int, int> vehicleIds;
+        QHash<int, int> mavIds;
+    };
+
     QMutex mutex;
     GenericRepository<Vehicle> vehicleRepository;
     MissionService* missionService;
+    std::shared_ptr<const MavIdIndex> index;
 
     Impl():
         mutex(QMutex::Recursive),
-        vehicleRepository("vehicles")
+        vehicleRepository("vehicles"),
+        index(std::make_shared<MavIdIndex>())
     {}
 
     void loadVehicles(const QString& condition = QString())
     {
-        for (int id: vehicleRepository.selectId(condition)) vehicleRepository.read(id);
+        vehicleRepository.load(condition);
+    }
+
+    std::shared_ptr<const MavIdIndex> indexSnapshot() const
+    {
+        return std::atomic_load(&index);
+    }
+
+    // Called with the mutex locked, after any change of loaded vehicles
+    void rebuildIndex()
+    {
+        auto newIndex = std::make_shared<MavIdIndex>();
+        for (const VehiclePtr& vehicle: vehicleRepository.loadedEntities())
+        {
+            newIndex->mavIds.insert(vehicle->id(), vehicle->mavId());
+
+            // Duplicated mav ids are resolved to the oldest vehicle
+            int vehicleId = newIndex->vehicleIds.value(vehicle->mavId(), 0);
+            if (!vehicleId || vehicle->id() < vehicleId)
+            {
+                newIndex->vehicleIds.insert(vehicle->mavId(), vehicle->id());
+            }
+        }
+
+        std::atomic_store(&index, std::shared_ptr<const MavIdIndex>(newIndex));
     }
 };
 
@@ -45,6 +83,7 @@ VehicleService::VehicleService(MissionService* missionService, QObject* parent):
             &MissionService::onVehicleChanged);
 
     d->loadVehicles();
+    d->rebuildIndex();
 }
 
 VehicleService::~VehicleService()
@@ -67,32 +106,17 @@ VehiclePtrList VehicleService::vehicles() const
 
 int VehicleService::vehicleIdByMavId(int mavId) const
 {
-    QMutexLocker locker(&d->mutex);
-
-    for (const VehiclePtr& vehicle: d->vehicleRepository.loadedEntities())
-    {
-        if (vehicle->mavId() == mavId) return vehicle->id();
-    }
-    return 0;
+    return d->indexSnapshot()->vehicleIds.value(mavId, 0);
 }
 
 int VehicleService::mavIdByVehicleId(int vehicleId) const
 {
-    QMutexLocker locker(&d->mutex);
-
-    VehiclePtr vehicle = this->vehicle(vehicleId);
-    if (vehicle) return vehicle->mavId();
-    return -1;
+    return d->indexSnapshot()->mavIds.value(vehicleId, -1);
 }
 
 QList<int> VehicleService::employedMavIds() const
 {
-    QList<int> mavIds;
-    for (const VehiclePtr& vehicle: this->vehicles())
-    {
-        mavIds.append(vehicle->mavId());
-    }
-    return mavIds;
+    return d->indexSnapshot()->mavIds.values();
 }
 
 bool VehicleService::save(const VehiclePtr& vehicle)
@@ -102,6 +126,8 @@ bool VehicleService::save(const VehiclePtr& vehicle)
     bool isNew = vehicle->id() == 0;
     if (!d->vehicleRepository.save(vehicle)) return false;
 
+    d->rebuildIndex();
+
     if (isNew)
     {
         settings::Provider::setValue(settings::vehicle::vehicle + QString::number(vehicle->id()) +
@@ -132,6 +158,8 @@ bool VehicleService::remove(const VehiclePtr& vehicle)
 
     if (!d->vehicleRepository.remove(vehicle)) return false;
 
+    d->rebuildIndex();
+
     settings::Provider::remove(settings::vehicle::vehicle + QString::number(vehicle->id()));
 
     emit vehicleRemoved(vehicle);
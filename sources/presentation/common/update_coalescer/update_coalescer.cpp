@@ -0,0 +1,91 @@
+#include "update_coalescer.h"
+
+// Qt
+#include <QQuickWindow>
+
+// Internal
+#include "settings_provider.h"
+
+using namespace presentation;
+
+UpdateCoalescer::UpdateCoalescer():
+    m_interval(settings::Provider::value(settings::gui::updateInterval).toInt())
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &UpdateCoalescer::onTimeout);
+
+    connect(settings::Provider::instance(), &settings::Provider::valueChanged,
+            this, [this](const QString& key, const QVariant& value) {
+        if (key == settings::gui::updateInterval) this->setInterval(value.toInt());
+    });
+
+    m_sinceFlush.start();
+}
+
+UpdateCoalescer* UpdateCoalescer::instance()
+{
+    static UpdateCoalescer coalescer;
+    return &coalescer;
+}
+
+int UpdateCoalescer::interval() const
+{
+    return m_interval;
+}
+
+void UpdateCoalescer::setWindow(QQuickWindow* window)
+{
+    if (m_window) disconnect(m_window, 0, this, 0);
+
+    m_window = window;
+    m_waitingFrame = false;
+
+    // Animations are advanced on the GUI thread right before the scene is synchronized
+    if (window) connect(window, &QQuickWindow::afterAnimating, this, &UpdateCoalescer::onFrame);
+}
+
+void UpdateCoalescer::setInterval(int interval)
+{
+    m_interval = qMax(0, interval);
+}
+
+void UpdateCoalescer::request()
+{
+    if (m_requested) return;
+
+    m_requested = true;
+    if (m_timer.isActive() || m_waitingFrame) return;
+
+    m_timer.start(int(qMax<qint64>(0, m_interval - m_sinceFlush.elapsed())));
+}
+
+void UpdateCoalescer::onTimeout()
+{
+    // Hidden window renders nothing, flush right away then
+    if (m_window && m_window->isExposed())
+    {
+        m_waitingFrame = true;
+        m_window->update();
+        return;
+    }
+
+    this->emitFlush();
+}
+
+void UpdateCoalescer::onFrame()
+{
+    if (!m_waitingFrame) return;
+
+    m_waitingFrame = false;
+    this->emitFlush();
+}
+
+void UpdateCoalescer::emitFlush()
+{
+    if (!m_requested) return;
+
+    m_requested = false;
+    m_sinceFlush.restart();
+    emit flush();
+}
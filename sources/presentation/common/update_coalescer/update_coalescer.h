@@ -0,0 +1,53 @@
+#ifndef UPDATE_COALESCER_H
+#define UPDATE_COALESCER_H
+
+// Qt
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QQuickWindow;
+
+namespace presentation
+{
+    // Models and presenters mark their changes dirty and request a flush, flush comes once per
+    // rendered frame of the window. Interval, if set, is the minimum time between flushes.
+    class UpdateCoalescer: public QObject
+    {
+        Q_OBJECT
+
+    public:
+        static UpdateCoalescer* instance();
+
+        int interval() const; // ms
+        void setWindow(QQuickWindow* window);
+
+    public slots:
+        void setInterval(int interval);
+        void request();
+
+    signals:
+        void flush();
+
+    private slots:
+        void onTimeout();
+        void onFrame();
+
+    private:
+        UpdateCoalescer();
+
+        void emitFlush();
+
+        int m_interval;
+        QTimer m_timer;
+        QElapsedTimer m_sinceFlush;
+        QPointer<QQuickWindow> m_window;
+        bool m_requested = false;
+        bool m_waitingFrame = false;
+
+        Q_DISABLE_COPY(UpdateCoalescer)
+    };
+}
+
+#endif // UPDATE_COALESCER_H
@@ -7,6 +7,7 @@
 
 #include "units.h"
 #include "translation_helper.h"
+#include "update_coalescer.h"
 
 #include "manual_controller.h"
 
@@ -14,7 +15,7 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
-#include <QWindow>
+#include <QQuickWindow>
 #include <QDebug>
 
 using namespace presentation;
@@ -78,6 +79,7 @@ QQmlContext* PresentationContext::rootContext()
 void PresentationContext::start()
 {
     instance()->m_engine->load(QUrl("qrc:/Views/MainView.qml"));
+    UpdateCoalescer::instance()->setWindow(qobject_cast<QQuickWindow*>(this->rootView()));
     PresentationContext::updateGeometry();
 }
 
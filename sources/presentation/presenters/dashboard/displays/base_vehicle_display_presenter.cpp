@@ -1,12 +1,15 @@
 #include "base_vehicle_display_presenter.h"
 
 // Qt
-#include <QTime>
 #include <QVector3D>
 #include <QGeoCoordinate>
 #include <QDebug>
 
 // Internal
+#include "service_registry.h"
+#include "telemetry_service.h"
+#include "telemetry_history.h"
+
 #include "vibration_model.h"
 
 #include "vehicle_types.h"
@@ -54,6 +57,8 @@ void BaseVehicleDisplayPresenter::connectNode(domain::Telemetry* node)
     this->chainNode(node->childNode(domain::Telemetry::Position),
                     std::bind(&BaseVehicleDisplayPresenter::updatePosition,
                               this, std::placeholders::_1));
+
+    this->updateVibration();
 }
 
 void BaseVehicleDisplayPresenter::updateSystem(const domain::Telemetry::TelemetryMap& parameters)
@@ -90,12 +95,16 @@ void BaseVehicleDisplayPresenter::updateAhrs(const domain::Telemetry::TelemetryM
     this->setVehicleProperty(PROPERTY(ahrs), PROPERTY(yawspeed),
                              parameters.value(domain::Telemetry::YawSpeed, qQNaN()));
 
-    // TODO: telemetry timestamp
-    Vibration vibration;
-    vibration.timestamp = QTime::currentTime().msecsSinceStartOfDay();
-    vibration.data = parameters.value(domain::Telemetry::Vibration).value<QVector3D>();
+    if (parameters.contains(domain::Telemetry::Vibration)) this->updateVibration();
+}
 
-    m_vibrationModel->addData(vibration);
+void BaseVehicleDisplayPresenter::updateVibration()
+{
+    // Series appears with the first vibration sample of the vehicle
+    domain::TelemetryHistory* history = serviceRegistry->telemetryService()->history();
+    m_vibrationModel->setSeries(history->series<QVector3D>(this->vehicleId(),
+                                                           domain::Telemetry::Ahrs,
+                                                           domain::Telemetry::Vibration));
 }
 
 void BaseVehicleDisplayPresenter::updateCompass(const domain::Telemetry::TelemetryMap& parameters)
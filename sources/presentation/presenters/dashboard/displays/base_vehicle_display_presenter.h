@@ -28,6 +28,7 @@ namespace presentation
         void updateBattery(const domain::Telemetry::TelemetryMap& parameters);
         void updatePosition(const domain::Telemetry::TelemetryMap& parameters);
         void updateHome(const domain::Telemetry::TelemetryMap& parameters);
+        void updateVibration();
 
     private:
         VibrationModel* m_vibrationModel;
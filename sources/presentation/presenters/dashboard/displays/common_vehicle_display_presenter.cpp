@@ -2,6 +2,7 @@
 
 // Qt
 #include <QVariant>
+#include <QHash>
 #include <QDebug>
 
 // Internal
@@ -16,6 +17,8 @@
 #include "command_service.h"
 #include "telemetry_service.h"
 
+#include "update_coalescer.h"
+
 using namespace presentation;
 
 class CommonVehicleDisplayPresenter::Impl
@@ -25,6 +28,9 @@ public:
     dto::MissionAssignmentPtr assignment;
     QList<dto::CommandPtr> commands;
 
+    // By group, empty one is the vehicle itself
+    QHash<QString, QHash<QByteArray, QVariant> > pendingProperties;
+
     domain::VehicleService* vehicleService = serviceRegistry->vehicleService();
     domain::MissionService* missionService = serviceRegistry->missionService();
     domain::CommandService* commandService = serviceRegistry->commandService();
@@ -34,6 +40,9 @@ CommonVehicleDisplayPresenter::CommonVehicleDisplayPresenter(QObject* parent):
     AbstractTelemetryPresenter(parent),
     d(new Impl())
 {
+    connect(UpdateCoalescer::instance(), &UpdateCoalescer::flush,
+            this, &CommonVehicleDisplayPresenter::flushVehicleProperties);
+
     connect(d->vehicleService, &domain::VehicleService::vehicleChanged,
             this, [this](const dto::VehiclePtr& vehicle) {
         if (vehicle == d->vehicle) this->updateVehicle();
@@ -105,6 +114,11 @@ void CommonVehicleDisplayPresenter::setVehicle(int vehicleId)
     this->setNode(serviceRegistry->telemetryService()->vehicleNode(vehicleId));
 }
 
+int CommonVehicleDisplayPresenter::vehicleId() const
+{
+    return d->vehicle ? d->vehicle->id() : 0;
+}
+
 void CommonVehicleDisplayPresenter::updateVehicle()
 {
     if (d->vehicle)
@@ -188,18 +202,32 @@ void CommonVehicleDisplayPresenter::setVehicleProperty(const QString& group, con
 {
     if (!this->view()) return;
 
+    d->pendingProperties[group][name] = value;
+    UpdateCoalescer::instance()->request();
+}
+
+void CommonVehicleDisplayPresenter::flushVehicleProperties()
+{
+    if (d->pendingProperties.isEmpty()) return;
+
+    QHash<QString, QHash<QByteArray, QVariant> > pending;
+    pending.swap(d->pendingProperties);
+
+    if (!this->view()) return;
+
+    // View objects are looked up once per flush, not once per property
     QObject* vehicle = this->view()->findChild<QObject*>(PROPERTY(vehicle));
     if (!vehicle) return;
 
-    if (group.isEmpty())
+    for (auto group = pending.constBegin(); group != pending.constEnd(); ++group)
     {
-        vehicle->setProperty(name, value);
-    }
-    else
-    {
-         QObject* groupObject = vehicle->findChild<QObject*>(group);
-         if (!groupObject) return;
+        QObject* object = group.key().isEmpty() ? vehicle :
+                                                   vehicle->findChild<QObject*>(group.key());
+        if (!object) continue;
 
-         groupObject->setProperty(name, value);
+        for (auto property = group->constBegin(); property != group->constEnd(); ++property)
+        {
+            object->setProperty(property.key().constData(), property.value());
+        }
     }
 }
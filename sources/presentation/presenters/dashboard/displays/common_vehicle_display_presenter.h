@@ -26,9 +26,15 @@ namespace presentation
     protected:
         void connectView(QObject* view) override;
 
+        int vehicleId() const;
+
+        // Values are set to the view with the next flush, the last one of each property wins
         void setVehicleProperty(const char* name, const QVariant& value);
         void setVehicleProperty(const QString& group, const char* name, const QVariant& value);
 
+    private slots:
+        void flushVehicleProperties();
+
     private:
         class Impl;
         QScopedPointer<Impl> const d;
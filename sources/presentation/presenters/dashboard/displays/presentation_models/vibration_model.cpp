@@ -3,11 +3,14 @@
 // Qt
 #include <QMap>
 #include <QColor>
+#include <QDateTime>
 #include <QDebug>
 
 // Internal
 #include "settings_provider.h"
 
+#include "telemetry_history.h"
+
 using namespace presentation;
 
 VibrationModel::VibrationModel(QObject* parent):
@@ -18,7 +21,7 @@ int VibrationModel::rowCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent)
 
-    return m_data.count();
+    return m_count;
 }
 
 int VibrationModel::columnCount(const QModelIndex& parent) const
@@ -52,13 +55,17 @@ QVariant VibrationModel::headerData(int section,
 
 QVariant VibrationModel::data(const QModelIndex& index, int role) const
 {
+    if (index.row() < 0 || index.row() >= m_count) return QVariant();
+
+    const Series::Sample& sample = m_series->at(this->seriesIndex(index.row()));
+
     switch (role)
     {
     case Qt::DisplayRole:
-        if (index.column() == 0) return m_data.at(index.row()).timestamp;
-        if (index.column() == 1) return m_data.at(index.row()).data.x();
-        if (index.column() == 2) return m_data.at(index.row()).data.y();
-        if (index.column() == 3) return m_data.at(index.row()).data.z();
+        if (index.column() == 0) return int(sample.time - m_dayStart);
+        if (index.column() == 1) return sample.value.x();
+        if (index.column() == 2) return sample.value.y();
+        if (index.column() == 3) return sample.value.z();
     default:
         return QVariant();
     }
@@ -79,60 +86,79 @@ float VibrationModel::maxValue() const
     return m_maxValue;
 }
 
-void VibrationModel::addData(const Vibration& vibration)
+void VibrationModel::setSeries(const Series* series)
 {
-    if (m_data.isEmpty()) m_minTime = vibration.timestamp;
+    if (m_series == series) return this->update();
 
-    this->beginInsertRows(QModelIndex(), m_data.count(), m_data.count() + 1);
-    m_data.append(vibration);
-    this->endInsertRows();
+    int maxCount = qMax(2, settings::Provider::value(
+                            settings::gui::vibrationModelCount).toInt());
 
-    if (m_maxTime < vibration.timestamp) m_maxTime = vibration.timestamp;
-    m_maxValue = qMax(m_maxValue, vibration.data.x());
-    m_maxValue = qMax(m_maxValue, vibration.data.y());
-    m_maxValue = qMax(m_maxValue, vibration.data.z());
+    this->beginResetModel();
 
-    int count = qMax(2, settings::Provider::value(
-                         settings::gui::vibrationModelCount).toInt());
-    if (m_data.count() > count)
-    {
-        this->beginRemoveRows(QModelIndex(), 0, 0);
-        m_data.removeFirst();
-        this->endRemoveRows();
+    m_series = series;
+    m_appended = series ? series->appended() : 0;
+    m_count = series ? qMin(series->count(), maxCount) : 0;
+    m_dayStart = QDateTime(QDate::currentDate()).toMSecsSinceEpoch();
 
-        m_minTime = m_data.first().timestamp;
-    }
+    this->endResetModel();
 
-    emit boundsChanged();
+    this->updateBounds();
 }
 
-void VibrationModel::resetData(const QList<Vibration>& data)
+void VibrationModel::update()
 {
-    this->beginResetModel();
+    if (!m_series || m_series->appended() == m_appended) return;
 
-    int maxCount = settings::Provider::value(
-                       settings::gui::vibrationModelCount).toInt();
+    int maxCount = qMax(2, settings::Provider::value(
+                            settings::gui::vibrationModelCount).toInt());
+    int count = qMin(m_series->count(), maxCount);
+    quint64 added = m_series->appended() - m_appended;
 
-    if (data.count() <= maxCount)
+    if (added >= quint64(count))
     {
-        m_data = data;
+        this->beginResetModel();
+        m_appended = m_series->appended();
+        m_count = count;
+        this->endResetModel();
     }
     else
     {
-        m_data = data.mid(0, maxCount);
+        // Rows are bound to sample numbers, so old rows stay valid until new are inserted
+        int removed = m_count + int(added) - count;
+        if (removed > 0)
+        {
+            this->beginRemoveRows(QModelIndex(), 0, removed - 1);
+            m_count -= removed;
+            this->endRemoveRows();
+        }
+
+        this->beginInsertRows(QModelIndex(), m_count, m_count + int(added) - 1);
+        m_appended += added;
+        m_count += int(added);
+        this->endInsertRows();
     }
 
-    this->endResetModel();
+    this->updateBounds();
+}
 
-    m_minTime = m_data.isEmpty() ? 0 : m_data.first().timestamp;
-    m_maxTime = m_data.isEmpty() ? 0 : m_data.last().timestamp;
+int VibrationModel::seriesIndex(int row) const
+{
+    // Sample number to the ring index, the ring holds the latest count of appended
+    return int(m_appended - m_count + row - (m_series->appended() - m_series->count()));
+}
+
+void VibrationModel::updateBounds()
+{
+    m_minTime = m_count ? int(m_series->at(this->seriesIndex(0)).time - m_dayStart) : 0;
+    m_maxTime = m_count ? int(m_series->at(this->seriesIndex(m_count - 1)).time - m_dayStart) : 0;
     m_maxValue = 0;
 
-    for (const Vibration& vibration: m_data)
+    for (int row = 0; row < m_count; ++row)
     {
-        m_maxValue = qMax(m_maxValue, vibration.data.x());
-        m_maxValue = qMax(m_maxValue, vibration.data.y());
-        m_maxValue = qMax(m_maxValue, vibration.data.z());
+        const QVector3D& value = m_series->at(this->seriesIndex(row)).value;
+        m_maxValue = qMax(m_maxValue, value.x());
+        m_maxValue = qMax(m_maxValue, value.y());
+        m_maxValue = qMax(m_maxValue, value.z());
     }
 
     emit boundsChanged();
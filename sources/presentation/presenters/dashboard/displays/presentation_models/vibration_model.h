@@ -5,14 +5,15 @@
 #include <QAbstractTableModel>
 #include <QVector3D>
 
-namespace presentation
+namespace domain
 {
-    struct Vibration
-    {
-        int timestamp = 0;
-        QVector3D data;
-    };
+    template <typename T>
+    class TelemetryRing;
+}
 
+namespace presentation
+{
+    // Latest samples of vibration history, the series is shared with telemetry service
     class VibrationModel: public QAbstractTableModel
     {
         Q_OBJECT
@@ -35,15 +36,23 @@ namespace presentation
         int maxTime() const;
         float maxValue() const;
 
+        using Series = domain::TelemetryRing<QVector3D>;
+
     public slots:
-        void addData(const Vibration& vibration);
-        void resetData(const QList<Vibration>& data);
+        void setSeries(const Series* series); // Not owned
+        void update(); // Follows samples appended to the series
 
     signals:
         void boundsChanged();
 
     private:
-        QList<Vibration> m_data;
+        int seriesIndex(int row) const;
+        void updateBounds();
+
+        const Series* m_series = nullptr;
+        quint64 m_appended = 0;
+        int m_count = 0;
+        qint64 m_dayStart = 0;
         int m_minTime = 0;
         int m_maxTime = 0;
         float m_maxValue = 0;
@@ -72,6 +72,10 @@ void LinkEditPresenter::updateLink()
                           endpoints.isEmpty() ? QStringList() : endpoints.split(::separator));
     this->setViewProperty(PROPERTY(autoResponse),
                           m_link ? m_link->parameter(dto::LinkDescription::UdpAutoResponse) : false);
+    this->setViewProperty(PROPERTY(path),
+                          m_link ? m_link->parameter(dto::LinkDescription::Path) : QString());
+    this->setViewProperty(PROPERTY(speed),
+                          m_link ? m_link->parameter(dto::LinkDescription::Speed, 1.0) : 1.0);
 
     this->setViewProperty(PROPERTY(changed), false);
 }
@@ -142,6 +146,10 @@ void LinkEditPresenter::save()
     m_link->setParameter(dto::LinkDescription::Endpoints, endpoints.join(::separator));
     m_link->setParameter(dto::LinkDescription::UdpAutoResponse,
                                 this->viewProperty(PROPERTY(autoResponse)).toBool());
+    m_link->setParameter(dto::LinkDescription::Path,
+                                this->viewProperty(PROPERTY(path)).toString());
+    m_link->setParameter(dto::LinkDescription::Speed,
+                                this->viewProperty(PROPERTY(speed)).toDouble());
 
     if (!m_service->save(m_link)) return;
 
@@ -2,6 +2,7 @@
 
 // Qt
 #include <QSortFilterProxyModel>
+#include <QDir>
 #include <QVariant>
 #include <QDebug>
 
@@ -100,6 +101,24 @@ void LinkListPresenter::addBluetoothLink()
     d->service->save(description);
 }
 
+void LinkListPresenter::addReplayLink()
+{
+    dto::LinkDescriptionPtr description = dto::LinkDescriptionPtr::create();
+
+    description->setName(tr("Replay"));
+    description->setType(dto::LinkDescription::Replay);
+
+    // Latest recorded session, the recorder names them by sortable start time
+    QDir root(settings::Provider::value(settings::communication::tlogDirectory).toString());
+    QStringList sessions = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    description->setParameter(dto::LinkDescription::Path, sessions.isEmpty() ?
+                                  QString() : root.absoluteFilePath(sessions.last()));
+    description->setParameter(dto::LinkDescription::Speed, 1.0);
+    description->setAutoConnect(false);
+
+    d->service->save(description);
+}
+
 void LinkListPresenter::filter(const QString& filterString)
 {
     d->filterModel.setFilterFixedString(filterString);
@@ -19,6 +19,7 @@ namespace presentation
         void addUdpLink();
         void addTcpLink();
         void addBluetoothLink();
+        void addReplayLink();
 
         void filter(const QString& filterString);
 
@@ -97,7 +97,7 @@ void LinkStatisticsModel::addData(const dto::LinkStatisticsPtr& statistics)
     if (m_maxRecv < statistics->bytesRecv() || m_data.isEmpty()) m_maxRecv = statistics->bytesRecv();
     if (m_maxSent < statistics->bytesSent() || m_data.isEmpty()) m_maxSent = statistics->bytesSent();
 
-    int count = qMax(2, settings::Provider::value(settings::communication::statisticsCount).toInt());
+    int count = qMax(2, settings::Provider::snapshot().statisticsCount.load());
     if (m_data.count() > count)
     {
         this->beginRemoveRows(QModelIndex(), 0, 0);
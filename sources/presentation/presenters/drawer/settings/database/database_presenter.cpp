@@ -8,6 +8,7 @@
 // Internal
 #include "common.h"
 #include "settings_provider.h"
+#include "db_writer.h"
 
 using namespace presentation;
 
@@ -62,6 +63,9 @@ void DatabasePresenter::savePath()
 
 void DatabasePresenter::migrate()
 {
+    // Written behind rows must not interleave with migration
+    if (db::DbWriter::instance()) db::DbWriter::instance()->flush();
+
     m_manager.migrateLastVersion();
 
     this->updateConnected();
@@ -1,7 +1,6 @@
 #include "mission_line_map_item_model.h"
 
 // Qt
-#include <QGeoCoordinate>
 #include <QDebug>
 
 // Internal
@@ -13,6 +12,9 @@
 #include "mission_service.h"
 #include "mission_assignment.h"
 
+// Std
+#include <algorithm>
+
 using namespace presentation;
 
 MissionLineMapItemModel::MissionLineMapItemModel(domain::MissionService* service,
@@ -37,9 +39,19 @@ MissionLineMapItemModel::MissionLineMapItemModel(domain::MissionService* service
     connect(service, &domain::MissionService::missionItemChanged,
             this, &MissionLineMapItemModel::onMissionItemChanged);
     connect(service, &domain::MissionService::missionItemAdded,
-            this, &MissionLineMapItemModel::onMissionItemChanged);
+            this, &MissionLineMapItemModel::onMissionItemAdded);
     connect(service, &domain::MissionService::missionItemRemoved,
-            this, &MissionLineMapItemModel::onMissionItemChanged);
+            this, &MissionLineMapItemModel::onMissionItemRemoved);
+    connect(service, &domain::MissionService::missionItemsLoaded,
+            this, &MissionLineMapItemModel::onMissionItemsLoaded);
+
+    // Items of all visible missions in one go
+    QList<int> visible;
+    for (const dto::MissionPtr& mission: service->missions())
+    {
+        if (MissionLineMapItemModel::isVisible(mission->id())) visible.append(mission->id());
+    }
+    service->loadMissionItems(visible);
 
     for (const dto::MissionPtr& item: service->missions())
     {
@@ -62,29 +74,14 @@ QVariant MissionLineMapItemModel::data(const QModelIndex& index, int role) const
     {
     case MissionPathRole:
     {
-        QVariantList line;
-        if (!settings::Provider::value(settings::mission::mission + QString::number(mission->id()) +
-                                       "/" + settings::visibility).toBool())
+        auto it = m_lines.find(mission->id());
+        if (it == m_lines.end() || !it->visible)
         {
-            line.append(QVariant::fromValue(QGeoCoordinate(0, 0)));
-            return line;
+            return QVariantList({ QVariant::fromValue(QGeoCoordinate(0, 0)) });
         }
 
-        for (const dto::MissionItemPtr& item: m_service->missionItems(mission->id()))
-        {
-            if (item->isPositionatedItem())
-            {
-                if (item->coordinate().isValid())
-                {
-                    line.append(QVariant::fromValue(item->coordinate()));
-                }
-            }
-            else if (item->command() == dto::MissionItem::Return && !line.isEmpty())
-            {
-                line.append(line[0]); // Return to home line
-            }
-        }
-        return line;
+        if (!it->actual) it->rebuild();
+        return it->path;
     }
     case MissionStatusRole:
     {
@@ -100,6 +97,15 @@ QVariant MissionLineMapItemModel::data(const QModelIndex& index, int role) const
 
 void MissionLineMapItemModel::onMissionAdded(const dto::MissionPtr& mission)
 {
+    bool visible = MissionLineMapItemModel::isVisible(mission->id());
+    QVector<Vertex> vertices;
+    if (visible) vertices = this->vertices(mission->id());
+
+    Line& line = m_lines[mission->id()];
+    line.visible = visible;
+    line.vertices = vertices;
+    line.actual = false;
+
     this->beginInsertRows(QModelIndex(), this->rowCount(), this->rowCount());
     m_missions.append(mission);
     this->endInsertRows();
@@ -108,6 +114,8 @@ void MissionLineMapItemModel::onMissionAdded(const dto::MissionPtr& mission)
 void MissionLineMapItemModel::onMissionRemoved(const dto::MissionPtr& mission)
 {
     int row = m_missions.indexOf(mission);
+    m_lines.remove(mission->id());
+    if (row < 0) return;
 
     this->beginRemoveRows(QModelIndex(), row, row);
     m_missions.removeOne(mission);
@@ -116,8 +124,20 @@ void MissionLineMapItemModel::onMissionRemoved(const dto::MissionPtr& mission)
 
 void MissionLineMapItemModel::onMissionChanged(const dto::MissionPtr& mission)
 {
-    QModelIndex index = this->index(m_missions.indexOf(mission));
-    if (index.isValid()) emit dataChanged(index, index, { MissionPathRole });
+    // Path depends only on the visibility of the mission itself
+    auto it = m_lines.find(mission->id());
+    if (it == m_lines.end()) return;
+
+    bool visible = MissionLineMapItemModel::isVisible(mission->id());
+    if (it->visible == visible) return;
+
+    if (visible)
+    {
+        it->vertices = this->vertices(mission->id());
+        it->actual = false;
+    }
+    it->visible = visible;
+    this->emitPathChanged(mission->id());
 }
 
 void MissionLineMapItemModel::onAssignmentChanged(const dto::MissionAssignmentPtr& assignment)
@@ -127,16 +147,106 @@ void MissionLineMapItemModel::onAssignmentChanged(const dto::MissionAssignmentPt
         if (m_missions[row]->id() != assignment->missionId()) continue;
 
         QModelIndex index = this->index(row);
-        if (index.isValid()) emit dataChanged(index, index, { MissionPathRole });
+        if (index.isValid()) emit dataChanged(index, index, { MissionStatusRole });
         return;
     }
 }
 
+void MissionLineMapItemModel::onMissionItemAdded(const dto::MissionItemPtr& item)
+{
+    auto it = m_lines.find(item->missionId());
+    if (it == m_lines.end()) return;
+
+    Vertex vertex = MissionLineMapItemModel::vertex(item);
+    MissionLineMapItemModel::insertVertex(*it, vertex);
+
+    if (vertex.coordinate.isValid() || vertex.back)
+    {
+        it->actual = false;
+        this->emitPathChanged(item->missionId());
+    }
+}
+
+void MissionLineMapItemModel::onMissionItemRemoved(const dto::MissionItemPtr& item)
+{
+    auto it = m_lines.find(item->missionId());
+    if (it == m_lines.end()) return;
+
+    int position = MissionLineMapItemModel::findVertex(*it, item);
+    if (position < 0) return;
+
+    Vertex vertex = it->vertices.takeAt(position);
+    if (vertex.coordinate.isValid() || vertex.back)
+    {
+        it->actual = false;
+        this->emitPathChanged(item->missionId());
+    }
+}
+
 void MissionLineMapItemModel::onMissionItemChanged(const dto::MissionItemPtr& item)
 {
-    dto::MissionPtr mission = m_service->mission(item->missionId());
-    QModelIndex index = this->index(m_missions.indexOf(mission));
-    if (index.isValid()) emit dataChanged(index, index, { MissionPathRole });
+    auto it = m_lines.find(item->missionId());
+    if (it == m_lines.end()) return;
+
+    int position = MissionLineMapItemModel::findVertex(*it, item);
+    if (position < 0)
+    {
+        this->onMissionItemAdded(item);
+        return;
+    }
+
+    Vertex& vertex = it->vertices[position];
+    Vertex changed = MissionLineMapItemModel::vertex(item);
+
+    if (vertex.sequence != changed.sequence)
+    {
+        // Neighbours are shifted one by one, so order mostly holds and vertex stays in place
+        bool ordered = (position == 0 ||
+                        it->vertices.at(position - 1).sequence <= changed.sequence) &&
+                (position == it->vertices.count() - 1 ||
+                 it->vertices.at(position + 1).sequence >= changed.sequence);
+        if (!ordered)
+        {
+            bool onPath = vertex.coordinate.isValid() || vertex.back ||
+                          changed.coordinate.isValid() || changed.back;
+
+            it->vertices.removeAt(position);
+            MissionLineMapItemModel::insertVertex(*it, changed);
+            if (!onPath) return;
+
+            it->actual = false;
+            this->emitPathChanged(item->missionId());
+            return;
+        }
+        vertex.sequence = changed.sequence;
+    }
+
+    // Status and parameter changes, e.g. upload progress, leave the path as is
+    if (MissionLineMapItemModel::sameContribution(vertex, changed)) return;
+
+    if (it->actual && vertex.index > 0 && changed.coordinate.isValid())
+    {
+        // Moved point not referred by return lines is patched in place
+        changed.index = vertex.index;
+        it->path[vertex.index] = QVariant::fromValue(changed.coordinate);
+    }
+    else
+    {
+        it->actual = false;
+    }
+    vertex = changed;
+
+    this->emitPathChanged(item->missionId());
+}
+
+void MissionLineMapItemModel::onMissionItemsLoaded(int missionId)
+{
+    auto it = m_lines.find(missionId);
+    if (it == m_lines.end() || !it->visible) return;
+
+    it->vertices = this->vertices(missionId);
+    it->actual = false;
+    this->emitPathChanged(missionId);
 }
 
 QHash<int, QByteArray> MissionLineMapItemModel::roleNames() const
@@ -153,3 +263,103 @@ QModelIndex MissionLineMapItemModel::missionIndex(const dto::MissionPtr& mission
 {
     return this->index(m_missions.indexOf(mission));
 }
+
+void MissionLineMapItemModel::Line::rebuild()
+{
+    path.clear();
+    for (Vertex& vertex: vertices)
+    {
+        vertex.index = -1;
+        if (vertex.coordinate.isValid())
+        {
+            vertex.index = path.count();
+            path.append(QVariant::fromValue(vertex.coordinate));
+        }
+        else if (vertex.back && !path.isEmpty())
+        {
+            path.append(path.first()); // Return to home line
+        }
+    }
+    actual = true;
+}
+
+MissionLineMapItemModel::Vertex MissionLineMapItemModel::vertex(const dto::MissionItemPtr& item)
+{
+    Vertex vertex;
+    vertex.item = item;
+    vertex.sequence = item->sequence();
+
+    if (item->isPositionatedItem())
+    {
+        if (item->coordinate().isValid()) vertex.coordinate = item->coordinate();
+    }
+    else
+    {
+        vertex.back = item->command() == dto::MissionItem::Return;
+    }
+    return vertex;
+}
+
+bool MissionLineMapItemModel::sameContribution(const Vertex& first, const Vertex& second)
+{
+    return first.back == second.back &&
+            first.coordinate.isValid() == second.coordinate.isValid() &&
+            (!first.coordinate.isValid() || first.coordinate == second.coordinate);
+}
+
+bool MissionLineMapItemModel::isVisible(int missionId)
+{
+    return settings::Provider::value(settings::mission::mission + QString::number(missionId) +
+                                     "/" + settings::visibility).toBool();
+}
+
+int MissionLineMapItemModel::findVertex(const Line& line, const dto::MissionItemPtr& item)
+{
+    // Sequence of a changed item may be already new, so fall back to the full scan
+    auto position = std::lower_bound(line.vertices.begin(), line.vertices.end(),
+                                     item->sequence(),
+                                     [](const Vertex& vertex, int sequence) {
+        return vertex.sequence < sequence;
+    });
+    for (; position != line.vertices.end() && position->sequence == item->sequence(); ++position)
+    {
+        if (position->item == item) return position - line.vertices.begin();
+    }
+
+    for (int index = 0; index < line.vertices.count(); ++index)
+    {
+        if (line.vertices.at(index).item == item) return index;
+    }
+    return -1;
+}
+
+void MissionLineMapItemModel::insertVertex(Line& line, const Vertex& vertex)
+{
+    auto position = std::upper_bound(line.vertices.begin(), line.vertices.end(), vertex,
+                                     [](const Vertex& first, const Vertex& second) {
+        return first.sequence < second.sequence;
+    });
+    line.vertices.insert(position, vertex);
+}
+
+QVector<MissionLineMapItemModel::Vertex> MissionLineMapItemModel::vertices(int missionId)
+{
+    QVector<Vertex> vertices;
+    for (const dto::MissionItemPtr& item: m_service->missionItems(missionId))
+    {
+        vertices.append(MissionLineMapItemModel::vertex(item));
+    }
+    return vertices;
+}
+
+void MissionLineMapItemModel::emitPathChanged(int missionId)
+{
+    for (int row = 0; row < m_missions.count(); ++row)
+    {
+        if (m_missions.at(row)->id() != missionId) continue;
+
+        QModelIndex index = this->index(row);
+        emit dataChanged(index, index, { MissionPathRole });
+        return;
+    }
+}
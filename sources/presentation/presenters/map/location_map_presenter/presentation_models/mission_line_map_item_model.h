@@ -3,6 +3,7 @@
 
 // Qt
 #include <QAbstractListModel>
+#include <QGeoCoordinate>
 
 // Internal
 #include "dto_traits.h"
@@ -36,7 +37,10 @@ namespace presentation
         void onMissionRemoved(const dto::MissionPtr& mission);
         void onMissionChanged(const dto::MissionPtr& mission);
         void onAssignmentChanged(const dto::MissionAssignmentPtr& assignment);
+        void onMissionItemAdded(const dto::MissionItemPtr& item);
+        void onMissionItemRemoved(const dto::MissionItemPtr& item);
         void onMissionItemChanged(const dto::MissionItemPtr& item);
+        void onMissionItemsLoaded(int missionId);
 
     protected:
         QHash<int, QByteArray> roleNames() const override;
@@ -44,8 +48,40 @@ namespace presentation
         QModelIndex missionIndex(const dto::MissionPtr& mission) const;
 
     private:
+        // Item as it contributes to the path, copied to notice changes of the shared item
+        class Vertex
+        {
+        public:
+            dto::MissionItemPtr item;
+            int sequence = 0;
+            QGeoCoordinate coordinate; // Invalid when item has no point on the path
+            bool back = false; // Return to home
+            int index = -1; // In path
+        };
+
+        // Cached path of a mission, rebuilt lazily only when points are added, removed or moved
+        class Line
+        {
+        public:
+            bool visible = false;
+            QVector<Vertex> vertices; // By sequence, hidden missions are not loaded
+            QVariantList path;
+            bool actual = false;
+
+            void rebuild();
+        };
+
+        static Vertex vertex(const dto::MissionItemPtr& item);
+        static bool sameContribution(const Vertex& first, const Vertex& second);
+        static bool isVisible(int missionId);
+        static int findVertex(const Line& line, const dto::MissionItemPtr& item);
+        static void insertVertex(Line& line, const Vertex& vertex);
+        QVector<Vertex> vertices(int missionId);
+        void emitPathChanged(int missionId);
+
         domain::MissionService* m_service;
         dto::MissionPtrList m_missions;
+        mutable QHash<int, Line> m_lines;
     };
 }
 
@@ -1,6 +1,7 @@
 #include "mission_point_map_item_model.h"
 
 // Qt
+#include <QSet>
 #include <QDebug>
 
 // Internal
@@ -27,7 +28,10 @@ MissionPointMapItemModel::MissionPointMapItemModel(domain::MissionService* servi
             this, &MissionPointMapItemModel::onCurrentItemChanged);
     connect(service, &domain::MissionService::missionChanged,
             this, &MissionPointMapItemModel::onMissionChanged);
+    connect(service, &domain::MissionService::missionItemsLoaded,
+            this, &MissionPointMapItemModel::onMissionItemsLoaded);
 
+    // Items of the other missions come with missionItemsLoaded
     for (const dto::MissionItemPtr& item: service->missionItems())
     {
         this->onMissionItemAdded(item);
@@ -139,6 +143,27 @@ void MissionPointMapItemModel::onMissionChanged(const dto::MissionPtr& mission)
     }
 }
 
+void MissionPointMapItemModel::onMissionItemsLoaded(int missionId)
+{
+    // Some of them may be already here, read one by one before
+    QSet<int> present;
+    for (const dto::MissionItemPtr& item: m_items)
+    {
+        if (item->missionId() == missionId) present.insert(item->id());
+    }
+
+    dto::MissionItemPtrList loaded;
+    for (const dto::MissionItemPtr& item: m_service->missionItems(missionId))
+    {
+        if (!present.contains(item->id())) loaded.append(item);
+    }
+    if (loaded.isEmpty()) return;
+
+    this->beginInsertRows(QModelIndex(), m_items.count(), m_items.count() + loaded.count() - 1);
+    m_items.append(loaded);
+    this->endInsertRows();
+}
+
 QHash<int, QByteArray> MissionPointMapItemModel::roleNames() const
 {
     QHash<int, QByteArray> roles;
@@ -44,6 +44,7 @@ namespace presentation
                                   const dto::MissionItemPtr& old,
                                   const dto::MissionItemPtr& item);
         void onMissionChanged(const dto::MissionPtr& mission);
+        void onMissionItemsLoaded(int missionId);
 
     protected:
         QHash<int, QByteArray> roleNames() const override;
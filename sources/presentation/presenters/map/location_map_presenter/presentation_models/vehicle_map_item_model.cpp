@@ -2,7 +2,6 @@
 
 // Qt
 #include <QMap>
-#include <QGeoCoordinate>
 #include <QUrl>
 #include <QDebug>
 
@@ -15,6 +14,9 @@
 #include "telemetry_service.h"
 #include "telemetry.h"
 
+#include "vehicle_track.h"
+#include "update_coalescer.h"
+
 using namespace presentation;
 
 class VehicleMapItemModel::Impl
@@ -24,7 +26,8 @@ public:
     domain::TelemetryService* telemetryService;
 
     QList<int> vehicleIds;
-    QMap<int, QVariantList> tracks;
+    QMap<int, VehicleTrack> tracks;
+    QMap<int, QVector<int> > dirtyRoles; // Telemetry changes wait for the next frame
 };
 
 VehicleMapItemModel::VehicleMapItemModel(domain::VehicleService* vehicleService,
@@ -42,6 +45,8 @@ VehicleMapItemModel::VehicleMapItemModel(domain::VehicleService* vehicleService,
             this, &VehicleMapItemModel::onVehicleRemoved);
     connect(vehicleService, &domain::VehicleService::vehicleChanged,
             this, &VehicleMapItemModel::onVehicleChanged);
+    connect(UpdateCoalescer::instance(), &UpdateCoalescer::flush,
+            this, &VehicleMapItemModel::flush);
 
     for (const dto::VehiclePtr& vehicle: vehicleService->vehicles())
     {
@@ -126,7 +131,7 @@ QVariant VehicleMapItemModel::data(const QModelIndex& index, int role) const
         if (!data.isValid()) data = 0;
         break;
     case TrackRole:
-        data = d->tracks[vehicleId];
+        data = d->tracks.value(vehicleId).path();
         break;
     }
 
@@ -183,6 +188,7 @@ void VehicleMapItemModel::onVehicleRemoved(const dto::VehiclePtr& vehicle)
     this->beginRemoveRows(QModelIndex(), row, row);
     d->vehicleIds.removeOne(vehicle->id());
     d->tracks.remove(vehicle->id());
+    d->dirtyRoles.remove(vehicle->id());
 
     this->endRemoveRows();
 }
@@ -224,26 +230,47 @@ QModelIndex VehicleMapItemModel::vehicleIndex(int vehicleId) const
 void VehicleMapItemModel::onPositionParametersChanged(
         int vehicleId, const domain::Telemetry::TelemetryMap& parameters)
 {
-    QModelIndex index = this->vehicleIndex(vehicleId);
-    if (!index.isValid()) return;
+    if (!d->vehicleIds.contains(vehicleId)) return;
 
+    QVector<int> roles({ CoordinateRole });
     if (parameters.contains(domain::Telemetry::Coordinate))
     {
         auto coordinate = parameters[domain::Telemetry::Coordinate].value<QGeoCoordinate>();
         if (!coordinate.isValid()) return;
 
-        d->tracks[vehicleId].append(QVariant::fromValue(coordinate));
+        VehicleTrack& track = d->tracks[vehicleId];
+
+        int trackLength = settings::Provider::snapshot().trackLength.load();
+        if (track.length() != trackLength)
+        {
+            track.setLength(trackLength);
+            roles.append(TrackRole);
+        }
+
+        // Rebuilt track goes whole with TrackRole
+        VehicleTrack::Change change = track.add(coordinate);
+        if (change == VehicleTrack::Reset && !roles.contains(TrackRole)) roles.append(TrackRole);
 
-        int trackLength = settings::Provider::value(settings::map::trackLength).toInt();
-        if (trackLength > -1)
+        if (!roles.contains(TrackRole))
         {
-            while (d->tracks[vehicleId].length() > trackLength) {
-                d->tracks[vehicleId].removeFirst();
+            switch (change)
+            {
+            case VehicleTrack::Moved:
+                emit trackLastMoved(vehicleId, coordinate);
+                break;
+            case VehicleTrack::Appended:
+                emit trackAppended(vehicleId, coordinate, false);
+                break;
+            case VehicleTrack::Shifted:
+                emit trackAppended(vehicleId, coordinate, true);
+                break;
+            default:
+                break;
             }
         }
     }
 
-    emit dataChanged(index, index, { CoordinateRole });
+    this->markDirty(vehicleId, roles);
 }
 
 void VehicleMapItemModel::onHomeParametersChanged(
@@ -251,10 +278,9 @@ void VehicleMapItemModel::onHomeParametersChanged(
 {
     Q_UNUSED(parameters)
 
-    QModelIndex index = this->vehicleIndex(vehicleId);
-    if (!index.isValid()) return;
+    if (!d->vehicleIds.contains(vehicleId)) return;
 
-    emit dataChanged(index, index, { HomeCoordinateRole });
+    this->markDirty(vehicleId, { HomeCoordinateRole });
 }
 
 void VehicleMapItemModel::onTargetParametersChanged(
@@ -262,10 +288,9 @@ void VehicleMapItemModel::onTargetParametersChanged(
 {
     Q_UNUSED(parameters)
 
-    QModelIndex index = this->vehicleIndex(vehicleId);
-    if (!index.isValid()) return;
+    if (!d->vehicleIds.contains(vehicleId)) return;
 
-    emit dataChanged(index, index, { TargetCoordinateRole });
+    this->markDirty(vehicleId, { TargetCoordinateRole });
 }
 
 
@@ -274,10 +299,9 @@ void VehicleMapItemModel::onAhrsParametersChanged(
 {
     Q_UNUSED(parameters)
 
-    QModelIndex index = this->vehicleIndex(vehicleId);
-    if (!index.isValid()) return;
+    if (!d->vehicleIds.contains(vehicleId)) return;
 
-    emit dataChanged(index, index, { HeadingRole });
+    this->markDirty(vehicleId, { HeadingRole });
 }
 
 void VehicleMapItemModel::onSatelliteParametersChanged(
@@ -285,8 +309,28 @@ void VehicleMapItemModel::onSatelliteParametersChanged(
 {
     Q_UNUSED(parameters)
 
-    QModelIndex index = this->vehicleIndex(vehicleId);
-    if (!index.isValid()) return;
+    if (!d->vehicleIds.contains(vehicleId)) return;
 
-    emit dataChanged(index, index, { CourseRole, GroundspeedRole, SnsFixRole, HdopRadiusRole });
+    this->markDirty(vehicleId, { CourseRole, GroundspeedRole, SnsFixRole, HdopRadiusRole });
+}
+
+void VehicleMapItemModel::markDirty(int vehicleId, const QVector<int>& roles)
+{
+    QVector<int>& dirty = d->dirtyRoles[vehicleId];
+    for (int role: roles)
+    {
+        if (!dirty.contains(role)) dirty.append(role);
+    }
+
+    UpdateCoalescer::instance()->request();
+}
+
+void VehicleMapItemModel::flush()
+{
+    for (auto it = d->dirtyRoles.constBegin(); it != d->dirtyRoles.constEnd(); ++it)
+    {
+        QModelIndex index = this->vehicleIndex(it.key());
+        if (index.isValid()) emit dataChanged(index, index, it.value());
+    }
+    d->dirtyRoles.clear();
 }
@@ -3,6 +3,7 @@
 
 // Qt
 #include <QAbstractListModel>
+#include <QGeoCoordinate>
 
 // Internal
 #include "dto_traits.h"
@@ -48,6 +49,11 @@ namespace presentation
         int rowCount(const QModelIndex& parent = QModelIndex()) const override;
         QVariant data(const QModelIndex& index, int role) const override;
 
+    signals:
+        // Incremental track changes, TrackRole changes only when the track is rebuilt
+        void trackAppended(int vehicleId, const QGeoCoordinate& coordinate, bool shifted);
+        void trackLastMoved(int vehicleId, const QGeoCoordinate& coordinate);
+
     public slots:
         void onVehicleAdded(const dto::VehiclePtr& vehicle);
         void onVehicleRemoved(const dto::VehiclePtr& vehicle);
@@ -70,6 +76,9 @@ namespace presentation
         void onSatelliteParametersChanged(
                 int vehicleId, const domain::Telemetry::TelemetryMap& parameters);
 
+        void markDirty(int vehicleId, const QVector<int>& roles);
+        void flush();
+
     private:
         class Impl;
         QScopedPointer<Impl> const d;
@@ -0,0 +1,181 @@
+#include "vehicle_track.h"
+
+// Qt
+#include <QPointF>
+#include <QtMath>
+
+using namespace presentation;
+
+namespace
+{
+    const double tolerance = 1.0; // m, initial one
+    const int unlimitedPoints = 4096;
+    const int maxPassed = 64; // Positions checked against the segment
+    const double earthRadius = 6371000.0; // m
+
+    // Local plane in meters around the origin, good enough for tolerance checks
+    QPointF project(const QGeoCoordinate& origin, const QGeoCoordinate& coordinate)
+    {
+        return QPointF(qDegreesToRadians(coordinate.longitude() - origin.longitude()) *
+                       ::earthRadius * qCos(qDegreesToRadians(origin.latitude())),
+                       qDegreesToRadians(coordinate.latitude() - origin.latitude()) *
+                       ::earthRadius);
+    }
+
+    // Segment from origin to the end
+    double segmentDistance(const QPointF& point, const QPointF& end)
+    {
+        double length = QPointF::dotProduct(end, end);
+        double position = length > 0 ?
+                              qBound(0.0, QPointF::dotProduct(point, end) / length, 1.0) : 0;
+        QPointF offset = point - end * position;
+        return qSqrt(QPointF::dotProduct(offset, offset));
+    }
+}
+
+VehicleTrack::VehicleTrack(int length):
+    m_length(length),
+    m_tolerance(::tolerance),
+    m_points(length > -1 ? length : ::unlimitedPoints)
+{}
+
+int VehicleTrack::length() const
+{
+    return m_length;
+}
+
+void VehicleTrack::setLength(int length)
+{
+    if (m_length == length) return;
+
+    QVector<QGeoCoordinate> points;
+    int capacity = length > -1 ? length : ::unlimitedPoints;
+    for (int index = qMax(0, m_count - capacity); index < m_count; ++index)
+    {
+        points.append(this->at(index));
+    }
+
+    m_length = length;
+    m_points = QVector<QGeoCoordinate>(capacity);
+    this->clear();
+    for (const QGeoCoordinate& point: points) this->append(point);
+}
+
+int VehicleTrack::count() const
+{
+    return m_count;
+}
+
+double VehicleTrack::tolerance() const
+{
+    return m_tolerance;
+}
+
+const QGeoCoordinate& VehicleTrack::at(int index) const
+{
+    int slot = m_first + index;
+    return m_points.at(slot < m_points.count() ? slot : slot - m_points.count());
+}
+
+QVariantList VehicleTrack::path() const
+{
+    QVariantList path;
+    path.reserve(m_count);
+    for (int index = 0; index < m_count; ++index)
+    {
+        path.append(QVariant::fromValue(this->at(index)));
+    }
+    return path;
+}
+
+VehicleTrack::Change VehicleTrack::add(const QGeoCoordinate& coordinate)
+{
+    if (m_points.isEmpty()) return Unchanged;
+
+    // Jitter in place, track end keeps close to the vehicle whatever the tolerance is
+    if (m_count)
+    {
+        QPointF offset = ::project(this->at(m_count - 1), coordinate);
+        if (QPointF::dotProduct(offset, offset) < ::tolerance * ::tolerance) return Unchanged;
+    }
+
+    if (m_count > 1 && m_passed.count() < ::maxPassed && this->covers(coordinate))
+    {
+        int slot = m_first + m_count - 1;
+        if (slot >= m_points.count()) slot -= m_points.count();
+        QGeoCoordinate& last = m_points[slot];
+
+        m_passed.append(last);
+        last = coordinate;
+        return Moved;
+    }
+
+    m_passed.clear();
+
+    if (m_count < m_points.count())
+    {
+        this->append(coordinate);
+        return Appended;
+    }
+
+    if (m_length > -1)
+    {
+        if (++m_first == m_points.count()) m_first = 0;
+        m_count--;
+        this->append(coordinate);
+        return Shifted;
+    }
+
+    this->simplify();
+    this->append(coordinate);
+    return Reset;
+}
+
+void VehicleTrack::clear()
+{
+    m_first = 0;
+    m_count = 0;
+    m_tolerance = ::tolerance;
+    m_passed.clear();
+}
+
+bool VehicleTrack::covers(const QGeoCoordinate& coordinate) const
+{
+    const QGeoCoordinate& origin = this->at(m_count - 2);
+    QPointF end = ::project(origin, coordinate);
+
+    if (::segmentDistance(::project(origin, this->at(m_count - 1)), end) > m_tolerance)
+    {
+        return false;
+    }
+
+    for (const QGeoCoordinate& passed: m_passed)
+    {
+        if (::segmentDistance(::project(origin, passed), end) > m_tolerance) return false;
+    }
+    return true;
+}
+
+void VehicleTrack::append(const QGeoCoordinate& coordinate)
+{
+    int slot = m_first + m_count;
+    m_points[slot < m_points.count() ? slot : slot - m_points.count()] = coordinate;
+    m_count++;
+}
+
+void VehicleTrack::simplify()
+{
+    // Until half of the ring is free, a pass never gives more points than it takes
+    QVector<QGeoCoordinate> points;
+    while (m_count > m_points.count() / 2)
+    {
+        points.clear();
+        for (int index = 0; index < m_count; ++index) points.append(this->at(index));
+
+        double tolerance = m_tolerance * 2;
+        this->clear();
+        m_tolerance = tolerance;
+        for (const QGeoCoordinate& point: points) this->add(point);
+    }
+    m_passed.clear();
+}
@@ -0,0 +1,57 @@
+#ifndef VEHICLE_TRACK_H
+#define VEHICLE_TRACK_H
+
+// Qt
+#include <QVector>
+#include <QVariantList>
+#include <QGeoCoordinate>
+
+namespace presentation
+{
+    // Ring of track points simplified online: new position moves the last point while the
+    // positions passed since the previous point stay within tolerance of the segment. Limited
+    // track drops the oldest point when full, unlimited one is simplified again with doubled
+    // tolerance, so memory stays bounded either way.
+    class VehicleTrack
+    {
+    public:
+        enum Change
+        {
+            Unchanged,
+            Moved, // Last point
+            Appended,
+            Shifted, // Appended, the oldest point is dropped
+            Reset
+        };
+
+        explicit VehicleTrack(int length = -1); // In points, -1 for unlimited
+
+        int length() const;
+        void setLength(int length); // Keeps the newest points
+
+        int count() const;
+        double tolerance() const; // Meters
+
+        const QGeoCoordinate& at(int index) const; // Zero is the oldest point
+        QVariantList path() const;
+
+        Change add(const QGeoCoordinate& coordinate);
+        void clear();
+
+    private:
+        bool covers(const QGeoCoordinate& coordinate) const;
+        void append(const QGeoCoordinate& coordinate);
+        void simplify();
+
+        int m_length;
+        double m_tolerance;
+
+        QVector<QGeoCoordinate> m_points;
+        int m_first = 0;
+        int m_count = 0;
+
+        QVector<QGeoCoordinate> m_passed; // Since the point before the last one
+    };
+}
+
+#endif // VEHICLE_TRACK_H
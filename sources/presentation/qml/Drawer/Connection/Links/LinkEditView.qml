@@ -28,6 +28,8 @@ ColumnLayout {
     property alias port: portBox.value
     property alias endpoints: endpointList.endpoints
     property alias autoResponse: autoResponseBox.checked
+    property alias path: pathField.text
+    property alias speed: speedBox.realValue
 
     onChangedChanged: {
         if (changed) return;
@@ -66,6 +68,7 @@ ColumnLayout {
                 case LinkDescription.Udp: return str + ": " + qsTr("UDP");
                 case LinkDescription.Tcp: return str + ": " + qsTr("TCP");
                 case LinkDescription.Bluetooth: return str + ": " + qsTr("Bluetooth");
+                case LinkDescription.Replay: return str + ": " + qsTr("Replay");
                 default: return str + ": " + qsTr("Unknown");
                 }
             }
@@ -199,6 +202,24 @@ ColumnLayout {
         Layout.fillWidth: true
     }
 
+    Controls.TextField {
+        id: pathField
+        labelText: qsTr("Flight log")
+        visible: type == LinkDescription.Replay
+        onTextChanged: changed = true
+        Layout.fillWidth: true
+    }
+
+    Controls.RealSpinBox {
+        id: speedBox
+        labelText: qsTr("Speed (0 - max)")
+        visible: type == LinkDescription.Replay
+        realFrom: 0
+        realTo: 100
+        onRealValueChanged: changed = true
+        Layout.fillWidth: true
+    }
+
     Item {
         Layout.fillHeight: true
         Layout.fillWidth: true
@@ -85,6 +85,12 @@ Item {
                 implicitWidth: parent.width
                 onTriggered: presenter.addBluetoothLink()
             }
+
+            Controls.MenuItem {
+                text: qsTr("Replay")
+                implicitWidth: parent.width
+                onTriggered: presenter.addReplayLink()
+            }
         }
     }
 }
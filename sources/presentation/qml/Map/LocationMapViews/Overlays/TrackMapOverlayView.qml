@@ -4,11 +4,31 @@ import QtPositioning 5.6
 import Industrial.Indicators 1.0 as Indicators
 
 MapItemView {
+    id: root
+
     delegate: MapPolyline {
+        id: polyline
         line.width: 3
         line.color: Indicators.Theme.activeColor
         path: track
         smooth: true
         z: 100
+
+        // Whole track comes only when it is rebuilt, positions go one by one
+        Connections {
+            target: root.model
+            ignoreUnknownSignals: true
+            onTrackAppended: {
+                if (vehicleId !== model.vehicleId) return;
+
+                if (shifted && polyline.pathLength() > 0) polyline.removeCoordinate(0);
+                polyline.addCoordinate(coordinate);
+            }
+            onTrackLastMoved: {
+                if (vehicleId !== model.vehicleId || polyline.pathLength() === 0) return;
+
+                polyline.replaceCoordinate(polyline.pathLength() - 1, coordinate);
+            }
+        }
     }
 }
@@ -24,6 +24,17 @@ namespace settings
         const QString tcpAddress = "Communication/tcpAddress";
         const QString bluetoothAddress = "Communication/bluetoothAddress";
         const QString statisticsCount = "Communication/statisticsCount";
+        const QString tlogEnabled = "Communication/tlogEnabled";
+        const QString tlogDirectory = "Communication/tlogDirectory";
+        const QString linkThreads = "Communication/linkThreads";
+    }
+
+    namespace telemetry
+    {
+        const QString historyBudget = "Telemetry/historyBudget";
+        const QString historyCapacity = "Telemetry/historyCapacity";
+        const QString archiveEnabled = "Telemetry/archiveEnabled";
+        const QString archiveDirectory = "Telemetry/archiveDirectory";
     }
 
     namespace parameters
@@ -114,6 +125,7 @@ namespace settings
         const QString fdRelativeAltitude = "Gui/fdRelativeAltitude";
         const QString vibrationModelCount = "Gui/vibrationModelCount";
         const QString coordinatesDms = "Gui/coordinatesDms";
+        const QString updateInterval = "Gui/updateInterval";
     }
 
     namespace proxy
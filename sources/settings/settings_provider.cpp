@@ -2,6 +2,8 @@
 
 // Qt
 #include <QSettings>
+#include <QReadWriteLock>
+#include <QTimer>
 #include <QGeoCoordinate>
 #include <QDebug>
 
@@ -19,6 +21,8 @@ using namespace settings;
 
 namespace
 {
+    const int syncDelay = 1000; // Writes are collected and flushed to storage once a second
+
     QMap<QString, QVariant> defaultSettings =
     {
         { data_base::name, "jagcs_db" },
@@ -34,6 +38,14 @@ namespace
         { communication::tcpAddress, "127.0.0.1" },
         { communication::bluetoothAddress, "00:00:00:00:00:00" },
         { communication::statisticsCount, 50 },
+        { communication::tlogEnabled, false },
+        { communication::tlogDirectory, "tlogs" },
+        { communication::linkThreads, 2 }, // Zero keeps links in communication thread
+
+        { telemetry::historyBudget, 16777216 }, // 16 MiB
+        { telemetry::historyCapacity, 1024 }, // Samples per parameter
+        { telemetry::archiveEnabled, false },
+        { telemetry::archiveDirectory, "telemetry" },
 
         { parameters::defaultAcceptanceRadius, 3 },
         { parameters::defaultTakeoffPitch, 15 },
@@ -93,6 +105,7 @@ namespace
         { gui::fdRelativeAltitude, true },
         { gui::vibrationModelCount, 30 },
         { gui::coordinatesDms, true },
+        { gui::updateInterval, 0 },
 
         { proxy::type, 0 }
     };
@@ -102,32 +115,141 @@ class Provider::Impl
 {
 public:
     QSettings settings;
+    QReadWriteLock lock;
+    QHash<QString, QVariant> cache;
+    Snapshot snapshot;
+
+    class Field
+    {
+    public:
+        QAtomicInt* value;
+        bool flag; // Storage gives back "true" and "false" strings for flags
+    };
+    QHash<QString, Field> snapshotFields;
+    QTimer* syncTimer = nullptr;
 
     Impl():
         settings(QSettings::NativeFormat, QSettings::UserScope, "JAGCS", "JAGCS")
-    {}
+    {
+        snapshotFields[communication::autoAdd] = { &snapshot.autoAdd, true };
+        snapshotFields[communication::timeout] = { &snapshot.timeout, false };
+        snapshotFields[map::trackLength] = { &snapshot.trackLength, false };
+        snapshotFields[communication::statisticsCount] = { &snapshot.statisticsCount, false };
+    }
 
     void makeDefaults()
     {
         using namespace settings;
+        QWriteLocker locker(&lock);
         settings.clear();
+        cache.clear();
 
         for (const QString& key: ::defaultSettings.keys())
         {
             settings.setValue(key, ::defaultSettings[key]);
         }
     }
+
+    QVariant read(const QString& key)
+    {
+        {
+            QReadLocker locker(&lock);
+            auto it = cache.constFind(key);
+            if (it != cache.constEnd()) return it.value();
+        }
+
+        QWriteLocker locker(&lock);
+        if (!settings.contains(key)) settings.setValue(key, ::defaultSettings.value(key));
+
+        QVariant value = settings.value(key);
+        cache.insert(key, value);
+        return value;
+    }
+
+    void write(const QString& key, const QVariant& value)
+    {
+        {
+            QWriteLocker locker(&lock);
+            settings.setValue(key, value);
+            cache.insert(key, value);
+        }
+        this->updateSnapshot(key, value);
+    }
+
+    void remove(const QString& key)
+    {
+        {
+            QWriteLocker locker(&lock);
+            settings.remove(key);
+
+            // Removing group drops all nested keys
+            QString group = key + "/";
+            for (auto it = cache.begin(); it != cache.end();)
+            {
+                if (it.key() == key || it.key().startsWith(group)) it = cache.erase(it);
+                else ++it;
+            }
+        }
+
+        for (const QString& field: snapshotFields.keys())
+        {
+            if (field != key && !field.startsWith(key + "/")) continue;
+
+            this->updateSnapshot(field, this->read(field));
+        }
+    }
+
+    void updateSnapshot(const QString& key, const QVariant& value)
+    {
+        auto it = snapshotFields.constFind(key);
+        if (it == snapshotFields.constEnd()) return;
+
+        it->value->storeRelease(it->flag ? value.toBool() : value.toInt());
+    }
+
+    void updateSnapshot()
+    {
+        for (const QString& key: snapshotFields.keys()) this->updateSnapshot(key, this->read(key));
+    }
+
+    void scheduleSync()
+    {
+        // Timer lives in the provider's thread, writers may come from any thread
+        QMetaObject::invokeMethod(syncTimer, "start", Qt::QueuedConnection);
+    }
+
+    void sync()
+    {
+        QWriteLocker locker(&lock);
+        settings.sync();
+    }
+
+    void reload()
+    {
+        {
+            QWriteLocker locker(&lock);
+            settings.sync();
+            cache.clear();
+        }
+        this->updateSnapshot();
+    }
 };
 
 Provider::Provider():
     d(new Impl())
 {
     if (d->settings.allKeys().isEmpty()) d->makeDefaults();
+    d->updateSnapshot();
+
+    d->syncTimer = new QTimer(this);
+    d->syncTimer->setInterval(::syncDelay);
+    d->syncTimer->setSingleShot(true);
+    connect(d->syncTimer, &QTimer::timeout, this, [this]() { d->sync(); });
 }
 
 Provider::~Provider()
 {
-    d->settings.sync();
+    d->sync();
 }
 
 Provider* Provider::instance()
@@ -136,13 +258,14 @@ Provider* Provider::instance()
     return &settings;
 }
 
+const Provider::Snapshot& Provider::snapshot()
+{
+    return instance()->d->snapshot;
+}
+
 QVariant Provider::value(const QString& key)
 {
-    if (!instance()->d->settings.contains(key))
-    {
-        instance()->d->settings.setValue(key, ::defaultSettings.value(key));
-    }
-    return instance()->d->settings.value(key);
+    return instance()->d->read(key);
 }
 
 bool Provider::boolValue(const QString& key)
@@ -152,20 +275,36 @@ bool Provider::boolValue(const QString& key)
 
 void Provider::setValue(const QString& key, const QVariant& value)
 {
-    instance()->d->settings.setValue(key, value);
+    Provider* provider = instance();
+    provider->d->write(key, value);
+    provider->d->scheduleSync();
+
+    emit provider->valueChanged(key, value);
 }
 
 void Provider::remove(const QString& key)
 {
-    instance()->d->settings.remove(key);
+    Provider* provider = instance();
+    provider->d->remove(key);
+    provider->d->scheduleSync();
+
+    emit provider->valueChanged(key, QVariant());
 }
 
 void Provider::makeDefaults()
 {
-    instance()->d->makeDefaults();
+    Provider* provider = instance();
+    provider->d->makeDefaults();
+    provider->d->updateSnapshot();
+    provider->d->scheduleSync();
 }
 
 void Provider::sync()
 {
-    instance()->d->settings.sync();
+    instance()->d->sync();
+}
+
+void Provider::reload()
+{
+    instance()->d->reload();
 }
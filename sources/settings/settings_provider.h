@@ -3,6 +3,7 @@
 
 // Qt
 #include <QVariant>
+#include <QAtomicInt>
 
 // Internal
 #include "settings.h"
@@ -14,8 +15,19 @@ namespace settings
         Q_OBJECT
 
     public:
+        // Settings read on hot paths, kept up to date on every write
+        class Snapshot
+        {
+        public:
+            QAtomicInt autoAdd;
+            QAtomicInt timeout;
+            QAtomicInt trackLength;
+            QAtomicInt statisticsCount;
+        };
+
         ~Provider() override;
         static Provider* instance();
+        static const Snapshot& snapshot();
 
         Q_INVOKABLE static QVariant value(const QString& key);
         Q_INVOKABLE static bool boolValue(const QString& key);
@@ -24,6 +36,10 @@ namespace settings
 
         static void makeDefaults();
         static void sync();
+        static void reload(); // Drops cached values, storage is read again
+
+    signals:
+        void valueChanged(const QString& key, const QVariant& value);
 
     private:
         Provider();
@@ -0,0 +1,159 @@
+#include "mavlink_frame_parser_test.h"
+
+// MAVLink
+#include <mavlink.h>
+
+// Qt
+#include <QByteArray>
+#include <QVector>
+#include <QDebug>
+
+// Std
+#include <cstring>
+
+// Internal
+#include "mavlink_frame_parser.h"
+
+using namespace comm;
+
+namespace
+{
+    const quint8 referenceChannel = 1;
+
+    QByteArray toBytes(const mavlink_message_t& message)
+    {
+        quint8 buffer[MAVLINK_MAX_PACKET_LEN];
+        int length = mavlink_msg_to_send_buffer(buffer, &message);
+        return QByteArray(reinterpret_cast<const char*>(buffer), length);
+    }
+
+    QString describe(const mavlink_message_t& message)
+    {
+        return QString("%1:%2:%3:%4:%5").arg(message.msgid).arg(message.seq).arg(message.sysid).
+                arg(message.len).arg(message.checksum);
+    }
+}
+
+void MavLinkFrameParserTest::testCrc()
+{
+    QByteArray data("123456789 MAVLink X.25 checksum reference data");
+
+    for (int length = 0; length < data.length(); ++length)
+    {
+        quint16 reference;
+        crc_init(&reference);
+        for (int i = 0; i < length; ++i) crc_accumulate(quint8(data.at(i)), &reference);
+
+        QCOMPARE(MavLinkFrameParser::crc(reinterpret_cast<const quint8*>(data.constData()),
+                                         length), reference);
+    }
+}
+
+void MavLinkFrameParserTest::testParseStream()
+{
+    QByteArray stream;
+    mavlink_message_t message;
+
+    for (quint8 seq = 0; seq < 20; ++seq)
+    {
+        mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR,
+                                   MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+        stream.append(::toBytes(message));
+
+        mavlink_msg_attitude_pack(2, 1, &message, seq, 0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+        QByteArray attitude = ::toBytes(message);
+        if (seq == 7) attitude[attitude.length() - 1] = attitude.at(attitude.length() - 1) + 1;
+        stream.append(attitude);
+
+        if (seq % 5 == 0) stream.append("garbage");
+    }
+
+    QStringList reference;
+    mavlink_status_t referenceStatus;
+    for (int pos = 0; pos < stream.length(); ++pos)
+    {
+        if (mavlink_parse_char(::referenceChannel, quint8(stream.at(pos)),
+                               &message, &referenceStatus))
+        {
+            reference.append(::describe(message));
+        }
+    }
+
+    QStringList parsed;
+    mavlink_status_t status;
+    MavLinkFrameParser parser;
+
+    // Uneven chunks to get frames split between buffers
+    for (int offset = 0, chunk = 1; offset < stream.length(); offset += chunk, chunk += 7)
+    {
+        QByteArray data = stream.mid(offset, chunk);
+        const quint8* bytes = reinterpret_cast<const quint8*>(data.constData());
+
+        int pos = 0;
+        while (parser.parse(bytes, data.length(), pos, &message, &status))
+        {
+            parsed.append(::describe(message));
+        }
+    }
+
+    QCOMPARE(parsed, reference);
+    QCOMPARE(status.packet_rx_success_count, referenceStatus.packet_rx_success_count);
+    QCOMPARE(status.packet_rx_drop_count, referenceStatus.packet_rx_drop_count);
+}
+
+void MavLinkFrameParserTest::testIndependentContexts()
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(3, 1, &message, 42, 0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+    QByteArray frame = ::toBytes(message);
+    const quint8* bytes = reinterpret_cast<const quint8*>(frame.constData());
+    const int half = frame.length() / 2;
+
+    // Many more parsers than MAVLink static channels, each one in the middle of a frame
+    QVector<MavLinkFrameParser> parsers(MAVLINK_COMM_NUM_BUFFERS * 4);
+    mavlink_status_t status;
+
+    for (MavLinkFrameParser& parser: parsers)
+    {
+        int pos = 0;
+        QVERIFY(!parser.parse(bytes, half, pos, &message, &status));
+    }
+
+    for (MavLinkFrameParser& parser: parsers)
+    {
+        int pos = 0;
+        QVERIFY(parser.parse(bytes + half, frame.length() - half, pos, &message, &status));
+        QCOMPARE(message.sysid, quint8(3));
+        QCOMPARE(status.packet_rx_success_count, quint16(1));
+    }
+}
+
+void MavLinkFrameParserTest::testTruncatedPayload()
+{
+#ifdef MAVLINK_V2
+    // Zero speeds at the end of the payload are cut off by MAVLink 2 sender
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(4, 1, &message, 42, 0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+    QVERIFY(message.len < MAVLINK_MSG_ID_ATTITUDE_LEN);
+
+    QByteArray frame = ::toBytes(message);
+    const quint8* bytes = reinterpret_cast<const quint8*>(frame.constData());
+
+    // Leftovers of a previous longer message must not show through
+    std::memset(&message, 0xFF, sizeof(message));
+
+    MavLinkFrameParser parser;
+    mavlink_status_t status;
+    int pos = 0;
+    QVERIFY(parser.parse(bytes, frame.length(), pos, &message, &status));
+
+    // Getters read the payload as is, unlike decode which zeroes the struct first
+    QCOMPARE(mavlink_msg_attitude_get_time_boot_ms(&message), quint32(42));
+    QCOMPARE(mavlink_msg_attitude_get_yaw(&message), 0.3f);
+    QCOMPARE(mavlink_msg_attitude_get_rollspeed(&message), 0.0f);
+    QCOMPARE(mavlink_msg_attitude_get_pitchspeed(&message), 0.0f);
+    QCOMPARE(mavlink_msg_attitude_get_yawspeed(&message), 0.0f);
+#else
+    QSKIP("Payload truncation is MAVLink 2 only");
+#endif
+}
@@ -0,0 +1,17 @@
+#ifndef MAVLINK_FRAME_PARSER_TEST_H
+#define MAVLINK_FRAME_PARSER_TEST_H
+
+#include <QTest>
+
+class MavLinkFrameParserTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCrc();
+    void testParseStream();
+    void testIndependentContexts();
+    void testTruncatedPayload();
+};
+
+#endif // MAVLINK_FRAME_PARSER_TEST_H
@@ -0,0 +1,122 @@
+#include "mavlink_router_test.h"
+
+// MAVLink
+#include <mavlink.h>
+
+// Internal
+#include "mavlink_router.h"
+#include "udp_link.h"
+
+using namespace comm;
+
+void MavLinkRouterTest::testRoute()
+{
+    UdpLink link1, link2, link3;
+    AbstractLink* vehicleLink = &link1;
+    AbstractLink* otherVehicleLink = &link2;
+    AbstractLink* toolLink = &link3;
+    QList<AbstractLink*> links = { vehicleLink, otherVehicleLink, toolLink };
+    MavLinkRouter router;
+    mavlink_message_t message;
+
+    mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR,
+                               MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+    QVERIFY(router.learn(message, vehicleLink));
+
+    mavlink_msg_heartbeat_pack(2, 1, &message, MAV_TYPE_QUADROTOR,
+                               MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+    QVERIFY(router.learn(message, otherVehicleLink));
+
+    QCOMPARE(router.link(1, 1), vehicleLink);
+    QCOMPARE(router.link(2, 1), otherVehicleLink);
+    QCOMPARE(router.link(3, 1), static_cast<AbstractLink*>(nullptr));
+
+    // Broadcast goes to every link except the source
+    MavLinkRouter::Links targets = router.route(message, otherVehicleLink, links);
+    QCOMPARE(targets.count(), 2);
+    QVERIFY(targets.contains(vehicleLink));
+    QVERIFY(targets.contains(toolLink));
+
+#ifdef MAVLINK_V2
+    // Targeted command goes to the owner only, unknown targets are not flooded
+    mavlink_msg_command_long_pack(255, 190, &message, 1, 1, MAV_CMD_COMPONENT_ARM_DISARM,
+                                  0, 1, 0, 0, 0, 0, 0, 0);
+    targets = router.route(message, toolLink, links);
+    QCOMPARE(targets.count(), 1);
+    QCOMPARE(targets.first(), vehicleLink);
+
+    mavlink_msg_command_long_pack(255, 190, &message, 2, 0, MAV_CMD_COMPONENT_ARM_DISARM,
+                                  0, 1, 0, 0, 0, 0, 0, 0);
+    targets = router.route(message, toolLink, links);
+    QCOMPARE(targets.count(), 1);
+    QCOMPARE(targets.first(), otherVehicleLink);
+
+    mavlink_msg_command_long_pack(255, 190, &message, 3, 1, MAV_CMD_COMPONENT_ARM_DISARM,
+                                  0, 1, 0, 0, 0, 0, 0, 0);
+    QVERIFY(router.route(message, toolLink, links).isEmpty());
+
+    router.removeLink(vehicleLink);
+    mavlink_msg_command_long_pack(255, 190, &message, 1, 1, MAV_CMD_COMPONENT_ARM_DISARM,
+                                  0, 1, 0, 0, 0, 0, 0, 0);
+    QVERIFY(router.route(message, toolLink, links).isEmpty());
+#endif
+}
+
+void MavLinkRouterTest::testDuplicates()
+{
+    UdpLink link1, link2;
+    AbstractLink* radio1 = &link1;
+    AbstractLink* radio2 = &link2;
+    MavLinkRouter router;
+    mavlink_message_t message;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        mavlink_msg_attitude_pack(1, 1, &message, i, 0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+        message.seq = quint8(i);
+
+        QVERIFY(router.learn(message, radio1, i * 10));
+        QVERIFY(!router.learn(message, radio2, i * 10 + 50)); // Same frame through the second radio
+    }
+    QCOMPARE(router.link(1, 1), radio1);
+
+    // Late copy from the redundant radio is a new frame
+    QVERIFY(router.learn(message, radio2, 299 * 10 + 1000));
+    QCOMPARE(router.link(1, 1), radio2);
+}
+
+void MavLinkRouterTest::testConstantSequence()
+{
+    UdpLink link;
+    MavLinkRouter router;
+    mavlink_message_t message;
+
+    // Some sources never advance the sequence and send the same frame over and over
+    mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR,
+                               MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+    message.seq = 0;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        QVERIFY(router.learn(message, &link, i));
+    }
+}
+
+void MavLinkRouterTest::testLossyLink()
+{
+    UdpLink link1, link2;
+    AbstractLink* radio1 = &link1;
+    AbstractLink* radio2 = &link2;
+    MavLinkRouter router;
+    mavlink_message_t message;
+
+    // Lossy radio wraps the sequence within a few frames, real frames still go through
+    for (int i = 0; i < 1000; ++i)
+    {
+        mavlink_msg_attitude_pack(1, 1, &message, i, 0.1, 0.2, 0.3, 0.0, 0.0, 0.0);
+        message.seq = quint8(i);
+
+        if (i % 5 == 0) QVERIFY(router.learn(message, radio1, i));
+        if (i % 3 == 0) QCOMPARE(router.learn(message, radio2, i), i % 5 != 0);
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef MAVLINK_ROUTER_TEST_H
+#define MAVLINK_ROUTER_TEST_H
+
+#include <QTest>
+
+class MavLinkRouterTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoute();
+    void testDuplicates();
+    void testConstantSequence();
+    void testLossyLink();
+};
+
+#endif // MAVLINK_ROUTER_TEST_H
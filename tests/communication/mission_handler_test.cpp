@@ -0,0 +1,432 @@
+#include "mission_handler_test.h"
+
+// MAVLink
+#include <mavlink.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QDebug>
+
+// Internal
+#include "abstract_link.h"
+#include "mavlink_communicator.h"
+#include "mavlink_frame_parser.h"
+#include "mission_handler.h"
+#include "mission_transfer.h"
+
+#include "service_registry.h"
+#include "mission_service.h"
+#include "vehicle_service.h"
+#include "mission.h"
+#include "mission_item.h"
+#include "mission_assignment.h"
+#include "vehicle.h"
+
+using namespace comm;
+
+namespace
+{
+    const quint8 mavId = 42;
+    const quint8 gcsId = 255;
+    const quint8 gcsComponentId = 190;
+
+    // Vehicle end of the link, frames sent to it are parsed back
+    class FakeLink: public AbstractLink
+    {
+    public:
+        bool isConnected() const override
+        {
+            return true;
+        }
+
+        void connectLink() override {}
+        void disconnectLink() override {}
+
+        void receive(mavlink_message_t message)
+        {
+            quint8 buffer[MAVLINK_MAX_PACKET_LEN];
+            int length = mavlink_msg_to_send_buffer(buffer, &message);
+            this->receiveData(reinterpret_cast<const char*>(buffer), length);
+        }
+
+        // Frames are written on the next event loop pass
+        QList<mavlink_message_t> take(quint32 messageId)
+        {
+            QCoreApplication::processEvents();
+
+            QList<mavlink_message_t> taken;
+            for (auto it = m_sent.begin(); it != m_sent.end();)
+            {
+                if (it->msgid != messageId)
+                {
+                    ++it;
+                    continue;
+                }
+
+                taken.append(*it);
+                it = m_sent.erase(it);
+            }
+            return taken;
+        }
+
+        bool contains(quint32 messageId) const
+        {
+            for (const mavlink_message_t& message: m_sent)
+            {
+                if (message.msgid == messageId) return true;
+            }
+            return false;
+        }
+
+    protected:
+        bool sendDataImpl(const QByteArray& data) override
+        {
+            const quint8* bytes = reinterpret_cast<const quint8*>(data.constData());
+            mavlink_message_t message;
+            mavlink_status_t status;
+
+            int pos = 0;
+            while (m_parser.parse(bytes, data.size(), pos, &message, &status))
+            {
+                m_sent.append(message);
+            }
+            return true;
+        }
+
+    private:
+        MavLinkFrameParser m_parser;
+        QList<mavlink_message_t> m_sent;
+    };
+
+    mavlink_message_t heartbeat()
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(::mavId, 1, &message, MAV_TYPE_QUADROTOR,
+                                   MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+        return message;
+    }
+
+    mavlink_message_t missionCount(int count)
+    {
+        mavlink_mission_count_t countMessage = mavlink_mission_count_t();
+        countMessage.target_system = ::gcsId;
+        countMessage.target_component = ::gcsComponentId;
+        countMessage.count = count;
+
+        mavlink_message_t message;
+        mavlink_msg_mission_count_encode(::mavId, 1, &message, &countMessage);
+        return message;
+    }
+
+    mavlink_message_t missionItem(int seq, bool isInt)
+    {
+        mavlink_message_t message;
+        if (isInt)
+        {
+            mavlink_mission_item_int_t item = mavlink_mission_item_int_t();
+            item.target_system = ::gcsId;
+            item.target_component = ::gcsComponentId;
+            item.seq = seq;
+            item.command = MAV_CMD_NAV_WAYPOINT;
+            item.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+            item.x = 557000000 + seq;
+            item.y = 376000000 + seq;
+            item.z = 100;
+
+            mavlink_msg_mission_item_int_encode(::mavId, 1, &message, &item);
+        }
+        else
+        {
+            mavlink_mission_item_t item = mavlink_mission_item_t();
+            item.target_system = ::gcsId;
+            item.target_component = ::gcsComponentId;
+            item.seq = seq;
+            item.command = MAV_CMD_NAV_WAYPOINT;
+            item.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT;
+            item.x = 55.7f;
+            item.y = 37.6f;
+            item.z = 100;
+
+            mavlink_msg_mission_item_encode(::mavId, 1, &message, &item);
+        }
+        return message;
+    }
+
+    mavlink_message_t missionRequest(int seq)
+    {
+        mavlink_mission_request_int_t request = mavlink_mission_request_int_t();
+        request.target_system = ::gcsId;
+        request.target_component = ::gcsComponentId;
+        request.seq = seq;
+
+        mavlink_message_t message;
+        mavlink_msg_mission_request_int_encode(::mavId, 1, &message, &request);
+        return message;
+    }
+
+    mavlink_message_t missionAck(quint8 type)
+    {
+        mavlink_mission_ack_t ack = mavlink_mission_ack_t();
+        ack.target_system = ::gcsId;
+        ack.target_component = ::gcsComponentId;
+        ack.type = type;
+
+        mavlink_message_t message;
+        mavlink_msg_mission_ack_encode(::mavId, 1, &message, &ack);
+        return message;
+    }
+
+    QList<int> requestedItems(const QList<mavlink_message_t>& requests)
+    {
+        QList<int> sequences;
+        for (const mavlink_message_t& request: requests)
+        {
+            sequences.append(request.msgid == MAVLINK_MSG_ID_MISSION_REQUEST_INT ?
+                                 mavlink_msg_mission_request_int_get_seq(&request) :
+                                 mavlink_msg_mission_request_get_seq(&request));
+        }
+        return sequences;
+    }
+
+    // Vehicle of the test mav id with a mission of waypoints assigned
+    dto::MissionAssignmentPtr assignMission(int count)
+    {
+        domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+        domain::VehicleService* vehicleService = domain::ServiceRegistry::vehicleService();
+
+        dto::VehiclePtr vehicle = dto::VehiclePtr::create();
+        vehicle->setName("Mission handler vehicle");
+        vehicle->setMavId(::mavId);
+        if (!vehicleService->save(vehicle)) return dto::MissionAssignmentPtr();
+
+        dto::MissionPtr mission = dto::MissionPtr::create();
+        mission->setName("Mission handler mission");
+        if (!missionService->save(mission)) return dto::MissionAssignmentPtr();
+
+        dto::MissionItemPtrList items;
+        for (int sequence = 0; sequence < count; ++sequence)
+        {
+            dto::MissionItemPtr item = dto::MissionItemPtr::create();
+            item->setMissionId(mission->id());
+            item->setCommand(dto::MissionItem::Waypoint);
+            item->setSequence(sequence);
+            item->setLatitude(55.7 + sequence * 0.001);
+            item->setLongitude(37.6);
+            item->setAltitude(100);
+            items.append(item);
+        }
+        if (!items.isEmpty() && !missionService->save(items)) return dto::MissionAssignmentPtr();
+
+        dto::MissionAssignmentPtr assignment = dto::MissionAssignmentPtr::create();
+        assignment->setMissionId(mission->id());
+        assignment->setVehicleId(vehicle->id());
+        if (!missionService->save(assignment)) return dto::MissionAssignmentPtr();
+
+        return assignment;
+    }
+
+    void removeMission(const dto::MissionAssignmentPtr& assignment)
+    {
+        domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+        domain::VehicleService* vehicleService = domain::ServiceRegistry::vehicleService();
+
+        dto::MissionPtr mission = missionService->mission(assignment->missionId());
+        dto::VehiclePtr vehicle = vehicleService->vehicle(assignment->vehicleId());
+
+        missionService->remove(assignment);
+        if (mission) missionService->remove(mission);
+        if (vehicle) vehicleService->remove(vehicle);
+    }
+}
+
+void MissionHandlerTest::testChangedRanges()
+{
+    dto::MissionItemPtrList items;
+    for (int sequence = 0; sequence < 20; ++sequence)
+    {
+        dto::MissionItemPtr item = dto::MissionItemPtr::create();
+        item->setSequence(sequence);
+        item->setStatus(dto::MissionItem::Actual);
+        items.append(item);
+    }
+    QVERIFY(MissionTransfer::changedRanges(items).isEmpty());
+
+    // Close changes are written together, far ones in separate ranges
+    for (int sequence: { 2, 3, 7, 12, 19 })
+    {
+        items.at(sequence)->setStatus(dto::MissionItem::NotActual);
+    }
+
+    QList<QPair<int, int> > ranges = MissionTransfer::changedRanges(items);
+    QCOMPARE(ranges.count(), 3);
+    QCOMPARE(ranges.at(0), qMakePair(2, 7));
+    QCOMPARE(ranges.at(1), qMakePair(12, 12));
+    QCOMPARE(ranges.at(2), qMakePair(19, 19));
+}
+
+void MissionHandlerTest::testTimeout()
+{
+    MissionTransfer transfer;
+
+    // Default interval until round trip is measured, doubled on each retry up to the limit
+    QCOMPARE(transfer.timeout(), 2000);
+    transfer.retries = 1;
+    QCOMPARE(transfer.timeout(), 4000);
+    transfer.retries = 3;
+    QCOMPARE(transfer.timeout(), 8000);
+    transfer.retries = 0;
+
+    MissionTransfer::Request request;
+    transfer.addRoundTrip(request, 100); // Never sent
+    QVERIFY(!transfer.measured);
+
+    MissionTransfer::stamp(request, 1000);
+    transfer.addRoundTrip(request, 1100);
+    QVERIFY(transfer.measured);
+    QCOMPARE(transfer.timeout(), 300); // Round trip and four variations
+
+    transfer.retries = 2;
+    QCOMPARE(transfer.timeout(), 1200);
+    transfer.retries = 0;
+
+    // Answer to a repeated request can belong to any of them, it is no sample
+    MissionTransfer::stamp(request, 2000);
+    QVERIFY(request.repeated);
+    transfer.addRoundTrip(request, 5000);
+    QCOMPARE(transfer.timeout(), 300);
+
+    MissionTransfer::Request fast;
+    MissionTransfer::stamp(fast, 0);
+    transfer.addRoundTrip(fast, 10);
+    QCOMPARE(transfer.timeout(), 329);
+
+    MissionTransfer fastTransfer;
+    fastTransfer.addRoundTrip(fast, 10);
+    QCOMPARE(fastTransfer.timeout(), 200); // Lower bound
+}
+
+void MissionHandlerTest::testDownloadWindow()
+{
+    dto::MissionAssignmentPtr assignment = ::assignMission(0);
+    QVERIFY2(assignment, "Can't assign mission");
+
+    FakeLink link;
+    MavLinkCommunicator communicator(::gcsId, ::gcsComponentId, false);
+    MissionHandler* handler = new MissionHandler(&communicator);
+    communicator.addHandler(handler);
+    communicator.addLink(&link);
+    link.receive(::heartbeat());
+
+    handler->download(assignment);
+    QCOMPARE(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_LIST).count(), 1);
+
+    // Window of requests is outstanding at once, each answer moves it
+    link.receive(::missionCount(10));
+    QCOMPARE(::requestedItems(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT)),
+             QList<int>({ 0, 1, 2, 3 }));
+
+    link.receive(::missionItem(0, true));
+    QCOMPARE(::requestedItems(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT)), QList<int>({ 4 }));
+
+    // Vehicle serving requests only in order, the rest goes one by one from the first lost
+    link.receive(::missionAck(MAV_MISSION_INVALID_SEQUENCE));
+    QCOMPARE(::requestedItems(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT)), QList<int>({ 1 }));
+
+    link.receive(::missionItem(1, true));
+    QCOMPARE(::requestedItems(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT)), QList<int>({ 2 }));
+
+    handler->cancelSync(assignment); // Saves downloaded items
+
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+    dto::MissionItemPtr item = missionService->missionItem(assignment->missionId(), 1);
+    QVERIFY(item);
+    QCOMPARE(item->status(), dto::MissionItem::Actual);
+    QVERIFY(qFuzzyCompare(item->latitude(), 55.7000001));
+
+    ::removeMission(assignment);
+}
+
+void MissionHandlerTest::testItemIntFallback()
+{
+    dto::MissionAssignmentPtr assignment = ::assignMission(0);
+    QVERIFY2(assignment, "Can't assign mission");
+
+    FakeLink link;
+    MavLinkCommunicator communicator(::gcsId, ::gcsComponentId, false);
+    MissionHandler* handler = new MissionHandler(&communicator);
+    communicator.addHandler(handler);
+    communicator.addLink(&link);
+    link.receive(::heartbeat());
+
+    handler->download(assignment);
+    link.receive(::missionCount(3));
+    QCOMPARE(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT).count(), 3);
+
+    // Vehicle without MISSION_ITEM_INT ignores requests, they go again as MISSION_REQUEST
+    QTRY_VERIFY_WITH_TIMEOUT(link.contains(MAVLINK_MSG_ID_MISSION_REQUEST), 2000);
+    QCOMPARE(::requestedItems(link.take(MAVLINK_MSG_ID_MISSION_REQUEST)),
+             QList<int>({ 0, 1, 2 }));
+    QVERIFY(link.take(MAVLINK_MSG_ID_MISSION_REQUEST_INT).isEmpty());
+
+    link.receive(::missionItem(0, false));
+    handler->cancelSync(assignment);
+
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+    dto::MissionItemPtr item = missionService->missionItem(assignment->missionId(), 0);
+    QVERIFY(item);
+    QCOMPARE(item->status(), dto::MissionItem::Actual);
+
+    ::removeMission(assignment);
+}
+
+void MissionHandlerTest::testPartialUpload()
+{
+    dto::MissionAssignmentPtr assignment = ::assignMission(5);
+    QVERIFY2(assignment, "Can't assign mission");
+
+    FakeLink link;
+    MavLinkCommunicator communicator(::gcsId, ::gcsComponentId, false);
+    MissionHandler* handler = new MissionHandler(&communicator);
+    communicator.addHandler(handler);
+    communicator.addLink(&link);
+    link.receive(::heartbeat());
+
+    // Unknown vehicle mission is written whole
+    handler->upload(assignment);
+    QList<mavlink_message_t> counts = link.take(MAVLINK_MSG_ID_MISSION_COUNT);
+    QCOMPARE(counts.count(), 1);
+    QCOMPARE(int(mavlink_msg_mission_count_get_count(&counts.first())), 5);
+
+    for (int seq = 0; seq < 5; ++seq)
+    {
+        link.receive(::missionRequest(seq));
+        QCOMPARE(link.take(MAVLINK_MSG_ID_MISSION_ITEM_INT).count(), 1);
+    }
+    link.receive(::missionAck(MAV_MISSION_ACCEPTED));
+    QCOMPARE(assignment->status(), dto::MissionAssignment::Actual);
+
+    // Only the changed item goes with partial write
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+    dto::MissionItemPtrList items = missionService->missionItems(assignment->missionId());
+    for (const dto::MissionItemPtr& item: items)
+    {
+        QCOMPARE(item->status(), dto::MissionItem::Actual);
+    }
+    items.at(2)->setStatus(dto::MissionItem::NotActual);
+
+    handler->upload(assignment);
+    QVERIFY(link.take(MAVLINK_MSG_ID_MISSION_COUNT).isEmpty());
+    QList<mavlink_message_t> partials = link.take(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST);
+    QCOMPARE(partials.count(), 1);
+    QCOMPARE(int(mavlink_msg_mission_write_partial_list_get_start_index(&partials.first())), 2);
+    QCOMPARE(int(mavlink_msg_mission_write_partial_list_get_end_index(&partials.first())), 2);
+
+    // Vehicle rejecting partial writes gets the whole mission
+    link.receive(::missionAck(MAV_MISSION_UNSUPPORTED));
+    counts = link.take(MAVLINK_MSG_ID_MISSION_COUNT);
+    QCOMPARE(counts.count(), 1);
+    QCOMPARE(int(mavlink_msg_mission_count_get_count(&counts.first())), 5);
+
+    handler->cancelSync(assignment);
+    ::removeMission(assignment);
+}
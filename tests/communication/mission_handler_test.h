@@ -0,0 +1,18 @@
+#ifndef MISSION_HANDLER_TEST_H
+#define MISSION_HANDLER_TEST_H
+
+#include <QTest>
+
+class MissionHandlerTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testChangedRanges();
+    void testTimeout();
+    void testDownloadWindow();
+    void testItemIntFallback();
+    void testPartialUpload();
+};
+
+#endif // MISSION_HANDLER_TEST_H
@@ -0,0 +1,133 @@
+#include "tlog_recorder_test.h"
+
+// Qt
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QDebug>
+
+// Std
+#include <cstring>
+
+// Internal
+#include "tlog_recorder.h"
+#include "tlog_reader.h"
+#include "tlog_format.h"
+
+using namespace comm;
+
+namespace
+{
+    // MAVLink v1 layout is enough for the reader, checksum is not validated there
+    int fakeFrame(quint8* buffer, quint8 seq, quint8 payloadLength)
+    {
+        buffer[0] = 0xFE;
+        buffer[1] = payloadLength;
+        buffer[2] = seq;
+        std::memset(buffer + 3, seq, 3 + payloadLength + 2);
+        return 6 + payloadLength + 2;
+    }
+}
+
+void TlogRecorderTest::testRecordSegments()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const int frameLength = 100;
+    const int framesCount = 50;
+    const quint64 startTime = 1000000000;
+
+    // Tiny segments to check rollover, 9 frames fit each one
+    TlogRecorder recorder(4096, 1000);
+    QVERIFY(recorder.start(dir.path()));
+
+    quint8 frame[frameLength];
+    for (int i = 0; i < framesCount; ++i)
+    {
+        std::memset(frame, i + 1, frameLength);
+        QVERIFY(recorder.record(frame, frameLength, startTime + i * 500000)); // 2 frames per second
+        if (i % 20 == 0) QTest::qWait(20); // Let writer drain the small ring
+    }
+
+    recorder.stop();
+    QCOMPARE(recorder.recordedFrames(), quint64(framesCount));
+    QCOMPARE(recorder.droppedFrames(), quint64(0));
+
+    QDir session(recorder.sessionPath());
+    QStringList segments = session.entryList({ "*" + tlog::segmentSuffix }, QDir::Files,
+                                             QDir::Name);
+    QCOMPARE(segments.count(), 6);
+
+    int frameNumber = 0;
+    for (const QString& name: segments)
+    {
+        QFile segment(session.filePath(name));
+        QVERIFY(segment.open(QIODevice::ReadOnly));
+        QByteArray data = segment.readAll();
+        QCOMPARE(data.size() % (tlog::timestampSize + frameLength), 0);
+
+        const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+        for (int pos = 0; pos < data.size(); pos += tlog::timestampSize + frameLength)
+        {
+            QCOMPARE(tlog::readTimestamp(bytes + pos), startTime + frameNumber * 500000);
+            QCOMPARE(int(bytes[pos + tlog::timestampSize]), frameNumber + 1);
+            frameNumber++;
+        }
+
+        QFile index(tlog::indexName(segment.fileName()));
+        QVERIFY(index.open(QIODevice::ReadOnly));
+        QByteArray entries = index.readAll();
+        QVERIFY(entries.size() >= int(sizeof(tlog::IndexEntry)));
+
+        tlog::IndexEntry first;
+        std::memcpy(&first, entries.constData(), sizeof(first));
+        QCOMPARE(qFromBigEndian(first.offset), quint64(0));
+    }
+
+    QCOMPARE(frameNumber, framesCount);
+}
+
+void TlogRecorderTest::testReadAndSeek()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const int framesCount = 100;
+    const quint64 startTime = 2000000000;
+    const quint64 step = 100000; // 10 frames per second
+
+    TlogRecorder recorder(65536, 1024);
+    QVERIFY(recorder.start(dir.path()));
+
+    quint8 frame[64];
+    for (int i = 0; i < framesCount; ++i)
+    {
+        QVERIFY(recorder.record(frame, ::fakeFrame(frame, i, i % 20), startTime + i * step));
+    }
+    recorder.stop();
+
+    TlogReader reader;
+    QVERIFY(reader.open(recorder.sessionPath()));
+    QCOMPARE(reader.startTime(), startTime);
+    QCOMPARE(reader.endTime(), startTime + (framesCount - 1) * step);
+
+    TlogReader::Frame read;
+    int count = 0;
+    while (reader.next(read))
+    {
+        QCOMPARE(read.timestamp, startTime + count * step);
+        QCOMPARE(read.length, 8 + count % 20);
+        QCOMPARE(int(read.data[2]), count);
+        count++;
+    }
+    QCOMPARE(count, framesCount);
+    QVERIFY(reader.atEnd());
+
+    reader.seek(startTime + 42 * step + 1);
+    QVERIFY(reader.next(read));
+    QCOMPARE(int(read.data[2]), 43);
+
+    reader.seek(0);
+    QCOMPARE(reader.nextTimestamp(), startTime);
+}
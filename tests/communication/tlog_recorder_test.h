@@ -0,0 +1,15 @@
+#ifndef TLOG_RECORDER_TEST_H
+#define TLOG_RECORDER_TEST_H
+
+#include <QTest>
+
+class TlogRecorderTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRecordSegments();
+    void testReadAndSeek();
+};
+
+#endif // TLOG_RECORDER_TEST_H
@@ -8,6 +8,7 @@
 // Internal
 #include "udp_link.h"
 #include "serial_link.h"
+#include "i_link_receiver.h"
 
 #include "service_registry.h"
 #include "communication_service.h"
@@ -17,6 +18,41 @@ using namespace dao; // TODO: dao tests
 using namespace comm;
 using namespace domain;
 
+namespace
+{
+    class TestReceiver: public ILinkReceiver
+    {
+    public:
+        void receiveData(AbstractLink* link, const quint8* data, int length) override
+        {
+            Q_UNUSED(link)
+            received.append(QByteArray(reinterpret_cast<const char*>(data), length));
+        }
+
+        QList<QByteArray> received;
+    };
+
+    class QueueTestLink: public AbstractLink
+    {
+    public:
+        bool isConnected() const override { return true; }
+        void connectLink() override {}
+        void disconnectLink() override {}
+
+        qint64 budget = -1;
+        QList<QByteArray> written;
+
+    protected:
+        bool sendDataImpl(const QByteArray& data) override
+        {
+            written.append(QByteArray(data.constData(), data.size()));
+            return true;
+        }
+
+        qint64 writeBudget() const override { return budget; }
+    };
+}
+
 void CommunicationServiceTest::testUdpLink()
 {
     UdpLink link1(60000);
@@ -54,6 +90,52 @@ void CommunicationServiceTest::testUdpLink()
     QCOMPARE(arguments.first(), QVariant("TEST 2"));
 }
 
+void CommunicationServiceTest::testLinkReceiver()
+{
+    UdpLink link1(60002);
+    link1.connectLink();
+
+    TestReceiver receiver;
+    UdpLink link2(60003);
+    link2.setReceiver(&receiver);
+    link2.connectLink();
+
+    link1.addEndpoint(Endpoint(QHostAddress::LocalHost, 60003));
+    for (int i = 0; i < 100; ++i) link1.sendData(QByteArray::number(i));
+
+    QTRY_COMPARE(receiver.received.count(), 100);
+    QCOMPARE(receiver.received.first(), QByteArray("0"));
+    QCOMPARE(receiver.received.last(), QByteArray("99"));
+    QCOMPARE(link2.count(), 1);
+    QCOMPARE(link2.takeBytesReceived(), 190);
+}
+
+void CommunicationServiceTest::testSendQueue()
+{
+    QueueTestLink link;
+
+    link.sendData("relay", 5, AbstractLink::Low);
+    link.sendData("heartbeat", 9, AbstractLink::Normal);
+    link.sendData("mission", 7, AbstractLink::High);
+    link.sendData("command", 7, AbstractLink::Urgent);
+    QCOMPARE(link.queuedBytes(), 28);
+
+    QTRY_COMPARE(link.written.count(), 1);
+    QCOMPARE(link.written.first(), QByteArray("commandmissionheartbeatrelay"));
+    QCOMPARE(link.queuedBytes(), 0);
+
+    // Saturated link: commands go anyway, the rest waits for budget
+    link.written.clear();
+    link.budget = 0;
+    link.sendData("relay", 5, AbstractLink::Low);
+    link.sendData("command", 7, AbstractLink::Urgent);
+
+    QTRY_COMPARE(link.written.count(), 1);
+    QCOMPARE(link.written.first(), QByteArray("command"));
+    QCOMPARE(link.queuedBytes(), 5);
+    QCOMPARE(link.takeBytesSent(), 35);
+}
+
 void CommunicationServiceTest::testLinkDescription()
 {
      CommunicationService* service = ServiceRegistry::communicationService();
@@ -10,6 +10,8 @@ class CommunicationServiceTest: public QObject
 private slots:
     // TODO: endpoints tests
     void testUdpLink();
+    void testLinkReceiver();
+    void testSendQueue();
     void testLinkDescription();
 };
 
@@ -3,6 +3,7 @@
 // Qt
 #include <QDebug>
 #include <QSignalSpy>
+#include <QThread>
 
 // Internal
 #include "service_registry.h"
@@ -17,6 +18,24 @@
 using namespace dao;
 using namespace domain;
 
+namespace
+{
+    // Stands for the communication thread
+    class ItemsRequester: public QThread
+    {
+    public:
+        MissionService* service = nullptr;
+        int missionId = 0;
+        MissionItemPtrList items;
+
+    protected:
+        void run() override
+        {
+            items = service->missionItems(missionId);
+        }
+    };
+}
+
 void MissionServiceTest::testMission()
 {
     domain::MissionService* missionService = domain::ServiceRegistry::missionService();
@@ -82,6 +101,121 @@ void MissionServiceTest::testMissionItems()
     QVERIFY2(missionService->remove(mission), "Can't remove mission");
 }
 
+void MissionServiceTest::testMissionItemSequence()
+{
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+
+    MissionPtr mission = MissionPtr::create();
+    mission->setName("Sequence Mission");
+    QVERIFY2(missionService->save(mission), "Can't insert mission");
+
+    MissionItemPtr first = missionService->addNewMissionItem(mission->id(),
+                                                             MissionItem::Waypoint, 0);
+    MissionItemPtr last = missionService->addNewMissionItem(mission->id(),
+                                                            MissionItem::Waypoint, 1);
+    MissionItemPtr middle = missionService->addNewMissionItem(mission->id(),
+                                                              MissionItem::Waypoint, 1);
+
+    QCOMPARE(missionService->missionItems(mission->id()),
+             MissionItemPtrList({ first, middle, last }));
+    QCOMPARE(missionService->missionItem(mission->id(), 1), middle);
+    QCOMPARE(missionService->missionItem(mission->id(), 2), last);
+    QVERIFY(missionService->missionItem(mission->id(), 3).isNull());
+
+    missionService->swapItems(first, last);
+    QCOMPARE(missionService->missionItem(mission->id(), 0), last);
+    QCOMPARE(missionService->missionItem(mission->id(), 2), first);
+
+    QVERIFY2(missionService->remove(middle), "Can't remove item");
+    QCOMPARE(missionService->missionItem(mission->id(), 1), first);
+    QCOMPARE(mission->count(), 2);
+
+    QVERIFY2(missionService->remove(mission), "Can't remove mission");
+    QVERIFY(missionService->missionItems(mission->id()).isEmpty());
+}
+
+void MissionServiceTest::testMissionItemBatch()
+{
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+
+    MissionPtr mission = MissionPtr::create();
+    mission->setName("Batch Mission");
+    QVERIFY2(missionService->save(mission), "Can't insert mission");
+
+    MissionItemPtrList items;
+    for (int sequence = 0; sequence < 100; ++sequence)
+    {
+        MissionItemPtr item = MissionItemPtr::create();
+        item->setMissionId(mission->id());
+        item->setCommand(MissionItem::Waypoint);
+        item->setSequence(sequence);
+        items.append(item);
+    }
+
+    QSignalSpy spy(missionService, &domain::MissionService::missionItemAdded);
+    QVERIFY2(missionService->save(items), "Can't insert mission items");
+    QCOMPARE(spy.count(), 100);
+    QCOMPARE(mission->count(), 100);
+    QVERIFY(items.last()->id() > items.first()->id());
+    QCOMPARE(missionService->missionItems(mission->id()), items);
+
+    QVERIFY2(missionService->remove(items.mid(50)), "Can't remove mission items");
+    QCOMPARE(missionService->missionItems(mission->id()), items.mid(0, 50));
+    QCOMPARE(mission->count(), 50);
+
+    QVERIFY2(missionService->remove(mission), "Can't remove mission");
+}
+
+void MissionServiceTest::testMissionItemLoading()
+{
+    domain::MissionService* missionService = domain::ServiceRegistry::missionService();
+
+    MissionPtr mission = MissionPtr::create();
+    mission->setName("Loaded Mission");
+    QVERIFY2(missionService->save(mission), "Can't insert mission");
+
+    MissionItemPtrList items;
+    for (int sequence = 0; sequence < 10; ++sequence)
+    {
+        MissionItemPtr item = MissionItemPtr::create();
+        item->setMissionId(mission->id());
+        item->setCommand(MissionItem::Waypoint);
+        item->setSequence(sequence);
+        items.append(item);
+    }
+    QVERIFY2(missionService->save(items), "Can't insert mission items");
+
+    // Unloaded items come back from the database with the next request, in one go
+    for (const MissionItemPtr& item: items) missionService->unload(item);
+    QVERIFY(missionService->missionItems().toSet().intersect(items.toSet()).isEmpty());
+
+    QSignalSpy spy(missionService, &domain::MissionService::missionItemsLoaded);
+
+    // Other thread doesn't wait for the database, items come to the service's thread later
+    ItemsRequester requester;
+    requester.service = missionService;
+    requester.missionId = mission->id();
+    requester.start();
+    QVERIFY(requester.wait());
+    QVERIFY(requester.items.isEmpty());
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+
+    MissionItemPtrList loaded = missionService->missionItems(mission->id());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(loaded.count(), 10);
+    for (int sequence = 0; sequence < loaded.count(); ++sequence)
+    {
+        QCOMPARE(loaded.at(sequence)->sequence(), sequence);
+        QCOMPARE(loaded.at(sequence)->id(), items.at(sequence)->id());
+    }
+
+    missionService->missionItems(mission->id());
+    QCOMPARE(spy.count(), 1);
+
+    QVERIFY2(missionService->remove(mission), "Can't remove mission");
+}
+
 // TODO: dao tests
 void MissionServiceTest::testVehicleDescription()
 {
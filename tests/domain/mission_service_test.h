@@ -10,6 +10,9 @@ class MissionServiceTest: public QObject
 private slots:
     void testMission();
     void testMissionItems();
+    void testMissionItemSequence();
+    void testMissionItemBatch();
+    void testMissionItemLoading();
     void testVehicleDescription();
     void testMissionAssignment();
 };
@@ -3,9 +3,20 @@
 // Qt
 #include <QDebug>
 #include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QFile>
+#include <QtEndian>
+#include <QGeoCoordinate>
 
 // Internal
 #include "telemetry.h"
+#include "telemetry_portion.h"
+#include "telemetry_queue.h"
+#include "telemetry_history.h"
+#include "telemetry_archive.h"
+#include "telemetry_archive_reader.h"
+#include "telemetry_archive_format.h"
 
 using namespace domain;
 
@@ -36,4 +47,179 @@ void TelemetryServiceTest::testTelemetryTree()
     root.notify();
     QCOMPARE(root.takeChangedParameters().count(), 0);
     QCOMPARE(spy.count(), 1);
+
+    Telemetry* satellite = root.childNode(Telemetry::Satellite);
+    Telemetry::TelemetryMap parameters = satellite->parameters();
+    QCOMPARE(parameters.keys(), Telemetry::TelemetryList({ Telemetry::Altitude, Telemetry::Climb,
+                                                           Telemetry::Fix }));
+    QCOMPARE(parameters.value<int>(Telemetry::Altitude), 669);
+    QVERIFY(!parameters.contains(Telemetry::Eph));
+
+    // Map is a snapshot, node detaches on write
+    satellite->setParameter(Telemetry::Altitude, 700);
+    QCOMPARE(parameters.value(Telemetry::Altitude).toInt(), 669);
+    QCOMPARE(satellite->parameter<int>(Telemetry::Altitude), 700);
+
+    // Values keep their types whatever column they are kept in
+    const QGeoCoordinate coordinate(55.7, 37.6);
+    satellite->setParameter(Telemetry::Altitude, 700.5);
+    satellite->setParameter(Telemetry::Operational, true);
+    satellite->setParameter(Telemetry::Coordinate, QVariant::fromValue(coordinate));
+    QCOMPARE(satellite->parameter(Telemetry::Altitude).userType(), int(QMetaType::Double));
+    QCOMPARE(satellite->parameter<double>(Telemetry::Altitude), 700.5);
+    QCOMPARE(satellite->parameter(Telemetry::Operational).userType(), int(QMetaType::Bool));
+    QCOMPARE(satellite->parameter(Telemetry::Fix).userType(), int(QMetaType::Int));
+    QCOMPARE(satellite->parameter<QGeoCoordinate>(Telemetry::Coordinate), coordinate);
+
+    satellite->takeChangedParameters();
+    satellite->setParameter(Telemetry::Altitude, 700.5);
+    satellite->setParameter(Telemetry::Coordinate, QVariant::fromValue(coordinate));
+    QVERIFY(satellite->changedParameterKeys().isEmpty());
+
+    satellite->setParameter(Telemetry::Altitude, 701);
+    QCOMPARE(satellite->parameter(Telemetry::Altitude).userType(), int(QMetaType::Int));
+    QCOMPARE(satellite->changedParameterKeys(), Telemetry::TelemetryList({ Telemetry::Altitude }));
+}
+
+void TelemetryServiceTest::testTelemetryQueue()
+{
+    Telemetry root(Telemetry::Root);
+    QSignalSpy spy(root.childNode(Telemetry::Satellite), &Telemetry::parametersChanged);
+
+    {
+        TelemetryPortion portion(&root);
+        portion.setParameter({ Telemetry::Satellite, Telemetry::Altitude }, 666);
+        portion.setParameter({ Telemetry::Satellite, Telemetry::Fix }, 3);
+
+        QCOMPARE(root.processQueue(), 0); // Not committed yet
+    }
+
+    {
+        TelemetryPortion portion(&root);
+        portion.setParameter({ Telemetry::Satellite, Telemetry::Altitude }, 667);
+    }
+
+    QCOMPARE(root.processQueue(), 3);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(root.childNode(Telemetry::Satellite)->parameter(Telemetry::Altitude).toInt(), 667);
+    QCOMPARE(root.childNode(Telemetry::Satellite)->parameter(Telemetry::Fix).toInt(), 3);
+
+    TelemetryQueue* queue = root.queue();
+    {
+        TelemetryPortion portion(&root);
+        for (int i = 0; i <= queue->capacity(); ++i)
+        {
+            portion.setParameter({ Telemetry::Barometric, Telemetry::Altitude }, i);
+        }
+    }
+
+    QCOMPARE(queue->dropped(), 1);
+    QCOMPARE(root.processQueue(), queue->capacity());
+}
+
+void TelemetryServiceTest::testTelemetryHistory()
+{
+    TelemetryRing<double> ring(4);
+    for (int i = 0; i < 6; ++i) ring.append(100 + i * 10, i);
+
+    QCOMPARE(ring.count(), 4);
+    QCOMPARE(ring.appended(), quint64(6));
+    QCOMPARE(ring.at(0).value, 2.0); // Oldest are overwritten
+    QCOMPARE(ring.last().value, 5.0);
+
+    double value = 0;
+    QVERIFY(!ring.valueAt(110, value));
+    QVERIFY(ring.valueAt(135, value));
+    QCOMPARE(value, 3.0);
+    QCOMPARE(ring.range(125, 140).count(), 2);
+    QCOMPARE(ring.lowerBound(1000), ring.count());
+
+    Telemetry root(Telemetry::Root);
+    // Room for two series only
+    TelemetryHistory history(2 * (sizeof(TelemetryRing<double>) +
+                                  8 * sizeof(TelemetryRing<double>::Sample)), 8);
+    root.setHistory(&history, 7);
+
+    {
+        TelemetryPortion portion(&root);
+        portion.setParameter({ Telemetry::Satellite, Telemetry::Altitude }, 666);
+        portion.setParameter({ Telemetry::Barometric, Telemetry::Altitude }, 670.5);
+        portion.setParameter({ Telemetry::Barometric, Telemetry::Climb }, 1.5);
+    }
+    root.processQueue();
+
+    const TelemetryRing<double>* satellite = history.series<double>(7, Telemetry::Satellite,
+                                                                    Telemetry::Altitude);
+    QVERIFY(satellite);
+    QCOMPARE(satellite->last().value, 666.0);
+    QCOMPARE(history.series<double>(7, Telemetry::Barometric, Telemetry::Altitude)->count(), 1);
+    QVERIFY(!history.series<double>(7, Telemetry::Barometric, Telemetry::Climb));
+    QVERIFY(!history.series<double>(8, Telemetry::Satellite, Telemetry::Altitude));
+    QCOMPARE(history.droppedSamples(), quint64(1));
+}
+
+void TelemetryServiceTest::testTelemetryArchive()
+{
+    QTemporaryDir dir;
+    TelemetryArchive recorder(1024, 64);
+    QVERIFY(recorder.start(dir.path()));
+
+    const quint64 key = archive::seriesKey(1, Telemetry::Barometric, Telemetry::AltitudeRelative);
+    const qint64 start = 1500000000000;
+
+    // 100 s at 50 Hz
+    for (int i = 0; i < 5000; ++i)
+    {
+        while (!recorder.record(key, start + i * 20, i % 100 * 0.5)) QThread::msleep(1);
+    }
+    recorder.stop();
+    QCOMPARE(recorder.recordedSamples(), quint64(5000));
+
+    TelemetryArchiveReader reader;
+    QVERIFY(reader.open(recorder.filePath()));
+    QCOMPARE(reader.keys(), QList<quint64>({ key }));
+    QCOMPARE(reader.startTime(), start);
+    QCOMPARE(reader.endTime(), start + 4999 * 20);
+
+    QVector<TelemetryArchiveReader::Bucket> buckets = reader.query(key, start + 1000,
+                                                                   start + 1990, 200);
+    QCOMPARE(buckets.count(), 50); // Raw samples fit
+    QCOMPARE(buckets.first().time, start + 1000);
+    QCOMPARE(buckets.first().mean, 25.0);
+    QCOMPARE(buckets.last().mean, 49.5);
+
+    buckets = reader.query(key, start + 1000, start + 1990, 100);
+    QCOMPARE(buckets.count(), 1); // One second bucket
+    QCOMPARE(buckets.first().min, 25.0);
+    QCOMPARE(buckets.first().max, 49.5);
+    QCOMPARE(buckets.first().mean, 37.25);
+
+    buckets = reader.query(key, start, start + 100000, 20);
+    QCOMPARE(buckets.count(), 10); // Ten second buckets
+    QCOMPARE(buckets.at(3).time, start + 30000);
+    QCOMPARE(buckets.at(3).min, 0.0);
+    QCOMPARE(buckets.at(3).max, 49.5);
+    QCOMPARE(buckets.at(3).mean, 24.75);
+
+    // Block claiming more values than its payload holds is a broken tail
+    reader.close();
+    {
+        QFile file(recorder.filePath());
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.seek(archive::fileHeaderSize + 16));
+
+        uchar count[4];
+        qToLittleEndian<quint32>(0xFFFFFFFF, count);
+        QCOMPARE(file.write(reinterpret_cast<const char*>(count), 4), qint64(4));
+    }
+    QVERIFY(reader.open(recorder.filePath()));
+    QVERIFY(reader.keys().isEmpty());
+    QVERIFY(reader.query(key, start, start + 100000, 200).isEmpty());
+
+    // Values beyond the fixed-point range are clamped, delta of the extremes still fits
+    const qint64 limit = qRound64(archive::fixedLimit);
+    QCOMPARE(archive::toFixed(1e300), limit);
+    QCOMPARE(archive::toFixed(-qInf()), -limit);
+    QCOMPARE(archive::toFixed(qQNaN()), qint64(0));
+    QCOMPARE(archive::unzigzag(archive::zigzag(limit - -limit)), 2 * limit);
 }
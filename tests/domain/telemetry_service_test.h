@@ -9,6 +9,9 @@ class TelemetryServiceTest: public QObject
 
 private slots:
     void testTelemetryTree();
+    void testTelemetryQueue();
+    void testTelemetryHistory();
+    void testTelemetryArchive();
 };
 
 #endif // TELEMETRY_TEST_H
@@ -0,0 +1,48 @@
+#include "settings_provider_test.h"
+
+// Qt
+#include <QSettings>
+
+// Internal
+#include "settings_provider.h"
+
+using namespace settings;
+
+void SettingsProviderTest::testSnapshotReload()
+{
+    QVariant autoAdd = Provider::value(communication::autoAdd);
+    QVariant trackLength = Provider::value(map::trackLength);
+
+    Provider::setValue(communication::autoAdd, true);
+    Provider::setValue(map::trackLength, 250);
+    Provider::sync();
+    Provider::reload();
+
+    QVERIFY(Provider::snapshot().autoAdd.loadAcquire());
+    QCOMPARE(Provider::snapshot().trackLength.loadAcquire(), 250);
+
+    // Values come back from the ini file as strings
+    {
+        QSettings storage(QSettings::NativeFormat, QSettings::UserScope, "JAGCS", "JAGCS");
+        storage.setValue(communication::autoAdd, "true");
+        storage.setValue(map::trackLength, "300");
+        storage.sync();
+    }
+    Provider::reload();
+
+    QVERIFY(Provider::snapshot().autoAdd.loadAcquire());
+    QCOMPARE(Provider::snapshot().trackLength.loadAcquire(), 300);
+
+    {
+        QSettings storage(QSettings::NativeFormat, QSettings::UserScope, "JAGCS", "JAGCS");
+        storage.setValue(communication::autoAdd, "false");
+        storage.sync();
+    }
+    Provider::reload();
+
+    QVERIFY(!Provider::snapshot().autoAdd.loadAcquire());
+
+    Provider::setValue(communication::autoAdd, autoAdd);
+    Provider::setValue(map::trackLength, trackLength);
+    Provider::sync();
+}
@@ -0,0 +1,14 @@
+#ifndef SETTINGS_PROVIDER_TEST_H
+#define SETTINGS_PROVIDER_TEST_H
+
+#include <QTest>
+
+class SettingsProviderTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSnapshotReload();
+};
+
+#endif // SETTINGS_PROVIDER_TEST_H
@@ -9,6 +9,11 @@
 #include "communication_service_test.h"
 #include "telemetry_service_test.h"
 #include "mission_service_test.h"
+#include "mavlink_frame_parser_test.h"
+#include "tlog_recorder_test.h"
+#include "mavlink_router_test.h"
+#include "mission_handler_test.h"
+#include "settings_provider_test.h"
 
 int main(int argc, char* argv[])
 {
@@ -30,5 +35,20 @@ int main(int argc, char* argv[])
     MissionServiceTest missionTest;
     QTest::qExec(&missionTest);
 
+    MavLinkFrameParserTest parserTest;
+    QTest::qExec(&parserTest);
+
+    TlogRecorderTest recorderTest;
+    QTest::qExec(&recorderTest);
+
+    MavLinkRouterTest routerTest;
+    QTest::qExec(&routerTest);
+
+    MissionHandlerTest missionHandlerTest;
+    QTest::qExec(&missionHandlerTest);
+
+    SettingsProviderTest settingsTest;
+    QTest::qExec(&settingsTest);
+
     return 0;
 }